@@ -0,0 +1,468 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include <enki/PhysicalEngine.h>
+#include <enki/robots/e-puck/EPuck.h>
+#include <enki/robots/thymio2/Thymio2.h>
+#include <enki/robots/marxbot/Marxbot.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <thread>
+#include <cstring>
+#include <cmath>
+#include <stdint.h>
+#ifdef __unix__
+#include <sys/resource.h>
+#endif
+
+/*!	\file enkiBench.cpp
+	\brief Canonical workloads, swept over the number of robots and of threads, reporting their speed as JSON
+*/
+
+using namespace Enki;
+using namespace std;
+
+// e-puck with all its sensors, avoiding obstacles with a Braitenberg controller
+struct BenchEPuck: EPuck
+{
+	BenchEPuck(unsigned capabilities): EPuck(capabilities) {}
+	
+	virtual void controlStep(double dt)
+	{
+		const double left(infraredSensor0.getValue() + infraredSensor1.getValue() + infraredSensor2.getValue());
+		const double right(infraredSensor5.getValue() + infraredSensor6.getValue() + infraredSensor7.getValue());
+		leftSpeed = 10 - 0.01 * right;
+		rightSpeed = 10 - 0.01 * left;
+		EPuck::controlStep(dt);
+	}
+};
+
+// e-puck exchanging messages with its neighbour in the list of addresses
+struct BenchBluetoothEPuck: BenchEPuck
+{
+	unsigned destination;
+	bool connected;
+	char message[8];
+	
+	BenchBluetoothEPuck(unsigned address, unsigned destination):
+		BenchEPuck(CAPABILITY_BASIC_SENSORS | CAPABILITY_BLUETOOTH),
+		destination(destination),
+		connected(false)
+	{
+		bluetooth->setAddress(address);
+		memset(message, 0, sizeof(message));
+	}
+	
+	virtual void controlStep(double dt)
+	{
+		if (!connected)
+		{
+			bluetooth->connectTo(destination);
+			connected = true;
+		}
+		else
+		{
+			memcpy(message, &pos, sizeof(message));
+			bluetooth->sendDataTo(destination, message, sizeof(message));
+		}
+		BenchEPuck::controlStep(dt);
+	}
+};
+
+// Thymio2 turning when its ground sensors see dark ground
+struct BenchThymio2: Thymio2
+{
+	virtual void controlStep(double dt)
+	{
+		const double ground(groundSensor0.getValue() - groundSensor1.getValue());
+		const double obstacle(infraredSensor0.getValue() + infraredSensor1.getValue() - infraredSensor3.getValue() - infraredSensor4.getValue());
+		leftSpeed = 10 + 0.002 * obstacle + 0.01 * ground;
+		rightSpeed = 10 - 0.002 * obstacle - 0.01 * ground;
+		setLedColor(TOP, Color(groundSensor0.getValue() / 1000., 0, 0));
+		Thymio2::controlStep(dt);
+	}
+};
+
+// marXbot avoiding obstacles seen by its rotating distance scanner
+struct BenchMarxbot: Marxbot
+{
+	virtual void controlStep(double dt)
+	{
+		const double left(getVirtualBumper(1) + getVirtualBumper(2));
+		const double right(getVirtualBumper(22) + getVirtualBumper(21));
+		leftSpeed = 10 - 5 * right;
+		rightSpeed = 10 - 5 * left;
+		Marxbot::controlStep(dt);
+	}
+};
+
+// side of a square arena giving every robot an area of side spacing
+static double arenaSize(unsigned count, double spacing)
+{
+	return spacing * ceil(sqrt(double(count)));
+}
+
+// place an object at a random free-ish position and orientation in a square of given size
+static void place(PhysicalObject* o, FastRandom& random, double size, double margin)
+{
+	o->pos = Point(margin + random.getRange(size - 2 * margin), margin + random.getRange(size - 2 * margin));
+	o->angle = random.getRange(2 * M_PI);
+}
+
+static World* buildEPucks(unsigned count)
+{
+	FastRandom random;
+	random.setSeed(1);
+	const double size(arenaSize(count, 25));
+	World* world(new World(size, size));
+	for (unsigned i = 0; i < count; ++i)
+	{
+		EPuck* epuck(new BenchEPuck(EPuck::CAPABILITY_BASIC_SENSORS | EPuck::CAPABILITY_CAMERA));
+		place(epuck, random, size, 5);
+		world->addObject(epuck);
+	}
+	return world;
+}
+
+static World* buildThymios(unsigned count)
+{
+	// stripes and a checkerboard on the ground
+	const unsigned textureSize(256);
+	vector<uint32_t> texture(textureSize * textureSize);
+	for (unsigned y = 0; y < textureSize; ++y)
+		for (unsigned x = 0; x < textureSize; ++x)
+			texture[y * textureSize + x] = ((x / 16 + y / 16) % 2 || (x + y) % 64 < 8) ? 0xff202020 : 0xffe0e0e0;
+	
+	FastRandom random;
+	random.setSeed(2);
+	const double size(arenaSize(count, 40));
+	World* world(new World(size, size, Color::gray, World::GroundTexture(textureSize, textureSize, &texture[0])));
+	for (unsigned i = 0; i < count; ++i)
+	{
+		Thymio2* thymio(new BenchThymio2);
+		place(thymio, random, size, 8);
+		world->addObject(thymio);
+	}
+	return world;
+}
+
+static World* buildMarxbots(unsigned count)
+{
+	FastRandom random;
+	random.setSeed(3);
+	const double radius(0.5 * arenaSize(count, 50));
+	World* world(new World(radius));
+	for (unsigned i = 0; i < count; ++i)
+	{
+		Marxbot* marxbot(new BenchMarxbot);
+		const double r(random.getRange(radius - 10));
+		const double a(random.getRange(2 * M_PI));
+		marxbot->pos = Point(r * cos(a), r * sin(a));
+		marxbot->angle = random.getRange(2 * M_PI);
+		world->addObject(marxbot);
+	}
+	return world;
+}
+
+static World* buildBoxes(unsigned count)
+{
+	// boxes packed in a grid, thrown towards the center
+	FastRandom random;
+	random.setSeed(4);
+	const unsigned side(unsigned(ceil(sqrt(double(count)))));
+	const double size(side * 6 + 20);
+	World* world(new World(size, size));
+	for (unsigned i = 0; i < count; ++i)
+	{
+		PhysicalObject* box(new PhysicalObject);
+		box->setRectangular(2 + random.getRange(3), 2 + random.getRange(3), 2, 1 + random.getRange(5));
+		box->pos = Point(10 + 6 * (i % side) + 3, 10 + 6 * (i / side) + 3);
+		box->angle = random.getRange(M_PI);
+		box->speed = (Point(size / 2, size / 2) - box->pos) * 0.5;
+		box->angSpeed = random.getRange(2) - 1;
+		world->addObject(box);
+	}
+	return world;
+}
+
+static World* buildBluetooth(unsigned count)
+{
+	FastRandom random;
+	random.setSeed(5);
+	const double size(arenaSize(count, 25));
+	World* world(new World(size, size));
+	world->initBluetoothBase();
+	for (unsigned i = 0; i < count; ++i)
+	{
+		EPuck* epuck(new BenchBluetoothEPuck(i + 1, (i + 1) % count + 1));
+		place(epuck, random, size, 5);
+		world->addObject(epuck);
+	}
+	return world;
+}
+
+// a canonical workload
+struct Workload
+{
+	const char* name;
+	World* (*build)(unsigned count);
+};
+
+static const Workload workloads[] = {
+	{ "epucks", buildEPucks },
+	{ "thymios", buildThymios },
+	{ "marxbots", buildMarxbots },
+	{ "boxes", buildBoxes },
+	{ "bluetooth", buildBluetooth }
+};
+
+// hash of the poses of all objects, in iteration order
+static uint64_t hashWorld(const World& world)
+{
+	uint64_t hash(14695981039346656037ULL);
+	for (World::ObjectsIterator it = world.objects.begin(); it != world.objects.end(); ++it)
+	{
+		const double values[] = { (*it)->pos.x, (*it)->pos.y, (*it)->angle };
+		const unsigned char* bytes(reinterpret_cast<const unsigned char*>(values));
+		for (size_t i = 0; i < sizeof(values); ++i)
+			hash = (hash ^ bytes[i]) * 1099511628211ULL;
+	}
+	return hash;
+}
+
+// reset the peak resident set size of this process if the system allows it
+static void resetPeakMemory()
+{
+	#ifdef __linux__
+	ofstream clearRefs("/proc/self/clear_refs");
+	clearRefs << "5";
+	#endif
+}
+
+// return the peak resident set size of this process in bytes, 0 if unknown
+static uint64_t getPeakMemory()
+{
+	#ifdef __linux__
+	ifstream status("/proc/self/status");
+	string line;
+	while (getline(status, line))
+		if (line.compare(0, 6, "VmHWM:") == 0)
+			return uint64_t(strtoull(line.c_str() + 6, 0, 10)) * 1024;
+	#endif
+	#ifdef __unix__
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+		#ifdef __APPLE__
+		return usage.ru_maxrss;
+		#else
+		return uint64_t(usage.ru_maxrss) * 1024;
+		#endif
+	#endif
+	return 0;
+}
+
+// result of running a workload
+struct Result
+{
+	double stepsPerSecond;
+	double nsPerObjectStep;
+	uint64_t peakMemory;
+	uint64_t hash;
+};
+
+static Result run(const Workload& workload, unsigned count, unsigned threadCount, unsigned steps)
+{
+	resetPeakMemory();
+	World* world(workload.build(count));
+	world->setThreadCount(threadCount);
+	const auto start(chrono::steady_clock::now());
+	for (unsigned i = 0; i < steps; ++i)
+		world->step(1. / 30., 3);
+	const double duration(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+	
+	Result result;
+	result.stepsPerSecond = double(steps) / duration;
+	result.nsPerObjectStep = duration * 1e9 / (double(steps) * double(world->objects.size()));
+	result.peakMemory = getPeakMemory();
+	result.hash = hashWorld(*world);
+	delete world;
+	return result;
+}
+
+static string hashToString(uint64_t hash)
+{
+	ostringstream oss;
+	oss << hex;
+	oss.width(16);
+	oss.fill('0');
+	oss << hash;
+	return oss.str();
+}
+
+static void usage(const char* name)
+{
+	cerr << "Usage: " << name << " [options]\n"
+		"  --quick                 run small worlds for a few steps, to check that the benchmark works\n"
+		"  --steps S               number of steps of every run\n"
+		"  --counts N1,N2,...      numbers of robots or objects\n"
+		"  --threads T1,T2,...     numbers of threads, 0 meaning one per hardware thread\n"
+		"  --workload NAME         only run workload NAME (epucks, thymios, marxbots, boxes, bluetooth)\n"
+		"  --reference FILE        fail if trajectory hashes differ from the ones in FILE\n"
+		"  --save-reference FILE   write trajectory hashes to FILE\n";
+}
+
+static vector<unsigned> parseList(const char* text)
+{
+	vector<unsigned> values;
+	istringstream iss(text);
+	string value;
+	while (getline(iss, value, ','))
+		values.push_back(unsigned(strtoul(value.c_str(), 0, 10)));
+	return values;
+}
+
+int main(int argc, char* argv[])
+{
+	unsigned steps(300);
+	vector<unsigned> counts = { 25, 100, 400 };
+	vector<unsigned> threadCounts = { 1, 2, 4, 0 };
+	string workloadName, referenceFileName, saveReferenceFileName;
+	for (int i = 1; i < argc; ++i)
+	{
+		const string arg(argv[i]);
+		const bool hasValue(i + 1 < argc);
+		if (arg == "--quick")
+		{
+			steps = 20;
+			counts = { 10 };
+			threadCounts = { 1, 2 };
+		}
+		else if (arg == "--steps" && hasValue)
+			steps = unsigned(strtoul(argv[++i], 0, 10));
+		else if (arg == "--counts" && hasValue)
+			counts = parseList(argv[++i]);
+		else if (arg == "--threads" && hasValue)
+			threadCounts = parseList(argv[++i]);
+		else if (arg == "--workload" && hasValue)
+			workloadName = argv[++i];
+		else if (arg == "--reference" && hasValue)
+			referenceFileName = argv[++i];
+		else if (arg == "--save-reference" && hasValue)
+			saveReferenceFileName = argv[++i];
+		else
+		{
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	
+	// reference hashes, as lines of workload name, count, steps and hash
+	map<string, string> referenceHashes;
+	if (!referenceFileName.empty())
+	{
+		ifstream referenceFile(referenceFileName.c_str());
+		if (!referenceFile)
+		{
+			cerr << "Error: cannot open reference file " << referenceFileName << endl;
+			return 1;
+		}
+		string name, count, stepCount, hash;
+		while (referenceFile >> name >> count >> stepCount >> hash)
+			referenceHashes[name + " " + count + " " + stepCount] = hash;
+	}
+	ostringstream savedHashes;
+	
+	bool ok(true);
+	bool first(true);
+	cout << "{\n\t\"steps\": " << steps << ",\n\t\"hardwareThreads\": " << thread::hardware_concurrency() << ",\n\t\"runs\": [";
+	for (size_t w = 0; w < sizeof(workloads) / sizeof(Workload); ++w)
+	{
+		const Workload& workload(workloads[w]);
+		if (!workloadName.empty() && workloadName != workload.name)
+			continue;
+		for (size_t c = 0; c < counts.size(); ++c)
+		{
+			const unsigned count(counts[c]);
+			ostringstream key;
+			key << workload.name << " " << count << " " << steps;
+			string expectedHash;
+			if (referenceHashes.find(key.str()) != referenceHashes.end())
+				expectedHash = referenceHashes[key.str()];
+			for (size_t t = 0; t < threadCounts.size(); ++t)
+			{
+				const Result result(run(workload, count, threadCounts[t], steps));
+				const string hash(hashToString(result.hash));
+				
+				// results must not depend on the number of threads nor change across versions
+				bool hashOk(true);
+				if (expectedHash.empty())
+				{
+					expectedHash = hash;
+					savedHashes << key.str() << " " << hash << "\n";
+				}
+				else if (hash != expectedHash)
+				{
+					cerr << "Error: " << workload.name << " with " << count << " objects and " << threadCounts[t] << " threads has trajectory hash " << hash << " instead of " << expectedHash << endl;
+					hashOk = false;
+					ok = false;
+				}
+				
+				cout << (first ? "\n" : ",\n");
+				first = false;
+				cout << "\t\t{ \"workload\": \"" << workload.name << "\", \"count\": " << count << ", \"threads\": " << threadCounts[t];
+				cout << ", \"stepsPerSecond\": " << result.stepsPerSecond << ", \"nsPerObjectStep\": " << result.nsPerObjectStep;
+				cout << ", \"peakRSS\": " << result.peakMemory << ", \"hash\": \"" << hash << "\", \"hashOk\": " << (hashOk ? "true" : "false") << " }";
+				cout.flush();
+			}
+		}
+	}
+	cout << "\n\t]\n}" << endl;
+	
+	if (!saveReferenceFileName.empty())
+	{
+		ofstream saveReferenceFile(saveReferenceFileName.c_str());
+		saveReferenceFile << savedHashes.str();
+		if (!saveReferenceFile)
+		{
+			cerr << "Error: cannot write reference file " << saveReferenceFileName << endl;
+			return 1;
+		}
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include "BoxHierarchy.h"
+
+/*!	\file BoxHierarchy.cpp
+	\brief Implementation of the flat bounding volume hierarchy of axis-aligned boxes
+*/
+
+namespace Enki
+{
+	void BoxHierarchy::build(const std::vector<Point>& centers)
+	{
+		nodes.clear();
+		order.resize(centers.size());
+		for (size_t i = 0; i < order.size(); ++i)
+			order[i] = i;
+		if (!centers.empty())
+			buildNode(centers, 0, centers.size());
+	}
+	
+	void BoxHierarchy::buildNode(const std::vector<Point>& centers, unsigned begin, unsigned end)
+	{
+		const size_t index(nodes.size());
+		nodes.push_back(Node());
+		nodes[index].begin = begin;
+		nodes[index].end = end;
+		nodes[index].leaf = end - begin <= leafSize;
+		
+		if (!nodes[index].leaf)
+		{
+			// split at the median center along the longest axis
+			Point bottomLeft(centers[order[begin]]), topRight(bottomLeft);
+			for (unsigned i = begin + 1; i < end; ++i)
+			{
+				const Point& center(centers[order[i]]);
+				bottomLeft.x = std::min(bottomLeft.x, center.x);
+				bottomLeft.y = std::min(bottomLeft.y, center.y);
+				topRight.x = std::max(topRight.x, center.x);
+				topRight.y = std::max(topRight.y, center.y);
+			}
+			const bool alongX(topRight.x - bottomLeft.x >= topRight.y - bottomLeft.y);
+			const unsigned middle((begin + end) / 2);
+			std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end, [&centers, alongX](unsigned a, unsigned b) {
+				const Scalar keyA(alongX ? centers[a].x : centers[a].y), keyB(alongX ? centers[b].x : centers[b].y);
+				return keyA < keyB || (keyA == keyB && a < b);
+			});
+			buildNode(centers, begin, middle);
+			buildNode(centers, middle, end);
+		}
+		nodes[index].skip = nodes.size();
+	}
+}
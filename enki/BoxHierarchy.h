@@ -0,0 +1,153 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#ifndef __ENKI_BOXHIERARCHY_H
+#define __ENKI_BOXHIERARCHY_H
+
+#include "Geometry.h"
+#include <vector>
+#include <algorithm>
+
+/*!	\file BoxHierarchy.h
+	\brief A flat bounding volume hierarchy of axis-aligned boxes
+*/
+
+namespace Enki
+{
+	//! A bounding volume hierarchy of axis-aligned boxes, stored as a flat array of nodes
+	/*! \ingroup core
+		Items are identified by their index, the hierarchy does not store them. Its structure is built
+		from the centers of the items, splitting at the median along the longest axis, and its boxes are
+		set by refit(), which can be called again without rebuilding when items move but keep their
+		relative positions. Nodes are stored in depth-first order and each one knows the index of the
+		node following its subtree, so traversals need no stack.
+	*/
+	class BoxHierarchy
+	{
+	public:
+		//! A node of the hierarchy
+		struct Node
+		{
+			//! Bottom-left corner of the box of all items of this node
+			Point bottomLeft;
+			//! Top-right corner of the box of all items of this node
+			Point topRight;
+			//! First index in order of the items of this node
+			unsigned begin;
+			//! Last index in order of the items of this node, plus one
+			unsigned end;
+			//! Index of the node following the subtree of this node
+			unsigned skip;
+			//! Whether this node is a leaf, otherwise its first child directly follows it
+			bool leaf;
+		};
+		
+		//! Maximum number of items in a leaf
+		static const unsigned leafSize = 4;
+		
+	protected:
+		//! Nodes, in depth-first order
+		std::vector<Node> nodes;
+		//! Indices of items, ordered by leaf
+		std::vector<unsigned> order;
+		
+	public:
+		//! Remove all nodes
+		void clear() { nodes.clear(); order.clear(); }
+		//! Return whether there is no node
+		bool empty() const { return nodes.empty(); }
+		
+		//! Build the structure of the hierarchy of the items whose centers are given, boxes are left unset until refit() is called
+		void build(const std::vector<Point>& centers);
+		
+		//! Set the boxes of all nodes, itemBox(index, bottomLeft, topRight) filling in the box of an item
+		template<typename ItemBox>
+		void refit(ItemBox itemBox)
+		{
+			// from the last node, as children follow their parent
+			for (size_t i = nodes.size(); i-- > 0;)
+			{
+				Node& node(nodes[i]);
+				if (node.leaf)
+				{
+					itemBox(order[node.begin], node.bottomLeft, node.topRight);
+					for (unsigned j = node.begin + 1; j < node.end; ++j)
+					{
+						Point bottomLeft, topRight;
+						itemBox(order[j], bottomLeft, topRight);
+						node.bottomLeft.x = std::min(node.bottomLeft.x, bottomLeft.x);
+						node.bottomLeft.y = std::min(node.bottomLeft.y, bottomLeft.y);
+						node.topRight.x = std::max(node.topRight.x, topRight.x);
+						node.topRight.y = std::max(node.topRight.y, topRight.y);
+					}
+				}
+				else
+				{
+					const Node& first(nodes[i + 1]);
+					const Node& second(nodes[first.skip]);
+					node.bottomLeft = Point(std::min(first.bottomLeft.x, second.bottomLeft.x), std::min(first.bottomLeft.y, second.bottomLeft.y));
+					node.topRight = Point(std::max(first.topRight.x, second.topRight.x), std::max(first.topRight.y, second.topRight.y));
+				}
+			}
+		}
+		
+		//! Call visitor(index) on every item of the leaves whose box, as well as the boxes of all nodes containing them, passes boxTest(bottomLeft, topRight); the boxes of items are not tested
+		template<typename BoxTest, typename Visitor>
+		void visit(BoxTest boxTest, Visitor visitor) const
+		{
+			size_t i = 0;
+			while (i < nodes.size())
+			{
+				const Node& node(nodes[i]);
+				if (!boxTest(node.bottomLeft, node.topRight))
+				{
+					i = node.skip;
+					continue;
+				}
+				if (node.leaf)
+				{
+					for (unsigned j = node.begin; j < node.end; ++j)
+						visitor(order[j]);
+				}
+				++i;
+			}
+		}
+		
+	protected:
+		//! Build the subtree of the items from order[begin] to order[end-1]
+		void buildNode(const std::vector<Point>& centers, unsigned begin, unsigned end);
+	};
+}
+
+#endif
@@ -70,7 +70,7 @@ namespace Enki
 		return outs;
 	}
 	
-	double Segment::dist(const Point &p) const
+	Scalar Segment::dist(const Point &p) const
 	{
 		const Vector n(a.y-b.y, b.x-a.x);
 		const Vector u = n.unitary();
@@ -83,10 +83,10 @@ namespace Enki
 		const Vector r(this->b - this->a);
 		const Vector s(that.b - that.a);
 		const Vector thatAMinThisA(that.a - this->a);
-		const double rCrossS(r.cross(s));
-		if (almost_equal(rCrossS, 0.))
+		const Scalar rCrossS(r.cross(s));
+		if (almost_equal(rCrossS, Scalar(0)))
 		{
-			if (almost_equal(thatAMinThisA.cross(r), 0.))
+			if (almost_equal(thatAMinThisA.cross(r), Scalar(0)))
 			{
 				// colinear, check if overlap
 				if (this->isDegenerate())
@@ -106,10 +106,10 @@ namespace Enki
 					else
 					{
 						// only this is degenerate, is it on that?
-						if ((a.x >= fmin(that.a.x, that.b.x)) &&
-							(a.y >= fmin(that.a.y, that.b.y)) &&
-							(a.x <= fmax(that.a.x, that.b.x)) &&
-							(a.y <= fmax(that.a.y, that.b.y)))
+						if ((a.x >= std::fmin(that.a.x, that.b.x)) &&
+							(a.y >= std::fmin(that.a.y, that.b.y)) &&
+							(a.x <= std::fmax(that.a.x, that.b.x)) &&
+							(a.y <= std::fmax(that.a.y, that.b.y)))
 						{
 							// yes, intersection
 							if (intersectionPoint)
@@ -121,18 +121,18 @@ namespace Enki
 				}
 				// both segments have non-zero length
 				const Vector rOnNorm2(r / r.norm2());
-				const double t0(thatAMinThisA * rOnNorm2);
-				const double t1(t0 + s * rOnNorm2);
-				if (fmin(t0, t1) > 1)
+				const Scalar t0(thatAMinThisA * rOnNorm2);
+				const Scalar t1(t0 + s * rOnNorm2);
+				if (std::fmin(t0, t1) > 1)
 					return false;
-				if (fmax(t0, t1) < 0)
+				if (std::fmax(t0, t1) < 0)
 					return false;
 				if (intersectionPoint)
 				{
 					// intersection is in the middle of the overlapping interval
-					const double t0Clamped(fmax(fmin(t0, 1.), 0.));
-					const double t1Clamped(fmax(fmin(t1, 1.), 0.));
-					const double tMean((t0Clamped + t1Clamped) / 2);
+					const Scalar t0Clamped(std::fmax(std::fmin(t0, Scalar(1)), Scalar(0)));
+					const Scalar t1Clamped(std::fmax(std::fmin(t1, Scalar(1)), Scalar(0)));
+					const Scalar tMean((t0Clamped + t1Clamped) / 2);
 					*intersectionPoint = a + r * tMean;
 				}
 				return true;
@@ -141,8 +141,8 @@ namespace Enki
 		}
 		else
 		{
-			const double t(thatAMinThisA.cross(s) / rCrossS);
-			const double u(thatAMinThisA.cross(r) / rCrossS);
+			const Scalar t(thatAMinThisA.cross(s) / rCrossS);
+			const Scalar u(thatAMinThisA.cross(r) / rCrossS);
 			if (0 <= t && t <= 1 && 0 <= u && u <= 1)
 			{
 				if (intersectionPoint)
@@ -201,11 +201,11 @@ namespace Enki
 		}
 	}
 	
-	double Polygon::getBoundingRadius() const
+	Scalar Polygon::getBoundingRadius() const
 	{
-		double radius = 0;
+		Scalar radius = 0;
 		for (size_t i = 0; i < size(); i++)
-			radius = std::max<double>(radius, (*this)[i].norm());
+			radius = std::max<Scalar>(radius, (*this)[i].norm());
 		return radius;
 	}
 	
@@ -246,68 +246,88 @@ namespace Enki
 		}
 	}
 	
+	void Polygon::getNormals(SmallVector<Vector, 16>& normals) const
+	{
+		// the orientation is given by the sign of the area
+		Scalar doubleArea(0);
+		for (size_t i = 0; i < size(); ++i)
+			doubleArea += (*this)[i].cross((*this)[i + 1 == size() ? 0 : i + 1]);
+		const Scalar orientation(doubleArea < 0 ? -1 : 1);
+		
+		normals.resize(size());
+		for (size_t i = 0; i < size(); ++i)
+		{
+			const Vector side((*this)[i + 1 == size() ? 0 : i + 1] - (*this)[i]);
+			normals[i] = Vector(side.y, -side.x) * (orientation / side.norm());
+		}
+	}
+	
+	//! Return how far the vertex of polygon the furthest behind the side through a of outward unit normal n is, and set support to its index
+	static Scalar getPenetration(const Polygon& polygon, const Point& a, const Vector& n, size_t& support)
+	{
+		// the support point in direction -n is the vertex of lowest projection on n
+		Scalar minProjection(std::numeric_limits<Scalar>::max());
+		for (size_t j = 0; j < polygon.size(); ++j)
+		{
+			const Scalar projection(polygon[j] * n);
+			if (projection < minProjection)
+			{
+				minProjection = projection;
+				support = j;
+			}
+		}
+		return a * n - minProjection;
+	}
+	
 	bool Polygon::doesIntersect(const Polygon& that, Vector& mtv, Point& intersectionPoint) const
+	{
+		SmallVector<Vector, 16> thisNormals, thatNormals;
+		getNormals(thisNormals);
+		that.getNormals(thatNormals);
+		return doesIntersect(that, thisNormals.data(), thatNormals.data(), mtv, intersectionPoint);
+	}
+	
+	bool Polygon::doesIntersect(const Polygon& that, const Vector* thisNormals, const Vector* thatNormals, Vector& mtv, Point& intersectionPoint) const
 	{
 		// Note: does not handle optimally the case of full overlapping
 		
 		// Using the Separate Axis Theorem, see for instance: http://www.dyn4j.org/2010/01/sat/
-		double minMTVDist(std::numeric_limits<double>::max());
+		// on the normal of a side, the penetration of the other polygon is given by its support point
+		Scalar minMTVDist(std::numeric_limits<Scalar>::max());
 		Vector minMTV;
 		Vector minCollisionPoint;
 		
 		// do points of that are inside this
 		for (size_t i = 0; i < this->size(); ++i)
 		{
-			const Segment segment(this->getSegment(i));
-			double maxDist(0);
-			size_t maxJ(0);
-			for (size_t j = 0; j < that.size(); ++j)
-			{
-				// positive distance for inside
-				const double dist(segment.dist(that[j]));
-				if (dist > maxDist)
-				{
-					maxDist = dist;
-					maxJ = j;
-				}
-			}
+			size_t support(0);
+			const Scalar dist(getPenetration(that, (*this)[i], thisNormals[i], support));
 			// if all points of that are outside, we found a separate axis
-			if (maxDist == 0)
+			if (dist <= 0)
 				return false;
 			// if this side has a lower penetration than best so far, take as best
-			if (maxDist < minMTVDist)
+			if (dist < minMTVDist)
 			{
-				minMTVDist = maxDist;
-				minMTV = segment.getDirection().perp().unitary() * maxDist;
-				minCollisionPoint = that[maxJ];
+				minMTVDist = dist;
+				minMTV = -thisNormals[i] * dist;
+				minCollisionPoint = that[support];
 			}
 		}
 		
 		// do points of this are inside that
 		for (size_t i = 0; i < that.size(); ++i)
 		{
-			const Segment segment(that.getSegment(i));
-			double maxDist(0);
-			size_t maxJ(0);
-			for (size_t j = 0; j < this->size(); ++j)
-			{
-				// positive distance for inside
-				const double dist(segment.dist((*this)[j]));
-				if (dist > maxDist)
-				{
-					maxDist = dist;
-					maxJ = j;
-				}
-			}
+			size_t support(0);
+			const Scalar dist(getPenetration(*this, that[i], thatNormals[i], support));
 			// if all points of this are outside, we found a separate axis
-			if (maxDist == 0)
+			if (dist <= 0)
 				return false;
 			// if this side has a lower penetration than best so far, take as best
-			if (maxDist < minMTVDist)
+			if (dist < minMTVDist)
 			{
-				minMTVDist = maxDist;
-				minMTV = -segment.getDirection().perp().unitary() * maxDist;
-				minCollisionPoint = (*this)[maxJ] + minMTV;
+				minMTVDist = dist;
+				minMTV = thatNormals[i] * dist;
+				minCollisionPoint = (*this)[support] + minMTV;
 			}
 		}
 		
@@ -319,30 +339,38 @@ namespace Enki
 		return true;
 	}
 	
-	bool Polygon::doesIntersect(const Point& center, const double r, Vector& mtv, Point& intersectionPoint) const
+	bool Polygon::doesIntersect(const Point& center, const Scalar r, Vector& mtv, Point& intersectionPoint) const
+	{
+		SmallVector<Vector, 16> normals;
+		getNormals(normals);
+		return doesIntersect(center, r, normals.data(), mtv, intersectionPoint);
+	}
+	
+	bool Polygon::doesIntersect(const Point& center, const Scalar r, const Vector* normals, Vector& mtv, Point& intersectionPoint) const
 	{
 		// Note: does not handle optimally the case of full overlapping
 		
 		// Using the Separate Axis Theorem, see for instance: http://www.dyn4j.org/2010/01/sat/
-		double minMTVDist(std::numeric_limits<double>::max());
+		Scalar minMTVDist(std::numeric_limits<Scalar>::max());
 		Vector minMTV;
 		Vector minCollisionPoint;
 		
 		// test if circle is inside a shape
 		for (size_t i = 0; i < size(); ++i)
 		{
-			const Segment segment(getSegment(i));
-			const Vector normal(segment.getDirection().perp());
-			const Vector u(normal.unitary());
+			const Point& a((*this)[i]);
+			const Point& b((*this)[i + 1 == size() ? 0 : i + 1]);
+			const Vector& n(normals[i]);
 			// positive distance for inside
-			double dist((center-segment.a)*u + r);
+			const Scalar dist((a - center) * n + r);
 			// if circle is outside, we found a separate axis
 			if (dist <= 0)
 				return false;
 			// no, we need to check whether the projection of center is on the segment
-			const Point proj(center + u*(r-dist));
-			const double prodA((proj - segment.a) * segment.getDirection());
-			const double prodB((proj - segment.b) * segment.getDirection());
+			const Point proj(center - n * (r - dist));
+			const Vector direction(b - a);
+			const Scalar prodA((proj - a) * direction);
+			const Scalar prodB((proj - b) * direction);
 			// yes?
 			if (prodA >= 0 && prodB <= 0)
 			{
@@ -350,14 +378,14 @@ namespace Enki
 				if (dist < minMTVDist)
 				{
 					minMTVDist = dist;
-					minMTV = u * dist;
+					minMTV = -n * dist;
 					minCollisionPoint = proj + minMTV;
 				}
 			}
 		}
 		
 		// if found a solution so far, update collision variables and return it
-		if (minMTVDist != std::numeric_limits<double>::max())
+		if (minMTVDist != std::numeric_limits<Scalar>::max())
 		{
 			mtv = minMTV;
 			intersectionPoint = minCollisionPoint;
@@ -365,23 +393,23 @@ namespace Enki
 		}
 		
 		// at this point if there is a collision, we know that there is a vertex inside the circle
-		double minPointCenterDist2(std::numeric_limits<double>::max());
+		Scalar minPointCenterDist2(std::numeric_limits<Scalar>::max());
 		
 		// test if there is vertex of shape is inside the circle. If so, take the closest to the center.
 		for (size_t i = 0; i < size(); ++i)
 		{
 			const Vector centerToPoint((*this)[i] - center);
-			const double d2(centerToPoint.norm2());
+			const Scalar d2(centerToPoint.norm2());
 			if (d2 < minPointCenterDist2 && d2 <= r*r)
 			{
 				minPointCenterDist2 = d2;
-				minMTV = centerToPoint.unitary() * (r - sqrt(d2));
+				minMTV = centerToPoint.unitary() * (r - std::sqrt(d2));
 				minCollisionPoint = center + centerToPoint + minMTV;
 			}
 		}
 		
 		// no vertex inside the circle, no collision
-		if (minPointCenterDist2 == std::numeric_limits<double>::max())
+		if (minPointCenterDist2 == std::numeric_limits<Scalar>::max())
 			return false;
 		
 		// collision, update collision variables...
@@ -46,6 +46,7 @@
 #include <limits>
 #include <ostream>
 #include <algorithm>
+#include "SmallVector.h"
 
 /*!	\file Geometry.h
 	\brief The mathematic classes for 2D geometry
@@ -53,6 +54,14 @@
 
 namespace Enki
 {
+#ifdef ENKI_SINGLE_PRECISION
+	//! The floating-point type of coordinates, colors and shapes; float in the single-precision build of libenki
+	typedef float Scalar;
+#else
+	//! The floating-point type of coordinates, colors and shapes; double unless libenki is built with ENKI_SINGLE_PRECISION
+	typedef double Scalar;
+#endif
+	
 	//! A vector in a 2D space
 	/*! \ingroup an 
 		Notation of values and constructor order arguments are column based:
@@ -64,57 +73,57 @@ namespace Enki
 	struct Vector
 	{
 		//! x component
-		double x;
+		Scalar x;
 		//! y component
-		double y;
+		Scalar y;
 	
 		//! Constructor, create vector with coordinates (0, 0)
 		Vector() { x = y = 0; }
 		//! Constructor, create vector with coordinates (v, v)
-		Vector(double v) { this->x = v; this->y = v; }
+		Vector(Scalar v) { this->x = v; this->y = v; }
 		//! Constructor, create vector with coordinates (x, y)
-		Vector(double x, double y) { this->x = x; this->y = y; }
+		Vector(Scalar x, Scalar y) { this->x = x; this->y = y; }
 		//! Constructor, create vector with coordinates (array[0], array[1])
-		Vector(double array[2]) { x = array[0]; y = array[1]; }
+		Vector(Scalar array[2]) { x = array[0]; y = array[1]; }
 	
 		//! Add vector v component by component
 		void operator +=(const Vector &v) { x += v.x; y += v.y; }
 		//! Substract vector v component by component
 		void operator -=(const Vector &v) { x -= v.x; y -= v.y; }
 		//! Multiply each component by scalar f
-		void operator *=(double f) { x *= f; y *= f; }
+		void operator *=(Scalar f) { x *= f; y *= f; }
 		//! Divive each component by scalar f
-		void operator /=(double f) { x /= f; y /= f; }
+		void operator /=(Scalar f) { x /= f; y /= f; }
 		//! Add vector v component by component and return the resulting vector
 		Vector operator +(const Vector &v) const { Vector n; n.x = x + v.x; n.y = y + v.y; return n; }
 		//! Substract vector v component by component and return the resulting vector
 		Vector operator -(const Vector &v) const { Vector n; n.x = x - v.x; n.y = y - v.y; return n; }
 		//! Multiply each component by scalar f and return the resulting vector
-		Vector operator /(double f) const { Vector n; n.x = x/f; n.y = y/f; return n; }
+		Vector operator /(Scalar f) const { Vector n; n.x = x/f; n.y = y/f; return n; }
 		//! Divive each component by scalar f and return the resulting vector
-		Vector operator *(double f) const { Vector n; n.x = x*f; n.y = y*f; return n; }
+		Vector operator *(Scalar f) const { Vector n; n.x = x*f; n.y = y*f; return n; }
 		//! Invert this vector
 		Vector operator -() const { return Vector(-x, -y); }
 	
 		//! Return the scalar product with vector v
-		double operator *(const Vector &v) const { return x*v.x + y*v.y; }
+		Scalar operator *(const Vector &v) const { return x*v.x + y*v.y; }
 		//! Return the norm of this vector
-		double norm(void) const { return sqrt(x*x + y*y); }
+		Scalar norm(void) const { return std::sqrt(x*x + y*y); }
 		//! Return the square norm of this vector (and thus avoid a square root)
-		double norm2(void) const { return x*x+y*y; }
+		Scalar norm2(void) const { return x*x+y*y; }
 		//! Return the cross product with vector v
-		double cross(const Vector &v) const { return x * v.y - y * v.x; }
+		Scalar cross(const Vector &v) const { return x * v.y - y * v.x; }
 		//! Return a unitary vector of same direction
-		Vector unitary(void) const { if (norm() < std::numeric_limits<double>::epsilon()) return Vector(); return *this / norm(); }
+		Vector unitary(void) const { if (norm() < std::numeric_limits<Scalar>::epsilon()) return Vector(); return *this / norm(); }
 		//! Return the angle with the horizontal (arc tangant (y/x))
-		double angle(void) const { return atan2(y, x); }
+		double angle(void) const { return std::atan2(y, x); }
 		//! Return the perpendicular of the same norm in math. orientation (CCW)
 		Vector perp(void) const { return Vector(-y, x); }
 		
 		//! Return the cross with (this x other) a (virtual, as we are in 2D) perpendicular vector (on axis z) of given norm. 
-		Vector crossWithZVector(double l) const { return Vector(y * l, -x * l); }
+		Vector crossWithZVector(Scalar l) const { return Vector(y * l, -x * l); }
 		//! Return the cross from (other x this) a (virtual, as we are in 2D) perpendicular vector (on axis z) of given norm. 
-		Vector crossFromZVector(double l) const { return Vector(-y * l, x * l); }
+		Vector crossFromZVector(Scalar l) const { return Vector(-y * l, x * l); }
 		
 		//! Comparison operator
 		bool operator <(const Vector& that) const { if (this->x == that.x) return (this->y < that.y); else return (this->x < that.x); }
@@ -141,22 +150,22 @@ namespace Enki
 	{
 		// line-column component
 		//! 11 components
-		double _11;
+		Scalar _11;
 		//! 21 components
-		double _21;
+		Scalar _21;
 		//! 12 components
-		double _12;
+		Scalar _12;
 		//! 22 components
-		double _22;
+		Scalar _22;
 	
 		//! Constructor, create matrix with 0
 		Matrix22() { _11 = _21 = _12 = _22 = 0; }
 		//! Constructor, create matrix with _11 _21 _12 _22
-		Matrix22(double _11, double _21, double _12, double _22) { this->_11 = _11; this->_21 = _21; this->_12 = _12; this->_22 = _22; }
+		Matrix22(Scalar _11, Scalar _21, Scalar _12, Scalar _22) { this->_11 = _11; this->_21 = _21; this->_12 = _12; this->_22 = _22; }
 		//! Constructor, create rotation matrix of angle alpha in radian
 		Matrix22(double alpha) { _11 = cos(alpha); _21 = sin(alpha); _12 = -_21; _22 = _11; }
 		//! Constructor, create matrix with array[0] array[1] array[2] array[3]
-		Matrix22(double array[4]) { _11=array[0]; _21=array[1]; _12=array[2]; _22=array[3]; }
+		Matrix22(Scalar array[4]) { _11=array[0]; _21=array[1]; _12=array[2]; _22=array[3]; }
 		
 		//! Fill with zero
 		void zeros() { _11 = _21 = _12 = _22 = 0; }
@@ -166,17 +175,17 @@ namespace Enki
 		//! Substract matrix v component by component
 		void operator -=(const Matrix22 &v) { _11 -= v._11; _21 -= v._21; _12 -= v._12; _22 -= v._22; }
 		//! Multiply each component by scalar f
-		void operator *=(double f) { _11 *= f; _21 *= f; _12 *= f; _22 *= f; }
+		void operator *=(Scalar f) { _11 *= f; _21 *= f; _12 *= f; _22 *= f; }
 		//! Divive each component by scalar f
-		void operator /=(double f) { _11 /= f; _21 /= f; _12 /= f; _22 /= f; }
+		void operator /=(Scalar f) { _11 /= f; _21 /= f; _12 /= f; _22 /= f; }
 		//! Add matrix v component by component and return the resulting matrix
 		Matrix22 operator +(const Matrix22 &v) const { Matrix22 n; n._11 = _11 + v._11; n._21 = _21 + v._21; n._12 = _12 + v._12; n._22 = _22 + v._22; return n; }
 		//! Subtract matrix v component by component and return the resulting matrix
 		Matrix22 operator -(const Matrix22 &v) const { Matrix22 n; n._11 = _11 - v._11; n._21 = _21 - v._21; n._12 = _12 - v._12; n._22 = _22 - v._22; return n; }
 		//! Multiply each component by scalar f and return the resulting matrix
-		Matrix22 operator *(double f) const { Matrix22 n; n._11 = _11 * f; n._21 = _21 * f; n._12 = _12 * f; n._22 = _22 * f; return n; }
+		Matrix22 operator *(Scalar f) const { Matrix22 n; n._11 = _11 * f; n._21 = _21 * f; n._12 = _12 * f; n._22 = _22 * f; return n; }
 		//! Divide each component by scalar f and return the resulting matrix
-		Matrix22 operator /(double f) const { Matrix22 n; n._11 = _11 / f; n._21 = _21 / f; n._12 = _12 / f; n._22 = _22 / f; return n; }
+		Matrix22 operator /(Scalar f) const { Matrix22 n; n._11 = _11 / f; n._21 = _21 / f; n._12 = _12 / f; n._22 = _22 / f; return n; }
 		//! Return the transpose of the matrix
 		Matrix22 transpose() const { Matrix22 n; n._11 = _11; n._21 = _12; n._12 = _21; n._22 = _22; return n; }
 		
@@ -184,7 +193,7 @@ namespace Enki
 		Point operator*(const Point &v) const { Point n; n.x = v.x*_11 + v.y*_12; n.y = v.x*_21 + v.y*_22; return n; }
 		
 		//! Creates a diagonal matrix
-		static Matrix22 fromDiag(double _1, double _2 ) { return Matrix22(_1, 0, 0, _2); }
+		static Matrix22 fromDiag(Scalar _1, Scalar _2 ) { return Matrix22(_1, 0, 0, _2); }
 		//! Create an identity matrix
 		static Matrix22 identity() { return fromDiag(1, 1); }
 	};
@@ -194,9 +203,9 @@ namespace Enki
 	struct Segment
 	{
 		//! Constructor, create segment from point (ax, ay) to point (bx, by)
-		Segment(double ax, double ay, double bx, double by) { this->a.x = ax; this->a.y = ay; this->b.x = bx; this->b.y = by; }
+		Segment(Scalar ax, Scalar ay, Scalar bx, Scalar by) { this->a.x = ax; this->a.y = ay; this->b.x = bx; this->b.y = by; }
 		//! Constructor, create segment from point (array[0], array[1]) to point (array[2], array[3])
-		Segment(double array[4]) { a.x = array[0]; a.y = array[1]; b.x = array[2]; b.y = array[3]; }
+		Segment(Scalar array[4]) { a.x = array[0]; a.y = array[1]; b.x = array[2]; b.y = array[3]; }
 		//! Constructor, create segment from point p1 to point p2
 		Segment(const Point &p1, const Point &p2) { a = p1; b = p2; }
 		
@@ -206,7 +215,7 @@ namespace Enki
 		Point b;
 	
 		//! Compute the distance of p to this segment
-		double dist(const Point &p) const;
+		Scalar dist(const Point &p) const;
 	
 		//! Return true if o intersect this segment
 		bool doesIntersect(const Segment &that, Point* intersectionPoint = 0) const;
@@ -226,8 +235,10 @@ namespace Enki
 	std::ostream & operator << (std::ostream & outs, const Segment &segment);
 	
 	//! Polygon, which is a vector of points. Anti-clockwise, standard trigonometric orientation
-	/*! \ingroup an */
-	struct Polygon: public std::vector<Point>
+	/*! \ingroup an
+		Polygons of up to 16 points are stored inline.
+	*/
+	struct Polygon: public SmallVector<Point, 16>
 	{
 		//! Return the i-th segment
 		Segment getSegment(size_t i) const;
@@ -235,6 +246,9 @@ namespace Enki
 		//! Return true if p is inside this polygon
 		bool isPointInside(const Point& p) const;
 		
+		//! Fill normals with the outward unit normals of the sides of this polygon, normals[i] being the one of side (this[i], this[i+1])
+		void getNormals(SmallVector<Vector, 16>& normals) const;
+		
 		//! Get the axis aligned bounding box and return whether it exists
 		bool getAxisAlignedBoundingBox(Point& bottomLeft, Point& topRight) const;
 		
@@ -242,13 +256,13 @@ namespace Enki
 		void extendAxisAlignedBoundingBox(Point& bottomLeft, Point& topRight) const;
 		
 		//! Return the bounding radius of this polygon
-		double getBoundingRadius() const;
+		Scalar getBoundingRadius() const;
 		
 		//! Translate of a specific distance
 		void translate(const Vector& delta);
 		
 		//! Translate of a specific distance, overload for convenience
-		void translate(const double x, const double y) { translate(Vector(x, y)); }
+		void translate(const Scalar x, const Scalar y) { translate(Vector(x, y)); }
 		
 		//! Rotate by a specific angle
 		void rotate(const double angle);
@@ -269,7 +283,10 @@ namespace Enki
 			\param mtv minimum translation vector, how much to move this for de-penetration, set if intersection happens
 			\param intersectionPoint point where this touches circle, set if intersection happens
 		*/
-		bool doesIntersect(const Point& center, const double r, Vector& mtv, Point& intersectionPoint) const;
+		bool doesIntersect(const Point& center, const Scalar r, Vector& mtv, Point& intersectionPoint) const;
+		
+		//! Same as doesIntersect(center, r, mtv, intersectionPoint), with the outward unit normals of the sides of this precomputed, normals[i] being the one of side (this[i], this[i+1])
+		bool doesIntersect(const Point& center, const Scalar r, const Vector* normals, Vector& mtv, Point& intersectionPoint) const;
 		
 		//! Return true and set intersection arguments (passed by reference) if shape1 intersects shape2, return false and do not change anything otherwise
 		/*!
@@ -278,6 +295,9 @@ namespace Enki
 			\param intersectionPoint point where this touches that, set if intersection happens
 		*/
 		bool doesIntersect(const Polygon& that, Vector& mtv, Point& intersectionPoint) const;
+		
+		//! Same as doesIntersect(that, mtv, intersectionPoint), with the outward unit normals of the sides of this and that precomputed, as returned by getNormals()
+		bool doesIntersect(const Polygon& that, const Vector* thisNormals, const Vector* thatNormals, Vector& mtv, Point& intersectionPoint) const;
 	};
 	
 	//! Print a polygon to a stream
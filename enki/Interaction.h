@@ -47,6 +47,8 @@ namespace Enki
 	class PhysicalObject;
 	class Robot;
 	class World;
+	class StateWriter;
+	class StateReader;
 
 	//! Interacts with another object or wall only up to a certain distance
 	/*! \ingroup core */
@@ -86,6 +88,10 @@ namespace Enki
 		virtual void finalize(double dt, World* w) { }
 		//! Return the range of the interaction
 		double getRange() const { return r; }
+		//! Append the dynamic state of this interaction, such as its sensor buffers, to state; save nothing by default
+		virtual void saveState(StateWriter& state) const { }
+		//! Load the dynamic state saved by saveState() from state; load nothing by default
+		virtual void loadState(StateReader& state) { }
 	};
 
 	//! Interacts with the whole world
@@ -109,6 +115,10 @@ namespace Enki
 		virtual void step(double dt, World *w) { }
 		//! Finalize at each step
 		virtual void finalize(double dt, World *w) { }
+		//! Append the dynamic state of this interaction to state; save nothing by default
+		virtual void saveState(StateWriter& state) const { }
+		//! Load the dynamic state saved by saveState() from state; load nothing by default
+		virtual void loadState(StateReader& state) { }
 	};
 }
 #endif
@@ -32,11 +32,17 @@
 */
 
 #include "PhysicalEngine.h"
+#include "TrajectoryRecorder.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <algorithm>
 #include <limits>
+#include <atomic>
+#include <typeinfo>
+#include <mutex>
+#include <cstring>
+#include <cstdint>
 
 // _________________________________
 //
@@ -46,64 +52,110 @@
 
 namespace Enki
 {
-	//switching to an std::atomic<unsigned> when in the future we switch to C++11
-	static unsigned int uidNewObject = 0;
+	//! Identifier of the next object, atomic as objects might be created by several threads
+	static std::atomic<unsigned> uidNewObject(0);
 
-	FastRandom random;
+	thread_local FastRandom random;
 	
-	// PhysicalObject::Part
-	
-	PhysicalObject::Part::Part(const Polygon& shape, double height) :
-		height(height),
-		shape(shape)
+	//! Install the random generator of a world as Enki::random of the calling thread during its lifetime
+	struct WorldRandomScope
 	{
-		computeAreaAndCentroid();
+		//! The random generator of the world, holds the one of the thread while in scope
+		FastRandom& worldRandom;
 		
-		transformedShape.resize(shape.size());
+		//! Constructor, swap in the generator of the world
+		WorldRandomScope(FastRandom& worldRandom) : worldRandom(worldRandom) { std::swap(random, worldRandom); }
+		//! Destructor, give back its generator to the world
+		~WorldRandomScope() { std::swap(random, worldRandom); }
+	};
+	
+	// PhysicalObject::HullPrototype
+	
+	//! Hash a double by its bit pattern, so that prototypes are only shared between exactly identical geometries
+	static void hashCombine(size_t& hash, double value)
+	{
+		uint64_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		hash ^= std::hash<uint64_t>()(bits) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
 	}
 	
-	PhysicalObject::Part::Part(const Polygon& shape, double height, const Textures& textures) :
-		height(height),
-		shape(shape),
-		textures(textures)
+	//! Return whether two doubles have the same bit pattern
+	static bool isIdentical(double a, double b)
 	{
-		computeAreaAndCentroid();
-		
-		transformedShape.resize(shape.size());
+		return memcmp(&a, &b, sizeof(double)) == 0;
+	}
+	
+	//! The prototypes alive, indexed by their hash
+	struct HullPrototypeRegistry
+	{
+		//! The prototypes alive, they remove themselves upon destruction
+		std::unordered_multimap<size_t, const PhysicalObject::HullPrototype*> prototypes;
+		//! Protects prototypes, as objects might be created by several threads
+		std::mutex mutex;
 		
-		if (textures.size() != shape.size())
+		//! Return the registry, never destroyed so that prototypes can outlive static objects
+		static HullPrototypeRegistry& instance()
 		{
-			std::cerr << "Error: PhysicalObject::Part::Part: texture sides count " << textures.size() << " missmatch shape sides count " << shape.size() << std::endl;
-			std::cerr << "\tignoring textures for this object" << std::endl;
-			this->textures.clear();
-			return;
+			static HullPrototypeRegistry* registry(new HullPrototypeRegistry);
+			return *registry;
 		}
 		
-		for (size_t i = 0; i < textures.size(); ++i)
+		//! Destroy a prototype and remove it from the registry
+		static void release(const PhysicalObject::HullPrototype* prototype)
 		{
-			if (textures[i].size() == 0)
+			HullPrototypeRegistry& registry(instance());
 			{
-				std::cerr << "Error: PhysicalObject::Part::Part: texture for side " << i << " contains no data" << std::endl;
-				std::cerr << "\tignoring textures for this object" << std::endl;
-				this->textures.clear();
-				return;
+				std::lock_guard<std::mutex> lock(registry.mutex);
+				auto range(registry.prototypes.equal_range(prototype->hash));
+				for (auto it = range.first; it != range.second; ++it)
+					if (it->second == prototype)
+					{
+						registry.prototypes.erase(it);
+						break;
+					}
 			}
+			delete prototype;
 		}
-	}
+	};
 	
-	PhysicalObject::Part::Part(double l1, double l2, double height) :
-		height(height),
-		area(l1*l2),
-		centroid(0, 0)
+	std::shared_ptr<const PhysicalObject::HullPrototype> PhysicalObject::HullPrototype::get(const Polygon& shape, double height, const Textures& textures)
 	{
-		const double hl1 = l1 / 2;
-		const double hl2 = l2 / 2;
+		size_t hash(shape.size());
+		hashCombine(hash, height);
+		for (size_t i = 0; i < shape.size(); ++i)
+		{
+			hashCombine(hash, shape[i].x);
+			hashCombine(hash, shape[i].y);
+		}
+		for (size_t i = 0; i < textures.size(); ++i)
+			for (size_t j = 0; j < textures[i].size(); ++j)
+				for (size_t k = 0; k < 4; ++k)
+					hashCombine(hash, textures[i][j][k]);
 		
-		shape << Point(-hl1, -hl2) << Point(hl1, -hl2) << Point(hl1, hl2) << Point(-hl1, hl2);
-		transformedShape.resize(shape.size());
+		HullPrototypeRegistry& registry(HullPrototypeRegistry::instance());
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		auto range(registry.prototypes.equal_range(hash));
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			const HullPrototype* prototype(it->second);
+			if (!prototype->isIdentical(shape, height, textures))
+				continue;
+			// the prototype might be being released by another thread, in which case it is not shared anymore
+			std::shared_ptr<const HullPrototype> shared(prototype->self.lock());
+			if (shared)
+				return shared;
+		}
+		std::shared_ptr<const HullPrototype> prototype(new HullPrototype(shape, height, textures, hash), HullPrototypeRegistry::release);
+		prototype->self = prototype;
+		registry.prototypes.insert(std::make_pair(hash, prototype.get()));
+		return prototype;
 	}
 	
-	void PhysicalObject::Part::computeAreaAndCentroid()
+	PhysicalObject::HullPrototype::HullPrototype(const Polygon& shape, double height, const Textures& textures, size_t hash) :
+		height(height),
+		shape(shape),
+		textures(textures),
+		hash(hash)
 	{
 		// from: http://local.wasp.uwa.edu.au/~pbourke/geometry/polyarea/
 		const size_t size = shape.size();
@@ -125,26 +177,155 @@ namespace Enki
 			centroid.y += (shape[i].y + shape[(i+1) % size].y) * multiplicator;
 		}
 		centroid /= (6 * area);
+		
+		// bounding circle around the centroid
+		boundingRadius = 0;
+		for (size_t i = 0; i < size; ++i)
+			boundingRadius = std::max(boundingRadius, (shape[i] - centroid).norm());
+		
+		// polar second moment of area around the origin, then around the centroid by the parallel axis theorem
+		secondMoment = 0;
+		for (size_t i = 0; i < size; ++i)
+		{
+			const Point& p0(shape[i]);
+			const Point& p1(shape[(i+1) % size]);
+			const double multiplicator = (p0.x * p1.y - p1.x * p0.y);
+			secondMoment += (p0.x * p0.x + p0.x * p1.x + p1.x * p1.x + p0.y * p0.y + p0.y * p1.y + p1.y * p1.y) * multiplicator;
+		}
+		secondMoment /= 12;
+		secondMoment -= area * centroid.norm2();
+		
+		// outward normals, which depend on the orientation of the shape
+		normals.reserve(size);
+		const double orientation(area < 0 ? -1 : 1);
+		for (size_t i = 0; i < size; ++i)
+		{
+			const Vector side(shape[(i+1) % size] - shape[i]);
+			normals.push_back(Vector(side.y, -side.x) * (orientation / side.norm()));
+		}
+	}
+	
+	bool PhysicalObject::HullPrototype::isIdentical(const Polygon& shape, double height, const Textures& textures) const
+	{
+		if (!Enki::isIdentical(this->height, height) || this->shape.size() != shape.size() || this->textures.size() != textures.size())
+			return false;
+		for (size_t i = 0; i < shape.size(); ++i)
+			if (!Enki::isIdentical(this->shape[i].x, shape[i].x) || !Enki::isIdentical(this->shape[i].y, shape[i].y))
+				return false;
+		for (size_t i = 0; i < textures.size(); ++i)
+		{
+			if (this->textures[i].size() != textures[i].size())
+				return false;
+			for (size_t j = 0; j < textures[i].size(); ++j)
+				for (size_t k = 0; k < 4; ++k)
+					if (!Enki::isIdentical(this->textures[i][j][k], textures[i][j][k]))
+						return false;
+		}
+		return true;
+	}
+	
+	// PhysicalObject::Part
+	
+	PhysicalObject::Part::Part(const Polygon& shape, double height) :
+		prototype(HullPrototype::get(shape, height))
+	{
+		transformedShape.resize(shape.size());
+		transformedNormals.resize(shape.size());
+	}
+	
+	//! Return textures if they match the sides of shape, otherwise print an error and return no texture
+	static Textures validTextures(const Polygon& shape, const Textures& textures)
+	{
+		if (textures.size() != shape.size())
+		{
+			std::cerr << "Error: PhysicalObject::Part::Part: texture sides count " << textures.size() << " missmatch shape sides count " << shape.size() << std::endl;
+			std::cerr << "\tignoring textures for this object" << std::endl;
+			return Textures();
+		}
+		
+		for (size_t i = 0; i < textures.size(); ++i)
+		{
+			if (textures[i].size() == 0)
+			{
+				std::cerr << "Error: PhysicalObject::Part::Part: texture for side " << i << " contains no data" << std::endl;
+				std::cerr << "\tignoring textures for this object" << std::endl;
+				return Textures();
+			}
+		}
+		
+		return textures;
+	}
+	
+	PhysicalObject::Part::Part(const Polygon& shape, double height, const Textures& textures) :
+		prototype(HullPrototype::get(shape, height, validTextures(shape, textures)))
+	{
+		transformedShape.resize(shape.size());
+		transformedNormals.resize(shape.size());
+	}
+	
+	//! Return a rectangle of size l1xl2 centered around the origin
+	static Polygon rectangle(double l1, double l2)
+	{
+		const double hl1 = l1 / 2;
+		const double hl2 = l2 / 2;
+		
+		Polygon shape;
+		shape << Point(-hl1, -hl2) << Point(hl1, -hl2) << Point(hl1, hl2) << Point(-hl1, hl2);
+		return shape;
+	}
+	
+	PhysicalObject::Part::Part(double l1, double l2, double height) :
+		prototype(HullPrototype::get(rectangle(l1, l2), height))
+	{
+		transformedShape.resize(4);
+		transformedNormals.resize(4);
 	}
 	
 	void PhysicalObject::Part::computeTransformedShape(const Matrix22& rot, const Point& trans)
 	{
+		const Polygon& shape(prototype->getShape());
 		assert(!shape.empty());
 		assert(transformedShape.size() == shape.size());
+		const std::vector<Vector>& normals(prototype->getNormals());
 		for (size_t i = 0; i < shape.size(); ++i)
-			transformedShape[i] = rot * (shape)[i] + trans;
-		transformedCentroid = rot * centroid + trans;
+		{
+			transformedShape[i] = rot * shape[i] + trans;
+			transformedNormals[i] = rot * normals[i];
+		}
+		transformedBottomLeft = transformedShape[0];
+		transformedTopRight = transformedShape[0];
+		for (size_t i = 1; i < shape.size(); ++i)
+		{
+			transformedBottomLeft.x = std::min(transformedBottomLeft.x, transformedShape[i].x);
+			transformedBottomLeft.y = std::min(transformedBottomLeft.y, transformedShape[i].y);
+			transformedTopRight.x = std::max(transformedTopRight.x, transformedShape[i].x);
+			transformedTopRight.y = std::max(transformedTopRight.y, transformedShape[i].y);
+		}
+		transformedCentroid = rot * prototype->getCentroid() + trans;
 	}
 	
 	void PhysicalObject::Part::applyTransformation(const Matrix22& rot, const Point& trans, double* radius = 0)
 	{
+		const Polygon& shape(prototype->getShape());
+		
+		// the identity keeps the prototype, typically when only the radius is needed
+		if (rot._11 == 1 && rot._21 == 0 && rot._12 == 0 && rot._22 == 1 && trans.x == 0 && trans.y == 0)
+		{
+			if (radius)
+				for (size_t i = 0; i < shape.size(); ++i)
+					*radius = std::max<double>(*radius, shape[i].norm());
+			return;
+		}
+		
+		Polygon newShape;
+		newShape.resize(shape.size());
 		for (size_t i = 0; i < shape.size(); ++i)
 		{
-			(shape)[i] = rot * (shape)[i] + trans;
+			newShape[i] = rot * shape[i] + trans;
 			if (radius)
-				*radius = std::max(*radius, shape[i].norm());
+				*radius = std::max<double>(*radius, newShape[i].norm());
 		}
-		centroid = rot * centroid + trans;
+		prototype = HullPrototype::get(newShape, prototype->getHeight(), prototype->getTextures());
 	}
 	
 	
@@ -238,6 +419,14 @@ namespace Enki
 		angle(0),
 		angSpeed(0),
 		interlacedDistance(0),
+		transformedShapeValid(false),
+		transformedAngle(0),
+		sleeping(false),
+		stillSubsteps(0),
+		sleepAngle(0),
+		sleepAngSpeed(0),
+		bodyType(BODY_DYNAMIC),
+		kinematicTime(0),
 		uid(uidNewObject++)
 	{
 		setCylindric(1, 1, 1);
@@ -264,17 +453,19 @@ namespace Enki
 	{
 		// remove any hull
 		hull.clear();
+		buildPartHierarchy();
 		this->height = height;
 		
 		// update the physical and interaction radius
 		r = radius;
 		
-		// set the mass
-		this->mass = mass;
+		// set the mass, objects that are not dynamic keep an infinite one
+		this->mass = bodyType == BODY_DYNAMIC ? mass : -1;
 		
 		// update the moment of inertia
 		computeMomentOfInertia();
 		
+		dirtyTransformedShape();
 		dirtyUserData();
 	}
 	
@@ -286,13 +477,15 @@ namespace Enki
 		
 		// compute the center of mass
 		setupCenterOfMass();
+		buildPartHierarchy();
 		
-		// set the mass
-		this->mass = mass;
+		// set the mass, objects that are not dynamic keep an infinite one
+		this->mass = bodyType == BODY_DYNAMIC ? mass : -1;
 		
 		// update the moment of inertia
 		computeMomentOfInertia();
 		
+		dirtyTransformedShape();
 		dirtyUserData();
 	}
 	
@@ -306,13 +499,15 @@ namespace Enki
 		
 		// compute the center of mass
 		setupCenterOfMass();
+		buildPartHierarchy();
 		
-		// set the mass
-		this->mass = mass;
+		// set the mass, objects that are not dynamic keep an infinite one
+		this->mass = bodyType == BODY_DYNAMIC ? mass : -1;
 		
 		// update the moment of inertia
 		computeMomentOfInertia();
 		
+		dirtyTransformedShape();
 		dirtyUserData();
 	}
 	
@@ -324,6 +519,44 @@ namespace Enki
 		
 	}
 	
+	void PhysicalObject::setDynamic(double mass)
+	{
+		bodyType = BODY_DYNAMIC;
+		kinematicTrajectory = KinematicTrajectory();
+		this->mass = mass;
+		computeMomentOfInertia();
+		wakeUp();
+	}
+	
+	void PhysicalObject::setStatic()
+	{
+		bodyType = BODY_STATIC;
+		kinematicTrajectory = KinematicTrajectory();
+		mass = -1;
+		computeMomentOfInertia();
+		speed = Vector(0, 0);
+		angSpeed = 0;
+		wakeUp();
+	}
+	
+	void PhysicalObject::setKinematic(const KinematicTrajectory& trajectory)
+	{
+		if (!trajectory)
+		{
+			std::cerr << "Error: PhysicalObject::setKinematic: empty trajectory, body type unchanged" << std::endl;
+			return;
+		}
+		bodyType = BODY_KINEMATIC;
+		kinematicTrajectory = trajectory;
+		kinematicTime = 0;
+		mass = -1;
+		computeMomentOfInertia();
+		speed = Vector(0, 0);
+		angSpeed = 0;
+		kinematicTrajectory(kinematicTime, pos, angle);
+		wakeUp();
+	}
+	
 	void PhysicalObject::computeMomentOfInertia()
 	{
 		if (hull.empty())
@@ -332,27 +565,16 @@ namespace Enki
 		}
 		else
 		{
-			// Numerical method:
-			// arbitrary shaped object, numerically compute moment of inertia
-			momentOfInertia = 0;
-			double numericalArea = 0;
-			const double dr = r / 50.;
-			for (double ix = -r; ix < r; ix += dr)
-				for (double iy = -r; iy < r; iy += dr)
-					for (Hull::const_iterator it = hull.begin(); it != hull.end(); ++it)
-						if (it->shape.isPointInside(Point(ix, iy)))
-						{
-							momentOfInertia += ix * ix + iy * iy;
-							numericalArea++;
-						}
-			
-			momentOfInertia *= mass / numericalArea;
-			
-			// Exact method:
-			/*
-			TODO: check this and implement
-			http://lab.polygonal.de/2006/08/17/calculating-the-moment-of-inertia-of-a-convex-polygon/
-			*/
+			// Exact method: sum the second moments of parts around the origin, using the parallel axis theorem;
+			// as the second moment of a part around its centroid does not change when it is moved, no polygon is traversed here
+			double area = 0;
+			double secondMoment = 0;
+			for (Hull::const_iterator it = hull.begin(); it != hull.end(); ++it)
+			{
+				area += it->getArea();
+				secondMoment += it->getSecondMoment() + it->getArea() * it->getCentroid().norm2();
+			}
+			momentOfInertia = mass * secondMoment / area;
 		}
 	}
 	
@@ -418,14 +640,46 @@ namespace Enki
 		}
 	}
 	
+	void PhysicalObject::buildPartHierarchy()
+	{
+		partHierarchy.clear();
+		if (hull.size() <= BoxHierarchy::leafSize)
+			return;
+		// split at centroids, as they keep their relative positions when the object moves
+		std::vector<Point> centroids;
+		centroids.reserve(hull.size());
+		for (Hull::const_iterator it = hull.begin(); it != hull.end(); ++it)
+			centroids.push_back(it->getCentroid());
+		partHierarchy.build(centroids);
+	}
+	
 	void PhysicalObject::computeTransformedShape()
 	{
-		if (!hull.empty())
-		{
-			Matrix22 rotMat(angle);
-			for (Hull::iterator it = hull.begin(); it != hull.end(); ++it)
-				it->computeTransformedShape(rotMat, pos);
-		}
+		// the rotation is also needed without hull, by the interactions of robots
+		transformedRotation = Matrix22(angle);
+		for (Hull::iterator it = hull.begin(); it != hull.end(); ++it)
+			it->computeTransformedShape(transformedRotation, pos);
+		
+		partHierarchy.refit([this](unsigned index, Point& bottomLeft, Point& topRight) {
+			bottomLeft = hull[index].getTransformedBottomLeft();
+			topRight = hull[index].getTransformedTopRight();
+		});
+		transformedShapeValid = true;
+		transformedPos = pos;
+		transformedAngle = angle;
+	}
+	
+	void PhysicalObject::updateTransformedShape()
+	{
+		// the pose acts as version of the hull in world coordinates, as it can be written directly
+		if (transformedShapeValid && pos == transformedPos && angle == transformedAngle)
+			return;
+		computeTransformedShape();
+	}
+	
+	void PhysicalObject::dirtyTransformedShape()
+	{
+		transformedShapeValid = false;
 	}
 	
 	
@@ -512,30 +766,100 @@ namespace Enki
 		angSpeed += angAcc * dt;
 	}
 
-	void PhysicalObject::initPhysicsInteractions(double dt)
+	bool PhysicalObject::canSleep() const
 	{
-		applyForces(dt);
-		
-		pos += speed * dt;
-		angle += angSpeed * dt;
-		computeTransformedShape();
-		
-		// store position after integration
-		posBeforeCollision  = pos;
+		return typeid(*this) == typeid(PhysicalObject);
 	}
-
-	void PhysicalObject::finalizePhysicsInteractions(double dt)
+	
+	void PhysicalObject::wakeUp()
+	{
+		sleeping = false;
+		stillSubsteps = 0;
+	}
+	
+	void PhysicalObject::fallAsleep()
+	{
+		// only write if required, not to change the sign of zeros
+		if (speed.norm2() != 0)
+			speed = Vector(0, 0);
+		if (angSpeed != 0)
+			angSpeed = 0;
+		sleeping = true;
+		sleepPos = pos;
+		sleepAngle = angle;
+		sleepSpeed = speed;
+		sleepAngSpeed = angSpeed;
+	}
+	
+	bool PhysicalObject::isDisturbed() const
+	{
+		return !(pos == sleepPos) || angle != sleepAngle || !(speed == sleepSpeed) || angSpeed != sleepAngSpeed;
+	}
+	
+	void PhysicalObject::saveState(StateWriter& state) const
 	{
-		// increment interlacedDistance based on pos before and after physics
-		interlacedDistance += (posBeforeCollision - pos).norm();
-		angle = normalizeAngle(angle);
+		state.write(pos);
+		state.write(angle);
+		state.write(speed);
+		state.write(angSpeed);
+		state.write(interlacedDistance);
+		state.write(sleeping);
+		state.write(stillSubsteps);
+		state.write(sleepPos);
+		state.write(sleepAngle);
+		state.write(sleepSpeed);
+		state.write(sleepAngSpeed);
+		state.write(kinematicTime);
+		state.write(randomStream);
 	}
 	
+	void PhysicalObject::loadState(StateReader& state)
+	{
+		// the world-space hull is recomputed on demand, as it depends on the pose
+		state.read(pos);
+		state.read(angle);
+		state.read(speed);
+		state.read(angSpeed);
+		state.read(interlacedDistance);
+		state.read(sleeping);
+		state.read(stillSubsteps);
+		state.read(sleepPos);
+		state.read(sleepAngle);
+		state.read(sleepSpeed);
+		state.read(sleepAngSpeed);
+		state.read(kinematicTime);
+		state.read(randomStream);
+	}
 	
-	void PhysicalObject::collideWithStaticObject(const Vector &n, const Point &cp)
+	PhysicalObject* PhysicalObject::clone() const
+	{
+		// subclasses might have parameters or state this class does not know about
+		if (typeid(*this) != typeid(PhysicalObject))
+			return 0;
+		PhysicalObject* copy(new PhysicalObject);
+		copy->copyStateFrom(*this);
+		return copy;
+	}
+	
+	void PhysicalObject::copyStateFrom(const PhysicalObject& that)
+	{
+		// parameters and state of the physical object, but not the user data which belongs to that
+		PhysicalObject::operator=(that);
+		userData = 0;
+		
+		// state of subclasses and interactions, through a flat image
+		std::vector<char> data;
+		StateWriter writer(data);
+		that.saveState(writer);
+		StateReader reader(data);
+		loadState(reader);
+		assert(reader.atEnd());
+	}
+	
+	void PhysicalObject::collideWithStaticObject(const Vector &n, const Point &cp, const Vector &surfaceSpeed)
 	{
 		// only perform physics if we are in a physically-realistic collision situation,
-		if (n * speed > 0)
+		if (n * (speed - surfaceSpeed) > 0)
 		{
 			//std::cerr << this << " Warning collideWithStaticObject " << std::endl; 
 			return;
@@ -543,7 +867,7 @@ namespace Enki
 		
 		// from http://www.myphysicslab.com/collision.html
 		const Vector r_ap = (cp - pos);
-		const Vector v_ap = speed + r_ap.crossFromZVector(angSpeed);
+		const Vector v_ap = speed + r_ap.crossFromZVector(angSpeed) - surfaceSpeed;
 		const double num = -(1 + collisionElasticity) * (v_ap * n);
 		const double denom = (1 / mass) + (r_ap.cross(n) * r_ap.cross(n)) / momentOfInertia;
 		const double j = num / denom;
@@ -553,6 +877,14 @@ namespace Enki
 		// call the collision callback
 		collisionEvent(0);
 	}
+	
+	Vector PhysicalObject::getSurfaceSpeed(const Point &p) const
+	{
+		// other objects of infinite mass are considered still, as they were before kinematic objects existed
+		if (bodyType != BODY_KINEMATIC)
+			return Vector();
+		return speed + (p - pos).crossFromZVector(angSpeed);
+	}
 
 	void PhysicalObject::collideWithObject(PhysicalObject &that, Point cp, const Vector &dist)
 	{
@@ -569,9 +901,8 @@ namespace Enki
 				// if colliding with wall
 				// de-penetrate
 				that.pos -= dist;
-				that.computeTransformedShape();
 				// perform physics
-				that.collideWithStaticObject(-dist.unitary(), cp);
+				that.collideWithStaticObject(-dist.unitary(), cp, getSurfaceSpeed(cp));
 				return;
 			}
 		}
@@ -582,9 +913,8 @@ namespace Enki
 			{
 				// de-penetrate
 				pos += dist;
-				computeTransformedShape();
 				// perform physics
-				collideWithStaticObject(dist.unitary(), cp);
+				collideWithStaticObject(dist.unitary(), cp, that.getSurfaceSpeed(cp));
 				return;
 			}
 		}
@@ -594,9 +924,7 @@ namespace Enki
 		const Vector thisDisp = dist*that.mass/massSum;
 		const Vector thatDisp = -dist*mass/massSum;
 		pos += thisDisp;
-		computeTransformedShape();
 		that.pos += thatDisp;
-		that.computeTransformedShape();
 		cp += thatDisp; // we have to move cp as much as we move that because cp lie on that's boundary
 		
 		// Perform physics!
@@ -650,6 +978,34 @@ namespace Enki
 		std::sort(localInteractions.begin(), localInteractions.end(), irCompare);
 	}
 
+	double Robot::getLocalInteractionsRange() const
+	{
+		if (localInteractions.empty())
+			return -1;
+		return localInteractions[0]->getRange();
+	}
+
+	size_t Robot::addMount(const Vector& pos, double angle)
+	{
+		Mount mount;
+		mount.pos = pos;
+		mount.angle = angle;
+		mounts.push_back(mount);
+		mountPoses.push_back(mount);
+		return mounts.size() - 1;
+	}
+	
+	void Robot::updateMountPoses()
+	{
+		updateTransformedShape();
+		const Matrix22& rot(getRotation());
+		for (size_t i = 0; i < mounts.size(); ++i)
+		{
+			mountPoses[i].pos = pos + rot * mounts[i].pos;
+			mountPoses[i].angle = angle + mounts[i].angle;
+		}
+	}
+	
 	void Robot::initLocalInteractions(double dt, World* w)
 	{
 		for (size_t i=0; i<localInteractions.size(); i++ )
@@ -665,9 +1021,15 @@ namespace Enki
 		{
 			const Vector vectCenter(this->pos.x - po->pos.x, this->pos.y - po->pos.y );
 			if (vectCenter.norm2() <  (localInteractions[i]->r+po->getRadius())*(localInteractions[i]->r+po->getRadius()))
+			{
+				ENKI_PROFILE(StepProfiler::countObjectStep(localInteractions[i]));
 				localInteractions[i]->objectStep(dt, w, po);
+			}
 			else
+			{
+				ENKI_PROFILE(StepProfiler::countRejectedInteractionPairs(localInteractions.size() - i));
 				return;
+			}
 		}
 	}
 
@@ -676,7 +1038,11 @@ namespace Enki
 	{
 		for (size_t i=0; i<localInteractions.size(); i++)
 		{
-			if ((this->pos.x>localInteractions[i]->r) && (this->pos.y>localInteractions[i]->r) && (w->w-this->pos.x>localInteractions[i]->r) && (w->h-this->pos.y>localInteractions[i]->r))
+			// interactions are sorted by decreasing range, so the next ones do not reach walls either
+			const double r(localInteractions[i]->r);
+			const Vector extent(r, r);
+			const bool reachesWalls(w->wallsType != World::WALLS_NONE && !((this->pos.x>r) && (this->pos.y>r) && (w->w-this->pos.x>r) && (w->h-this->pos.y>r)));
+			if (!reachesWalls && !w->staticGeometry.overlaps(pos - extent, pos + extent))
 				return;
 			else
 				localInteractions[i]->wallsStep(dt, w);
@@ -691,6 +1057,14 @@ namespace Enki
 		}
 	}
 
+	void Robot::initGlobalInteractions(double dt, World* w)
+	{
+		for (size_t i=0; i<globalInteractions.size(); i++)
+		{
+			globalInteractions[i]->init(dt, w);
+		}
+	}
+	
 	void Robot::doGlobalInteractions(double dt, World* w)
 	{
 		for (size_t i=0; i<globalInteractions.size(); i++)
@@ -699,6 +1073,71 @@ namespace Enki
 		}
 	}
 	
+	void Robot::saveState(StateWriter& state) const
+	{
+		PhysicalObject::saveState(state);
+		for (size_t i=0; i<localInteractions.size(); i++)
+			localInteractions[i]->saveState(state);
+		for (size_t i=0; i<globalInteractions.size(); i++)
+			globalInteractions[i]->saveState(state);
+	}
+	
+	void Robot::loadState(StateReader& state)
+	{
+		PhysicalObject::loadState(state);
+		for (size_t i=0; i<localInteractions.size(); i++)
+			localInteractions[i]->loadState(state);
+		for (size_t i=0; i<globalInteractions.size(); i++)
+			globalInteractions[i]->loadState(state);
+	}
+	
+	// ObjectTable
+	
+	std::pair<ObjectTable::iterator, bool> ObjectTable::insert(PhysicalObject *o)
+	{
+		const std::pair<std::unordered_map<unsigned, size_t>::iterator, bool> result(indices.insert(std::make_pair(o->uid, dense.size())));
+		if (!result.second)
+			return std::make_pair(dense.begin() + result.first->second, false);
+		dense.push_back(o);
+		return std::make_pair(dense.end() - 1, true);
+	}
+	
+	size_t ObjectTable::erase(PhysicalObject *o)
+	{
+		const std::unordered_map<unsigned, size_t>::iterator it(indices.find(o->uid));
+		if (it == indices.end() || dense[it->second] != o)
+			return 0;
+		
+		// move the last object in the hole
+		const size_t index(it->second);
+		indices.erase(it);
+		if (index + 1 != dense.size())
+		{
+			dense[index] = dense.back();
+			indices[dense[index]->uid] = index;
+		}
+		dense.pop_back();
+		return 1;
+	}
+	
+	ObjectTable::iterator ObjectTable::find(PhysicalObject *o) const
+	{
+		const std::unordered_map<unsigned, size_t>::const_iterator it(indices.find(o->uid));
+		if (it == indices.end() || dense[it->second] != o)
+			return end();
+		return dense.begin() + it->second;
+	}
+	
+	PhysicalObject* ObjectTable::getByUid(unsigned uid) const
+	{
+		const std::unordered_map<unsigned, size_t>::const_iterator it(indices.find(uid));
+		if (it == indices.end())
+			return 0;
+		return dense[it->second];
+	}
+	
+	// World
+	
 	World::GroundTexture::GroundTexture():
 		width(0),
 		height(0)
@@ -718,7 +1157,19 @@ namespace Enki
 		color(color),
 		groundTexture(groundTexture),
 		takeObjectOwnership(true),
-		bluetoothBase(NULL)
+		sleepSubsteps(0),
+		sleepSpeedThreshold(0),
+		sleepAngSpeedThreshold(0),
+		adaptiveOversampling(false),
+		adaptiveDisplacementRatio(0.25),
+		bluetoothBase(NULL),
+		globalSoundFrequencies(0),
+		trajectoryRecorder(0),
+		interactionNeighbours(1),
+		threadPool(0),
+		randomSeed(0),
+		nextRandomStream(0),
+		currentSubstep(0)
 	{
 	}
 	
@@ -730,7 +1181,19 @@ namespace Enki
 		color(color),
 		groundTexture(groundTexture),
 		takeObjectOwnership(true),
-		bluetoothBase(NULL)
+		sleepSubsteps(0),
+		sleepSpeedThreshold(0),
+		sleepAngSpeedThreshold(0),
+		adaptiveOversampling(false),
+		adaptiveDisplacementRatio(0.25),
+		bluetoothBase(NULL),
+		globalSoundFrequencies(0),
+		trajectoryRecorder(0),
+		interactionNeighbours(1),
+		threadPool(0),
+		randomSeed(0),
+		nextRandomStream(0),
+		currentSubstep(0)
 	{
 	}
 	
@@ -741,7 +1204,19 @@ namespace Enki
 		r(0),
 		color(Color::gray),
 		takeObjectOwnership(true),
-		bluetoothBase(NULL)
+		sleepSubsteps(0),
+		sleepSpeedThreshold(0),
+		sleepAngSpeedThreshold(0),
+		adaptiveOversampling(false),
+		adaptiveDisplacementRatio(0.25),
+		bluetoothBase(NULL),
+		globalSoundFrequencies(0),
+		trajectoryRecorder(0),
+		interactionNeighbours(1),
+		threadPool(0),
+		randomSeed(0),
+		nextRandomStream(0),
+		currentSubstep(0)
 	{
 	}
 
@@ -753,6 +1228,8 @@ namespace Enki
 		
 		if (bluetoothBase)
 			delete bluetoothBase;
+		
+		delete threadPool;
 	}
 	
 	bool World::hasGroundTexture() const
@@ -824,7 +1301,15 @@ namespace Enki
 		}
 		else
 		{
-			// iterate over all shapes
+			// the bounding circle does not reach the walls
+			const double x = object->pos.x;
+			const double y = object->pos.y;
+			const double r = object->r;
+			if (x-r >= 0 && y-r >= 0 && x+r <= w && y+r <= h)
+				return;
+			
+			// iterate over all shapes, all using the pose before de-penetration
+			object->updateTransformedShape();
 			for (PhysicalObject::Hull::const_iterator it = object->hull.begin(); it != object->hull.end(); ++it)
 			{
 				const Polygon& shape = it->getTransformedShape();
@@ -902,14 +1387,18 @@ namespace Enki
 				const Vector dirU = object->pos.unitary();
 				object->collideWithStaticObject(-dirU, dirU * r);
 				object->pos += dirU * distToWall;
-				object->computeTransformedShape();
 			}
 		}
 		else
 		{
-			// iterate over all shapes
+			// the bounding circle does not reach the walls
+			if (object->pos.norm() + object->r <= r)
+				return;
+			
+			// iterate over all shapes, each seeing the de-penetrations due to the previous ones
 			for (PhysicalObject::Hull::const_iterator it = object->hull.begin(); it != object->hull.end(); ++it)
 			{
+				object->updateTransformedShape();
 				const Polygon& shape = it->getTransformedShape();
 				Point cp;
 				double dist = 0;
@@ -930,12 +1419,55 @@ namespace Enki
 					const Vector dirU = cp.unitary();
 					object->collideWithStaticObject(-dirU, dirU * r);
 					object->pos -= dirU * dist;
-					object->computeTransformedShape();
 				}
 			}
 			// TODO: verify this code
 		}
 	}
+	
+	void World::collideWithStaticGeometry(PhysicalObject *object)
+	{
+		const Vector extent(object->r, object->r);
+		staticGeometry.visitOverlapping(object->pos - extent, object->pos + extent, [object](const StaticGeometry::Element& element) {
+			// bring the hull up to date with the de-penetrations due to the previous elements
+			object->updateTransformedShape();
+			
+			// find the part of maximum penetration, the element has infinite mass so the object moves by maxMtv
+			double maxNorm = 0;
+			Vector maxMtv;
+			Point collisionPoint;
+			if (object->hull.empty())
+			{
+				Vector mtv;
+				Point cp;
+				if (element.shape.doesIntersect(object->pos, object->r, element.normals.data(), mtv, cp))
+				{
+					maxNorm = mtv.norm2();
+					maxMtv = -mtv;
+					collisionPoint = cp;
+				}
+			}
+			else
+			{
+				object->visitOverlappingParts(element.bottomLeft, element.topRight, [&](const PhysicalObject::Part& part) {
+					Vector mtv;
+					Point cp;
+					if (part.getTransformedShape().doesIntersect(element.shape, part.getTransformedNormals().data(), element.normals.data(), mtv, cp) && mtv.norm2() > maxNorm)
+					{
+						maxNorm = mtv.norm2();
+						maxMtv = mtv;
+						collisionPoint = cp;
+					}
+				});
+			}
+			
+			if (maxNorm)
+			{
+				object->pos += maxMtv;
+				object->collideWithStaticObject(maxMtv.unitary(), collisionPoint);
+			}
+		});
+	}
 
 	void World::collideObjects(PhysicalObject *object1, PhysicalObject *object2)
 	{
@@ -944,6 +1476,10 @@ namespace Enki
 		const double addedRay = object1->r+object2->r;
 		if (distOCtoOC.norm2() > (addedRay*addedRay))
 			return;
+		
+		// bring world-space hulls up to date with the latest de-penetrations
+		object1->updateTransformedShape();
+		object2->updateTransformedShape();
 
 		// variables for finding parts of maximum penetration
 		PhysicalObject *o1 = NULL, *o2 = NULL;
@@ -956,15 +1492,17 @@ namespace Enki
 		{
 			if (!object2->hull.empty())
 			{
-				// iterate on all shapes of both objects
-				for (PhysicalObject::Hull::const_iterator it = object1->hull.begin(); it != object1->hull.end(); ++it)
-				{
-					const Polygon& shape1 = it->getTransformedShape();
-					for (PhysicalObject::Hull::const_iterator jt = object2->hull.begin(); jt != object2->hull.end(); ++jt)
-					{
-						const Polygon& shape2 = jt->getTransformedShape();
+				// iterate on the pairs of parts whose bounding boxes and circles overlap, using the hierarchies of both objects
+				const Vector extent2(object2->r, object2->r);
+				object1->visitOverlappingParts(object2->pos - extent2, object2->pos + extent2, [&](const PhysicalObject::Part& part1) {
+					const Polygon& shape1 = part1.getTransformedShape();
+					object2->visitOverlappingParts(part1.getTransformedBottomLeft(), part1.getTransformedTopRight(), [&](const PhysicalObject::Part& part2) {
+						const double reach(part1.getBoundingRadius() + part2.getBoundingRadius());
+						if ((part1.getTransformedCentroid() - part2.getTransformedCentroid()).norm2() > reach * reach)
+							return;
+						const Polygon& shape2 = part2.getTransformedShape();
 						Vector mtv, cp;
-						if (shape1.doesIntersect(shape2, mtv, cp))
+						if (shape1.doesIntersect(shape2, part1.getTransformedNormals().data(), part2.getTransformedNormals().data(), mtv, cp))
 						{
 							const double mtvNorm(mtv.norm2());
 							if (mtvNorm > maxNorm)
@@ -976,16 +1514,16 @@ namespace Enki
 								o2 = object2;
 							}
 						}
-					}
-				}
+					});
+				});
 			}
 			else
 			{
-				// collide circle 2 on shape 1
-				for (PhysicalObject::Hull::const_iterator it = object1->hull.begin(); it != object1->hull.end(); ++it)
-				{
+				// collide circle 2 on the parts of shape 1 around it
+				const Vector extent2(object2->r, object2->r);
+				object1->visitOverlappingParts(object2->pos - extent2, object2->pos + extent2, [&](const PhysicalObject::Part& part) {
 					Vector mtv, cp;
-					if (it->getTransformedShape().doesIntersect(object2->pos, object2->r, mtv, cp))
+					if (part.getTransformedShape().doesIntersect(object2->pos, object2->r, part.getTransformedNormals().data(), mtv, cp))
 					{
 						const double mtvNorm(mtv.norm2());
 						if (mtvNorm > maxNorm)
@@ -997,16 +1535,16 @@ namespace Enki
 							o2 = object2;
 						}
 					}
-				}
+				});
 			}
 		}
 		else if (!object2->hull.empty())
 		{
-			// collide circle 1 on shape 2
-			for (PhysicalObject::Hull::const_iterator jt = object2->hull.begin(); jt != object2->hull.end(); ++jt)
-			{
+			// collide circle 1 on the parts of shape 2 around it
+			const Vector extent1(object1->r, object1->r);
+			object2->visitOverlappingParts(object1->pos - extent1, object1->pos + extent1, [&](const PhysicalObject::Part& part) {
 				Vector mtv, cp;
-				if (jt->getTransformedShape().doesIntersect(object1->pos, object1->r, mtv, cp))
+				if (part.getTransformedShape().doesIntersect(object1->pos, object1->r, part.getTransformedNormals().data(), mtv, cp))
 				{
 					const double mtvNorm(mtv.norm2());
 					if (mtvNorm > maxNorm)
@@ -1018,7 +1556,7 @@ namespace Enki
 						o2 = object1;
 					}
 				}
-			}
+			});
 		}
 		else
 		{
@@ -1037,91 +1575,654 @@ namespace Enki
 		{
 			assert(o1);
 			assert(o2);
+			ENKI_PROFILE(StepProfiler::countContact());
 			o1->collideWithObject(*o2, collisionPoint, maxMtv);
 		}
 	}
 
+	double World::getBroadPhaseCellSize() const
+	{
+		double radiusSum(0);
+		for (size_t i = 0; i < stepObjects.size(); ++i)
+			radiusSum += stepObjects[i]->r;
+		if (stepObjects.empty() || radiusSum <= 0)
+			return 1.;
+		return (2. * radiusSum) / double(stepObjects.size());
+	}
+	
+	void World::listBodyTypes()
+	{
+		movingObjects.clear();
+		kinematicObjects.clear();
+		staticObjects.clear();
+		for (size_t i = 0; i < stepObjects.size(); ++i)
+		{
+			switch (stepObjects[i]->bodyType)
+			{
+				case PhysicalObject::BODY_STATIC: staticObjects.push_back(i); break;
+				case PhysicalObject::BODY_KINEMATIC: kinematicObjects.push_back(i); movingObjects.push_back(i); break;
+				default: movingObjects.push_back(i); break;
+			}
+		}
+		
+		// static objects are indexed by their rank, so the index remains valid as long as they keep their place and shape
+		bool changed(staticObjects.size() != staticBroadPhaseRadii.size());
+		for (size_t k = 0; k < staticObjects.size() && !changed; ++k)
+		{
+			const PhysicalObject* o(stepObjects[staticObjects[k]]);
+			changed = !(o->pos == staticBroadPhasePositions[k]) || o->r != staticBroadPhaseRadii[k];
+		}
+		if (!changed)
+			return;
+		
+		double radiusSum(0);
+		staticBroadPhasePositions.resize(staticObjects.size());
+		staticBroadPhaseRadii.resize(staticObjects.size());
+		for (size_t k = 0; k < staticObjects.size(); ++k)
+		{
+			const PhysicalObject* o(stepObjects[staticObjects[k]]);
+			staticBroadPhasePositions[k] = o->pos;
+			staticBroadPhaseRadii[k] = o->r;
+			radiusSum += o->r;
+		}
+		staticBroadPhase.clear(radiusSum > 0 ? (2. * radiusSum) / double(staticObjects.size()) : 1.);
+		for (size_t k = 0; k < staticObjects.size(); ++k)
+			staticBroadPhase.insert(k, staticBroadPhasePositions[k], staticBroadPhaseRadii[k]);
+		staticBroadPhase.build();
+	}
+	
+	void World::moveKinematicObjects(double dt)
+	{
+		for (size_t i = 0; i < kinematicObjects.size(); ++i)
+		{
+			PhysicalObject* o(stepObjects[kinematicObjects[i]]);
+			Point pos(o->pos);
+			Scalar angle(o->angle);
+			o->kinematicTime += dt;
+			o->kinematicTrajectory(o->kinematicTime, pos, angle);
+			o->speed = (pos - o->pos) / dt;
+			o->angSpeed = normalizeAngle(angle - o->angle) / dt;
+			o->pos = pos;
+			o->angle = angle;
+		}
+	}
+	
+	void World::findStaticPairs(SpatialHash::IndexPairs& pairs, const std::vector<double>* margins, bool withSleeping)
+	{
+		if (staticObjects.empty())
+			return;
+		
+		// objects of infinite mass never collide with static ones
+		for (size_t m = 0; m < movingObjects.size(); ++m)
+		{
+			const unsigned i(movingObjects[m]);
+			const PhysicalObject* o(stepObjects[i]);
+			if (o->mass < 0 || (o->sleeping && !withSleeping))
+				continue;
+			staticBroadPhase.getOverlappingElements(o->pos, o->r + (margins ? (*margins)[i] : 0.), staticNeighbours);
+			for (size_t k = 0; k < staticNeighbours.size(); ++k)
+			{
+				const unsigned j(staticObjects[staticNeighbours[k]]);
+				pairs.push_back(SpatialHash::IndexPair(std::min(i, j), std::max(i, j)));
+			}
+		}
+	}
+	
+	void World::findCollisionPairs()
+	{
+		// in adaptive mode, pairs that might collide are known for the whole step, keep those with a moving object
+		if (!substepPeriods.empty())
+		{
+			collisionPairs.clear();
+			for (size_t i = 0; i < sweptPairs.size(); ++i)
+			{
+				const SpatialHash::IndexPair& pair(sweptPairs[i]);
+				const PhysicalObject* first(stepObjects[pair.first]);
+				const PhysicalObject* second(stepObjects[pair.second]);
+				const bool firstMoving(first->bodyType == PhysicalObject::BODY_KINEMATIC || (!first->sleeping && isIntegrated(pair.first)));
+				const bool secondMoving(second->bodyType == PhysicalObject::BODY_KINEMATIC || (!second->sleeping && isIntegrated(pair.second)));
+				if (!firstMoving && !secondMoving)
+					continue;
+				collisionPairs.push_back(pair);
+				collidingObjects[pair.first] = 1;
+				collidingObjects[pair.second] = 1;
+			}
+			
+			// objects not integrated in this substep might be pushed, measure from where
+			for (size_t m = 0; m < movingObjects.size(); ++m)
+			{
+				const unsigned i(movingObjects[m]);
+				if (collidingObjects[i] && (stepObjects[i]->sleeping || !isIntegrated(i)))
+					stepObjects[i]->posBeforeCollision = stepObjects[i]->pos;
+			}
+			return;
+		}
+		
+		// static objects have their own index
+		collisionBroadPhase.clear(getBroadPhaseCellSize());
+		for (size_t m = 0; m < movingObjects.size(); ++m)
+			collisionBroadPhase.insert(movingObjects[m], stepObjects[movingObjects[m]]->pos, stepObjects[movingObjects[m]]->r);
+		collisionBroadPhase.build();
+		collisionBroadPhase.getOverlappingPairs(collisionPairs);
+		
+		// two objects of infinite mass never collide, and two sleeping objects are known not to overlap
+		size_t kept(0);
+		for (size_t i = 0; i < collisionPairs.size(); ++i)
+		{
+			const SpatialHash::IndexPair& pair(collisionPairs[i]);
+			const PhysicalObject* first(stepObjects[pair.first]);
+			const PhysicalObject* second(stepObjects[pair.second]);
+			if (first->mass < 0 && second->mass < 0)
+				continue;
+			if (first->sleeping && second->sleeping)
+				continue;
+			collisionPairs[kept++] = pair;
+		}
+		collisionPairs.resize(kept);
+		findStaticPairs(collisionPairs, 0, false);
+	}
+	
+	void World::buildCollisionBatches()
+	{
+		// objects of infinite mass are shared by the pairs of a batch and collideObjects() would update their hull
+		// lazily from several threads, so bring their hulls up to date beforehand, as kinematic objects moved
+		for (size_t i = 0; i < collisionPairs.size(); ++i)
+		{
+			const SpatialHash::IndexPair& pair(collisionPairs[i]);
+			if (stepObjects[pair.first]->mass < 0)
+				stepObjects[pair.first]->updateTransformedShape();
+			if (stepObjects[pair.second]->mass < 0)
+				stepObjects[pair.second]->updateTransformedShape();
+		}
+		
+		// a pair goes in the first batch after the ones of the previous pairs involving its moving objects,
+		// objects of infinite mass are not modified by collisions so they do not constrain batches
+		collisionObjectBatch.assign(stepObjects.size(), 0);
+		std::vector<unsigned> pairBatches(collisionPairs.size());
+		unsigned batchCount(0);
+		for (size_t i = 0; i < collisionPairs.size(); ++i)
+		{
+			const SpatialHash::IndexPair& pair(collisionPairs[i]);
+			const bool firstMoves(stepObjects[pair.first]->mass >= 0);
+			const bool secondMoves(stepObjects[pair.second]->mass >= 0);
+			unsigned batch(0);
+			if (firstMoves)
+				batch = std::max(batch, collisionObjectBatch[pair.first]);
+			if (secondMoves)
+				batch = std::max(batch, collisionObjectBatch[pair.second]);
+			if (firstMoves)
+				collisionObjectBatch[pair.first] = batch + 1;
+			if (secondMoves)
+				collisionObjectBatch[pair.second] = batch + 1;
+			pairBatches[i] = batch;
+			batchCount = std::max(batchCount, batch + 1);
+		}
+		
+		// counting sort of pairs by batch
+		collisionBatchesBegins.assign(batchCount + 1, 0);
+		for (size_t i = 0; i < pairBatches.size(); ++i)
+			++collisionBatchesBegins[pairBatches[i] + 1];
+		for (size_t b = 0; b < batchCount; ++b)
+			collisionBatchesBegins[b + 1] += collisionBatchesBegins[b];
+		collisionBatches.resize(collisionPairs.size());
+		std::vector<size_t> batchEnds(collisionBatchesBegins.begin(), collisionBatchesBegins.end() - 1);
+		for (size_t i = 0; i < collisionPairs.size(); ++i)
+			collisionBatches[batchEnds[pairBatches[i]]++] = collisionPairs[i];
+	}
+	
+	void World::findSweptPairs(double dt)
+	{
+		// objects can move twice as far as their current speed predicts, plus a fraction of their radius
+		sweptPositions.resize(stepObjects.size());
+		sweptMargins.resize(stepObjects.size());
+		collisionBroadPhase.clear(getBroadPhaseCellSize());
+		for (size_t m = 0; m < movingObjects.size(); ++m)
+		{
+			const unsigned i(movingObjects[m]);
+			const PhysicalObject* o(stepObjects[i]);
+			sweptPositions[i] = o->pos;
+			sweptMargins[i] = 2 * o->speed.norm() * dt + adaptiveDisplacementRatio * o->r;
+			collisionBroadPhase.insert(i, o->pos, o->r + sweptMargins[i]);
+		}
+		collisionBroadPhase.build();
+		collisionBroadPhase.getOverlappingPairs(sweptPairs);
+		
+		// two objects of infinite mass never collide
+		size_t kept(0);
+		for (size_t i = 0; i < sweptPairs.size(); ++i)
+		{
+			const SpatialHash::IndexPair& pair(sweptPairs[i]);
+			if (stepObjects[pair.first]->mass < 0 && stepObjects[pair.second]->mass < 0)
+				continue;
+			sweptPairs[kept++] = pair;
+		}
+		sweptPairs.resize(kept);
+		findStaticPairs(sweptPairs, &sweptMargins, true);
+	}
+	
+	void World::computeSubstepPeriods(double dt, unsigned physicsOversampling)
+	{
+		const size_t count(stepObjects.size());
+		findSweptPairs(dt);
+		collidingObjects.assign(count, 0);
+		
+		// the number of substeps of a pair that might touch during the step depends on how much of the smallest radius their relative motion covers
+		std::vector<unsigned> substepCounts(count, 1);
+		SpatialHash::IndexPairs contactPairs;
+		for (size_t i = 0; i < sweptPairs.size(); ++i)
+		{
+			const SpatialHash::IndexPair& pair(sweptPairs[i]);
+			const PhysicalObject* o1(stepObjects[pair.first]);
+			const PhysicalObject* o2(stepObjects[pair.second]);
+			const double relativeTravel(((o1->speed - o2->speed).norm() + fabs(o1->angSpeed) * o1->r + fabs(o2->angSpeed) * o2->r) * dt);
+			const double gap((o1->pos - o2->pos).norm() - o1->r - o2->r);
+			if (gap > relativeTravel)
+				continue;
+			contactPairs.push_back(pair);
+			const double maxDisplacement(adaptiveDisplacementRatio * std::min(o1->r, o2->r));
+			const double required(maxDisplacement > 0 ? ceil(relativeTravel / maxDisplacement) : physicsOversampling);
+			const unsigned substepCount(required >= physicsOversampling ? physicsOversampling : std::max(unsigned(required), 1u));
+			substepCounts[pair.first] = std::max(substepCounts[pair.first], substepCount);
+			substepCounts[pair.second] = std::max(substepCounts[pair.second], substepCount);
+		}
+		
+		// likewise for an object that might touch static geometry during the step, static geometry having no radius
+		if (!staticGeometry.empty())
+		{
+			for (size_t m = 0; m < movingObjects.size(); ++m)
+			{
+				const unsigned i(movingObjects[m]);
+				const PhysicalObject* o(stepObjects[i]);
+				if (o->mass < 0 || o->sleeping)
+					continue;
+				const double travel((o->speed.norm() + fabs(o->angSpeed) * o->r) * dt);
+				const Vector extent(o->r + travel, o->r + travel);
+				double gap(std::numeric_limits<double>::infinity());
+				staticGeometry.visitOverlapping(o->pos - extent, o->pos + extent, [o, &gap](const StaticGeometry::Element& element) {
+					const double dx(std::max<double>(std::max(element.bottomLeft.x - o->pos.x, o->pos.x - element.topRight.x), 0.));
+					const double dy(std::max<double>(std::max(element.bottomLeft.y - o->pos.y, o->pos.y - element.topRight.y), 0.));
+					gap = std::min(gap, sqrt(dx * dx + dy * dy) - o->r);
+				});
+				if (gap > travel)
+					continue;
+				const double maxDisplacement(adaptiveDisplacementRatio * o->r);
+				const double required(maxDisplacement > 0 ? ceil(travel / maxDisplacement) : physicsOversampling);
+				const unsigned substepCount(required >= physicsOversampling ? physicsOversampling : std::max(unsigned(required), 1u));
+				substepCounts[i] = std::max(substepCounts[i], substepCount);
+			}
+		}
+		
+		// round up to a divisor of physicsOversampling, so that substeps of objects align with the finest ones
+		std::vector<unsigned> periodForCount(physicsOversampling + 1, 1);
+		for (unsigned substepCount = physicsOversampling; substepCount >= 1; --substepCount)
+			periodForCount[substepCount] = (physicsOversampling % substepCount == 0) ? physicsOversampling / substepCount : periodForCount[substepCount + 1];
+		substepPeriods.resize(count);
+		for (size_t i = 0; i < count; ++i)
+			substepPeriods[i] = periodForCount[substepCounts[i]];
+		
+		// kinematic objects move at every substep
+		for (size_t i = 0; i < kinematicObjects.size(); ++i)
+			substepPeriods[kinematicObjects[i]] = 1;
+		
+		// objects that might touch share the finest substeps of their group, groups joining chains of contacts but not through static or kinematic objects;
+		// groups are merged with union-find, each object pointing towards the smallest index of its group
+		std::vector<unsigned> groups(count);
+		for (size_t i = 0; i < count; ++i)
+			groups[i] = i;
+		const auto findGroup = [&groups](unsigned i)
+		{
+			while (groups[i] != i)
+			{
+				groups[i] = groups[groups[i]];
+				i = groups[i];
+			}
+			return i;
+		};
+		for (size_t i = 0; i < contactPairs.size(); ++i)
+		{
+			if (stepObjects[contactPairs[i].first]->bodyType != PhysicalObject::BODY_DYNAMIC || stepObjects[contactPairs[i].second]->bodyType != PhysicalObject::BODY_DYNAMIC)
+				continue;
+			const unsigned group1(findGroup(contactPairs[i].first));
+			const unsigned group2(findGroup(contactPairs[i].second));
+			groups[std::max(group1, group2)] = std::min(group1, group2);
+		}
+		// the period of a group, kept by its first object, is the smallest one of its objects
+		for (size_t i = 0; i < count; ++i)
+		{
+			const unsigned group(findGroup(i));
+			substepPeriods[group] = std::min(substepPeriods[group], substepPeriods[i]);
+		}
+		for (size_t i = 0; i < count; ++i)
+			substepPeriods[i] = substepPeriods[findGroup(i)];
+		
+		// the first substep always runs, to wake up objects moved since last step
+		std::vector<unsigned char> periodUsed(physicsOversampling + 1, 0);
+		for (size_t m = 0; m < movingObjects.size(); ++m)
+			if (!stepObjects[movingObjects[m]]->sleeping)
+				periodUsed[substepPeriods[movingObjects[m]]] = 1;
+		substepUsed.assign(physicsOversampling, 0);
+		substepUsed[0] = 1;
+		for (unsigned period = 1; period <= physicsOversampling; ++period)
+			if (periodUsed[period])
+				for (unsigned substep = 0; substep < physicsOversampling; substep += period)
+					substepUsed[substep] = 1;
+	}
+	
+	bool World::isOutsideSweptMargins() const
+	{
+		for (size_t i = 0; i < awakeObjects.size(); ++i)
+		{
+			const size_t index(awakeObjects[i]);
+			if ((stepObjects[index]->pos - sweptPositions[index]).norm2() > sweptMargins[index] * sweptMargins[index])
+				return true;
+		}
+		for (size_t i = 0; i < kinematicObjects.size(); ++i)
+		{
+			const size_t index(kinematicObjects[i]);
+			if ((stepObjects[index]->pos - sweptPositions[index]).norm2() > sweptMargins[index] * sweptMargins[index])
+				return true;
+		}
+		return false;
+	}
+	
+	void World::listAwakeObjects()
+	{
+		// static and kinematic objects are never integrated
+		awakeObjects.clear();
+		for (size_t m = 0; m < movingObjects.size(); ++m)
+		{
+			const unsigned i(movingObjects[m]);
+			PhysicalObject* o(stepObjects[i]);
+			if (o->bodyType != PhysicalObject::BODY_DYNAMIC)
+				continue;
+			if (!isIntegrated(i) && !collidingObjects[i])
+				continue;
+			if (o->sleeping)
+			{
+				if (!o->isDisturbed())
+					continue;
+				o->wakeUp();
+			}
+			awakeObjects.push_back(i);
+		}
+	}
+	
+	void World::initPhysicsInteractions(double dt)
+	{
+		// sleeping objects are still, unless someone moved them since last physics step
+		if (!substepPeriods.empty())
+			collidingObjects.assign(stepObjects.size(), 0);
+		listAwakeObjects();
+		
+		// in adaptive mode, group objects by number of substeps, as each group has its own time step
+		if (!substepPeriods.empty())
+			std::stable_sort(awakeObjects.begin(), awakeObjects.end(), [this](unsigned a, unsigned b) { return substepPeriods[a] < substepPeriods[b]; });
+		
+		// copy the state of objects, objects with custom forces apply them now
+		bodies.resize(awakeObjects.size());
+		parallelFor(awakeObjects.size(), [this, dt](size_t i, unsigned thread) {
+			PhysicalObject* o(stepObjects[awakeObjects[i]]);
+			const bool defaultForces(typeid(*o) == typeid(PhysicalObject));
+			if (!defaultForces)
+				o->applyForces(substepPeriods.empty() ? dt : dt * substepPeriods[awakeObjects[i]]);
+			bodies.x[i] = o->pos.x;
+			bodies.y[i] = o->pos.y;
+			bodies.angle[i] = o->angle;
+			bodies.speedX[i] = o->speed.x;
+			bodies.speedY[i] = o->speed.y;
+			bodies.angSpeed[i] = o->angSpeed;
+			bodies.dryFrictionCoefficient[i] = o->dryFrictionCoefficient;
+			bodies.viscousFrictionCoefficient[i] = o->viscousFrictionCoefficient;
+			bodies.viscousMomentFrictionCoefficient[i] = o->viscousMomentFrictionCoefficient;
+			bodies.defaultForces[i] = defaultForces ? 1 : 0;
+		});
+		
+		// friction and integration for all objects with the same time step at once
+		for (size_t begin = 0, end = 0; begin < awakeObjects.size(); begin = end)
+		{
+			const unsigned period(substepPeriods.empty() ? 1 : substepPeriods[awakeObjects[begin]]);
+			end = substepPeriods.empty() ? awakeObjects.size() : begin + 1;
+			while (end < awakeObjects.size() && substepPeriods[awakeObjects[end]] == period)
+				++end;
+			const double objectDt(period == 1 ? dt : dt * period);
+			bodies.applyFriction(objectDt, PhysicalObject::g, begin, end);
+			bodies.integrate(objectDt, begin, end);
+		}
+		
+		// copy back the state and store position after integration, world-space hulls are computed on demand
+		parallelFor(awakeObjects.size(), [this](size_t i, unsigned thread) {
+			PhysicalObject* o(stepObjects[awakeObjects[i]]);
+			o->pos = Point(bodies.x[i], bodies.y[i]);
+			o->angle = bodies.angle[i];
+			o->speed = Vector(bodies.speedX[i], bodies.speedY[i]);
+			o->angSpeed = bodies.angSpeed[i];
+			o->posBeforeCollision = o->pos;
+		});
+	}
+	
+	void World::finalizePhysicsInteractions()
+	{
+		// objects pushed by awake ones wake up
+		listAwakeObjects();
+		
+		// collide with walls, and increment interlacedDistance based on pos before and after physics
+		bodies.resize(awakeObjects.size());
+		parallelFor(awakeObjects.size(), [this](size_t i, unsigned thread) {
+			PhysicalObject* o(stepObjects[awakeObjects[i]]);
+			switch (wallsType)
+			{
+				case WALLS_SQUARE: collideWithSquareWalls(o); break;
+				case WALLS_CIRCULAR: collideWithCircularWalls(o); break;
+				default: break;
+			}
+			if (!staticGeometry.empty())
+				collideWithStaticGeometry(o);
+			o->interlacedDistance += (o->posBeforeCollision - o->pos).norm();
+			bodies.angle[i] = o->angle;
+		});
+		
+		// normalize all angles at once
+		bodies.normalizeAngles();
+		
+		// put objects that did not move for long enough to sleep
+		const double speedThreshold2(sleepSpeedThreshold * sleepSpeedThreshold);
+		parallelFor(awakeObjects.size(), [this, speedThreshold2](size_t i, unsigned thread) {
+			PhysicalObject* o(stepObjects[awakeObjects[i]]);
+			o->angle = bodies.angle[i];
+			if (sleepSubsteps == 0)
+				return;
+			const bool still(
+				o->pos == o->posBeforeCollision &&
+				o->speed.norm2() <= speedThreshold2 &&
+				fabs(o->angSpeed) <= sleepAngSpeedThreshold
+			);
+			if (!still)
+				o->stillSubsteps = 0;
+			else if (++o->stillSubsteps >= sleepSubsteps && o->canSleep())
+				o->fallAsleep();
+		});
+	}
+	
+	void World::parallelFor(size_t count, const ThreadPool::Job& job)
+	{
+		if (threadPool)
+			threadPool->parallelFor(count, job);
+		else
+			for (size_t i = 0; i < count; ++i)
+				job(i, 0);
+	}
+	
+	void World::doLocalInteractions(double dt, size_t i, unsigned thread)
+	{
+		PhysicalObject* o(stepObjects[i]);
+		const double range(o->getLocalInteractionsRange());
+		if (range < 0)
+			return;
+		if (std::isinf(range))
+		{
+			for (size_t j = 0; j < stepObjects.size(); ++j)
+				if (j != i)
+					o->doLocalInteractions(dt, this, stepObjects[j]);
+			return;
+		}
+		
+		// objects are returned in the order of stepObjects, so results do not depend on the broadphase
+		std::vector<unsigned>& neighbours(interactionNeighbours[thread]);
+		interactionBroadPhase.getOverlappingElements(o->pos, range, neighbours);
+		for (size_t j = 0; j < neighbours.size(); ++j)
+		{
+			const unsigned neighbour(neighbours[j]);
+			if (neighbour != i)
+				o->doLocalInteractions(dt, this, stepObjects[neighbour]);
+		}
+	}
+
 	void World::step(double dt, unsigned physicsOversampling)
 	{
-		// oversampling physics
+		// use the random generator of this world
+		WorldRandomScope randomScope(worldRandom);
+		ENKI_PROFILE(profiler.beginStep());
+		
+		// index static geometry added since the last step
+		staticGeometry.build();
+		
+		// take a snapshot of the objects for this step, so that controllers can add objects to the world
+		stepObjects.assign(objects.begin(), objects.end());
+		listBodyTypes();
+		
+		// oversampling physics, possibly adapted per object
 		const double overSampledDt = dt / (double)physicsOversampling;
+		const bool adaptive(adaptiveOversampling && physicsOversampling > 1);
+		if (adaptive)
+			computeSubstepPeriods(dt, physicsOversampling);
+		else
+			substepPeriods.clear();
 		for (unsigned po = 0; po < physicsOversampling; po++)
 		{
+			// in adaptive mode, skip substeps in which no object is integrated
+			currentSubstep = po;
+			if (adaptive && !substepUsed[po])
+				continue;
+			
 			// init physics interactions
-			for (ObjectsIterator i = objects.begin(); i != objects.end(); ++i)
-				(*i)->initPhysicsInteractions(overSampledDt);
+			ENKI_PROFILE(profiler.switchPhase(StepProfiler::PHASE_PHYSICS_INIT));
+			moveKinematicObjects(overSampledDt);
+			initPhysicsInteractions(overSampledDt);
 			
-			// collide objects together
-			unsigned iCounter, jCounter;
-			iCounter = 0;
-			for (ObjectsIterator i = objects.begin(); i != objects.end(); ++i)
+			// collide objects together, only testing pairs found by the broadphase
+			ENKI_PROFILE(profiler.switchPhase(StepProfiler::PHASE_OBJECT_COLLISIONS));
+			findCollisionPairs();
+			ENKI_PROFILE(profiler.addBroadPhasePairs(collisionPairs.size()));
+			if (threadPool)
 			{
-				jCounter = 0;
-				for (ObjectsIterator j = objects.begin(); j != objects.end(); ++j)
+				// resolve independent pairs in parallel batch by batch, small batches are not worth waking threads
+				buildCollisionBatches();
+				const size_t minParallelBatchSize(4 * threadPool->getThreadCount());
+				for (size_t b = 0; b + 1 < collisionBatchesBegins.size(); ++b)
 				{
-					if (iCounter < jCounter)
+					const size_t begin(collisionBatchesBegins[b]);
+					const size_t end(collisionBatchesBegins[b + 1]);
+					if (end - begin < minParallelBatchSize)
 					{
-						collideObjects((*i), (*j));
+						for (size_t i = begin; i < end; ++i)
+							collideObjects(stepObjects[collisionBatches[i].first], stepObjects[collisionBatches[i].second]);
+						continue;
 					}
-					jCounter++;
+					threadPool->parallelFor(end - begin, [this, begin](size_t i, unsigned thread) {
+						ENKI_PROFILE(profiler.setThread(thread));
+						const SpatialHash::IndexPair& pair(collisionBatches[begin + i]);
+						collideObjects(stepObjects[pair.first], stepObjects[pair.second]);
+					});
 				}
-				iCounter++;
 			}
-			
-			// collide objects with walls and physics step
-			for (ObjectsIterator i = objects.begin(); i != objects.end(); ++i)
+			else
 			{
-				switch (wallsType)
-				{
-					case WALLS_SQUARE: collideWithSquareWalls(*i); break;
-					case WALLS_CIRCULAR: collideWithCircularWalls(*i); break;
-					default: break;
-				}
-				(*i)->finalizePhysicsInteractions(overSampledDt);
+				for (SpatialHash::IndexPairs::const_iterator it = collisionPairs.begin(); it != collisionPairs.end(); ++it)
+					collideObjects(stepObjects[it->first], stepObjects[it->second]);
 			}
+			
+			// collide objects with walls and physics step
+			ENKI_PROFILE(profiler.switchPhase(StepProfiler::PHASE_WALL_COLLISIONS));
+			finalizePhysicsInteractions();
+			
+			// in adaptive mode, look for pairs that might collide again if objects went further than expected
+			if (adaptive && po + 1 < physicsOversampling && isOutsideSweptMargins())
+				findSweptPairs(dt * double(physicsOversampling - po - 1) / double(physicsOversampling));
 		}
 		
-		// init non-physics interactions
-		for (ObjectsIterator i = objects.begin(); i != objects.end(); ++i)
+		// sensors and external code might look at any hull, so bring them all up to date, along with the poses of sensors
+		ENKI_PROFILE(profiler.switchPhase(StepProfiler::PHASE_LOCAL_INTERACTIONS));
+		parallelFor(stepObjects.size(), [this](size_t i, unsigned thread) {
+			stepObjects[i]->updateTransformedShape();
+			stepObjects[i]->updateMountPoses();
+		});
+		
+		// init non-physics interactions, global ones gather their contribution to the state of the world
+		globalSoundFrequencies = 0;
+		for (size_t i = 0; i < stepObjects.size(); ++i)
 		{
-			(*i)->initLocalInteractions(dt, this);
-			(*i)->initGlobalInteractions(dt, this);
+			stepObjects[i]->initLocalInteractions(dt, this);
+			stepObjects[i]->initGlobalInteractions(dt, this);
 		}
 
-		// interact objects together
-		for (ObjectsIterator i = objects.begin(); i != objects.end(); ++i)
-		{
-			for (ObjectsIterator j = objects.begin(); j != objects.end(); ++j)
-			{
-				if ((*i) != (*j))
-				{
-					(*i)->doLocalInteractions(dt, this, (*j));
-				}
-			}
-		}
+		// index objects by position for local interactions
+		interactionBroadPhase.clear(getBroadPhaseCellSize());
+		for (size_t i = 0; i < stepObjects.size(); ++i)
+			interactionBroadPhase.insert(i, stepObjects[i]->pos, stepObjects[i]->r);
+		interactionBroadPhase.build();
+		
+		// interact objects together and with walls, every object only modifies itself so this can run in parallel
+		parallelFor(stepObjects.size(), [this, dt](size_t i, unsigned thread) {
+			ENKI_PROFILE(profiler.setThread(thread));
+			doLocalInteractions(dt, i, thread);
+			if (wallsType != WALLS_NONE || !staticGeometry.empty())
+				stepObjects[i]->doLocalWallsInteraction(dt, this);
+		});
 
-		// interact objects with walls and control step
-		for (ObjectsIterator i = objects.begin(); i != objects.end(); ++i)
+		// finalize interactions and control step, objects might be added to the world in the process,
+		// or removed and deleted, in which case they must no longer be visited
+		stepUids.resize(stepObjects.size());
+		for (size_t i = 0; i < stepObjects.size(); ++i)
+			stepUids[i] = stepObjects[i]->uid;
+		for (size_t i = 0; i < stepObjects.size(); ++i)
 		{
-			PhysicalObject* o = *i;
-			if (wallsType != WALLS_NONE)
-				o->doLocalWallsInteraction(dt, this);
+			PhysicalObject* o = stepObjects[i];
+			if (objects.getByUid(stepUids[i]) != o)
+				continue;
+			ENKI_PROFILE(profiler.switchPhase(StepProfiler::PHASE_GLOBAL_INTERACTIONS));
 			o->doGlobalInteractions(dt, this);
 			o->finalizeLocalInteractions(dt, this);
 			o->finalizeGlobalInteractions(dt, this);
+			ENKI_PROFILE(profiler.switchPhase(StepProfiler::PHASE_CONTROL_STEP));
 			o->controlStep(dt);
 		}
 		
 		// do a control step for the world
+		ENKI_PROFILE(profiler.switchPhase(StepProfiler::PHASE_CONTROL_STEP));
 		controlStep(dt);
 		// TODO: cleanup this
+		ENKI_PROFILE(profiler.switchPhase(StepProfiler::PHASE_BLUETOOTH));
 		if (bluetoothBase)
 			bluetoothBase->step(dt, this);
+		
+		ENKI_PROFILE(profiler.switchPhase(StepProfiler::PHASE_TRAJECTORY_RECORDING));
+		if (trajectoryRecorder)
+			trajectoryRecorder->record(this, dt);
+		ENKI_PROFILE(profiler.endStep());
 	}
 	
-	void World::addObject(PhysicalObject *o)
+	bool World::addObject(PhysicalObject *o)
 	{
-		objects.insert(o);
+		const std::pair<ObjectTable::iterator, bool> result(objects.insert(o));
+		if (!result.second)
+		{
+			// uids must be unique in a world
+			if (*result.first != o)
+				std::cerr << "Error: World::addObject: another object of uid " << o->uid << " is already in the world, object not added" << std::endl;
+			return false;
+		}
+		o->randomStream.setSeed(randomSeed, nextRandomStream++);
+		return true;
 	}
 
 	void World::removeObject(PhysicalObject *o)
@@ -1129,6 +2230,154 @@ namespace Enki
 		objects.erase(o);
 	}
 	
+	PhysicalObject* World::getObjectByUid(unsigned uid) const
+	{
+		return objects.getByUid(uid);
+	}
+	
+	World::Snapshot World::snapshot() const
+	{
+		Snapshot snapshot;
+		this->snapshot(snapshot);
+		return snapshot;
+	}
+	
+	void World::snapshot(Snapshot& snapshot) const
+	{
+		// clearing keeps the capacity, so that taking snapshots repeatedly does not allocate
+		snapshot.uids.clear();
+		snapshot.data.clear();
+		StateWriter writer(snapshot.data);
+		for (ObjectsIterator i = objects.begin(); i != objects.end(); ++i)
+		{
+			snapshot.uids.push_back((*i)->uid);
+			(*i)->saveState(writer);
+		}
+		snapshot.worldRandom = worldRandom;
+		snapshot.randomSeed = randomSeed;
+		snapshot.nextRandomStream = nextRandomStream;
+	}
+	
+	bool World::restore(const Snapshot& snapshot)
+	{
+		// check that all objects of the snapshot are still there before modifying anything
+		std::vector<PhysicalObject *> snapshotObjects(snapshot.uids.size());
+		for (size_t i = 0; i < snapshot.uids.size(); ++i)
+		{
+			snapshotObjects[i] = objects.getByUid(snapshot.uids[i]);
+			if (!snapshotObjects[i])
+			{
+				std::cerr << "Error: World::restore: object of uid " << snapshot.uids[i] << " is no longer in the world" << std::endl;
+				return false;
+			}
+		}
+		
+		// loading modifies objects, so keep the state of all of them to roll back if the snapshot data does not match them
+		std::vector<char> backup;
+		StateWriter writer(backup);
+		for (ObjectsIterator i = objects.begin(); i != objects.end(); ++i)
+			(*i)->saveState(writer);
+		
+		// Bluetooth modules register again when they are loaded
+		if (bluetoothBase)
+			bluetoothBase->removeAllClients();
+		
+		StateReader reader(snapshot.data);
+		for (size_t i = 0; i < snapshotObjects.size(); ++i)
+			snapshotObjects[i]->loadState(reader);
+		if (reader.hasFailed() || !reader.atEnd())
+		{
+			std::cerr << "Error: World::restore: snapshot data does not match the state of the objects" << std::endl;
+			StateReader backupReader(backup);
+			for (ObjectsIterator i = objects.begin(); i != objects.end(); ++i)
+			{
+				(*i)->loadState(backupReader);
+				(*i)->updateTransformedShape();
+			}
+			assert(backupReader.atEnd());
+			return false;
+		}
+		for (size_t i = 0; i < snapshotObjects.size(); ++i)
+			snapshotObjects[i]->updateTransformedShape();
+		
+		// remove the objects added since, and restore the iteration order
+		if (objects.size() != snapshotObjects.size())
+		{
+			std::vector<unsigned> sortedUids(snapshot.uids);
+			std::sort(sortedUids.begin(), sortedUids.end());
+			std::vector<PhysicalObject *> addedObjects;
+			for (ObjectsIterator i = objects.begin(); i != objects.end(); ++i)
+				if (!std::binary_search(sortedUids.begin(), sortedUids.end(), (*i)->uid))
+					addedObjects.push_back(*i);
+			for (size_t i = 0; i < addedObjects.size(); ++i)
+			{
+				objects.erase(addedObjects[i]);
+				if (takeObjectOwnership)
+					delete addedObjects[i];
+			}
+		}
+		if (!std::equal(snapshotObjects.begin(), snapshotObjects.end(), objects.begin()))
+		{
+			objects.clear();
+			for (size_t i = 0; i < snapshotObjects.size(); ++i)
+				objects.insert(snapshotObjects[i]);
+		}
+		
+		worldRandom = snapshot.worldRandom;
+		randomSeed = snapshot.randomSeed;
+		nextRandomStream = snapshot.nextRandomStream;
+		return true;
+	}
+	
+	World* World::fork(const ObjectFactory& newObject) const
+	{
+		World* world;
+		switch (wallsType)
+		{
+			case WALLS_SQUARE: world = new World(w, h, color, groundTexture); break;
+			case WALLS_CIRCULAR: world = new World(r, color, groundTexture); break;
+			default: world = new World(); break;
+		}
+		world->sleepSubsteps = sleepSubsteps;
+		world->sleepSpeedThreshold = sleepSpeedThreshold;
+		world->sleepAngSpeedThreshold = sleepAngSpeedThreshold;
+		world->adaptiveOversampling = adaptiveOversampling;
+		world->adaptiveDisplacementRatio = adaptiveDisplacementRatio;
+		if (bluetoothBase)
+			world->initBluetoothBase();
+		world->worldRandom = worldRandom;
+		world->randomSeed = randomSeed;
+		world->nextRandomStream = nextRandomStream;
+		world->staticGeometry = staticGeometry;
+		
+		// copies keep the uid and the random stream of their original, so they are not added through addObject()
+		for (ObjectsIterator i = objects.begin(); i != objects.end(); ++i)
+		{
+			PhysicalObject* copy((*i)->clone());
+			if (!copy && newObject)
+			{
+				copy = newObject(**i);
+				if (copy && typeid(*copy) != typeid(**i))
+				{
+					std::cerr << "Error: World::fork: the copy of the object of uid " << (*i)->uid << " is of class " << typeid(*copy).name() << " instead of " << typeid(**i).name() << std::endl;
+					delete copy;
+					delete world;
+					return 0;
+				}
+				if (copy)
+					copy->copyStateFrom(**i);
+			}
+			if (!copy)
+			{
+				std::cerr << "Error: World::fork: object of uid " << (*i)->uid << " of class " << typeid(**i).name() << " cannot be copied" << std::endl;
+				delete world;
+				return 0;
+			}
+			world->objects.insert(copy);
+		}
+		return world;
+	}
+	
 	void World::disconnectExternalObjectsUserData()
 	{
 		for (ObjectsIterator i = objects.begin(); i != objects.end(); ++i)
@@ -1138,7 +2387,34 @@ namespace Enki
 	
 	void World::setRandomSeed(unsigned long seed)
 	{
-		random.setSeed(seed);
+		worldRandom.setSeed(seed);
+		
+		// restart the streams of objects, keeping their indices
+		randomSeed = seed;
+		for (ObjectsIterator i = objects.begin(); i != objects.end(); ++i)
+			(*i)->randomStream.setSeed(randomSeed, (*i)->randomStream.getStream());
+	}
+	
+	void World::setThreadCount(unsigned threadCount)
+	{
+		delete threadPool;
+		threadPool = 0;
+		if (threadCount != 1)
+		{
+			threadPool = new ThreadPool(threadCount);
+			if (threadPool->getThreadCount() == 1)
+			{
+				delete threadPool;
+				threadPool = 0;
+			}
+		}
+		interactionNeighbours.resize(getThreadCount());
+		profiler.setThreadCount(getThreadCount());
+	}
+	
+	unsigned World::getThreadCount() const
+	{
+		return threadPool ? threadPool->getThreadCount() : 1;
 	}
 	
 	void World::initBluetoothBase()
@@ -39,9 +39,19 @@
 #include "Random.h"
 #include "Interaction.h"
 #include "BluetoothBase.h"
+#include "SpatialHash.h"
+#include "ThreadPool.h"
+#include "RigidBodies.h"
+#include "State.h"
+#include "StepProfiler.h"
+#include "StaticGeometry.h"
+#include "BoxHierarchy.h"
 #include <iostream>
 #include <set>
 #include <vector>
+#include <memory>
+#include <functional>
+#include <unordered_map>
 #include <valarray>
 
 
@@ -77,7 +87,9 @@
 	
 	\section designChoices Design choices
 	The basic datatype is double. It is used everywhere excepted if another datatype
-	specifically makes sense.
+	specifically makes sense. Coordinates, colors, shapes and the pose and speeds of objects
+	use Scalar, which is double by default and float in the single-precision build of the
+	library, see ENKI_SINGLE_PRECISION.
 	
 	The core concept in Enki is the interaction. An interaction can be local, i.e. apply only up to a
 	certain range, or global, i.e. apply to the whole world.
@@ -86,9 +98,10 @@
 	and called by the inner simulation loop only when objects are below the interaction range.
 	In objects, local interactions are sorted from long to short range so that once one is out
 	of range, the following will be too. This is the main optimization in Enki that permits large
-	colonies of robots. The complexity is still O(n2) so if very large colonies are required, a larger
-	scale, grid based optimization should be used. It is currently not implemented in Enki.
+	colonies of robots.
 	Physical dynamics between objects are the shortest ranged local interactions.
+	Collisions use a spatial hash (see SpatialHash) as broadphase, so that only objects whose bounding
+	circles are close are tested against each other.
 	Local interactions can also interact with walls. Physical dynamics between objects and walls are
 	similar to local interactions with other objects, but use a different method of calculation.
 	
@@ -125,6 +138,7 @@ Mobots group - Laboratoire de Systèmes Robotiques,
 namespace Enki
 {
 	class World;
+	class TrajectoryRecorder;
 
 	//! A situated object in the world with mass, geometry properties, physical properties, ...
 	/*! \ingroup core */
@@ -168,6 +182,16 @@ namespace Enki
 		//! The viscous friction moment coefficient. Premultiplied by momentOfInertia. A value of k applies a force of -k * speed * momentOfInertia
 		double viscousMomentFrictionCoefficient;
 		
+		//! How the world moves an object
+		enum BodyType
+		{
+			BODY_DYNAMIC = 0,	//!< integrated and collided by the physics, the default
+			BODY_STATIC,		//!< never integrated, of infinite mass, indexed apart from moving objects and never paired with other static objects
+			BODY_KINEMATIC		//!< follows a trajectory given by the user, of infinite mass, pushes dynamic objects
+		};
+		//! Trajectory of a kinematic object, which sets pos and angle to the pose at time, in seconds since the object was made kinematic
+		typedef std::function<void(double time, Point& pos, Scalar& angle)> KinematicTrajectory;
+		
 		// physics state variables
 		
 		// space coordinates
@@ -175,18 +199,68 @@ namespace Enki
 		//! The position of the object.
 		Point pos;
 		//! The orientation of the object in the world, standard trigonometric orientation.
-		double angle;
+		Scalar angle;
 		
 		// space coordinates derivatives
 		
 		//! The speed of the object.
 		Vector speed;
 		//! The rotation speed of the object, standard trigonometric orientation.
-		double angSpeed;
+		Scalar angSpeed;
 		
 		// Geometry
 		
+		//! The geometry of a part in object coordinates, immutable and shared by all parts with identical shape, height and textures
+		class HullPrototype
+		{
+		public:
+			//! Return the prototype of a given shape, height and textures, creating it if no identical prototype is alive; shape must be closed and convex.
+			static std::shared_ptr<const HullPrototype> get(const Polygon& shape, double height, const Textures& textures = Textures());
+			
+			// getters
+			inline double getHeight() const { return height; }
+			inline double getArea() const { return area; }
+			inline double getSecondMoment() const { return secondMoment; }
+			inline const Polygon& getShape() const { return shape; }
+			inline const Point& getCentroid() const { return centroid; }
+			inline Scalar getBoundingRadius() const { return boundingRadius; }
+			inline const std::vector<Vector>& getNormals() const { return normals; }
+			inline const Textures& getTextures() const { return textures; }
+			inline bool isTextured() const { return !textures.empty(); }
+			
+		private:
+			friend struct HullPrototypeRegistry;
+			
+			//! Constructor, computes the area, the centroid, the second moment and the normals of shape
+			HullPrototype(const Polygon& shape, double height, const Textures& textures, size_t hash);
+			//! Return whether this prototype has exactly this shape, height and textures
+			bool isIdentical(const Polygon& shape, double height, const Textures& textures) const;
+			
+			//! The height of the part, used for interaction with the sensors of other robots.
+			const double height;
+			//! The shape of the part in object coordinates.
+			const Polygon shape;
+			//! Texture for several faces of this object.
+			const Textures textures;
+			//! The area of this part, negative if the shape is clockwise
+			double area;
+			//! The polar second moment of area of this part around its centroid, which rigid transformations preserve
+			double secondMoment;
+			//! The centroid (barycenter) of the part in object coordinates.
+			Point centroid;
+			//! The radius of the bounding circle of the shape around its centroid, which rigid transformations preserve
+			Scalar boundingRadius;
+			//! The outward unit normals of the sides of the shape, normals[i] being the one of side (shape[i], shape[i+1])
+			std::vector<Vector> normals;
+			//! The hash of the shape, height and textures, used to find identical prototypes
+			const size_t hash;
+			//! The shared pointer owning this prototype, to share it again when an identical one is requested
+			mutable std::weak_ptr<const HullPrototype> self;
+		};
+		
 		//! A part is one of the convex geometrical element that composes the physical object
+		/*!	The object-space geometry lives in a shared HullPrototype, only the world-space geometry is stored per part.
+		*/
 		class Part
 		{
 		public:
@@ -201,51 +275,49 @@ namespace Enki
 			void applyTransformation(const Matrix22& rot, const Point& trans, double* radius);
 			
 			// getters
-			inline double getHeight() const { return height; }
-			inline double getArea() const { return area; }
-			inline const Polygon& getShape() const { return shape; }
+			inline double getHeight() const { return prototype->getHeight(); }
+			inline double getArea() const { return prototype->getArea(); }
+			inline double getSecondMoment() const { return prototype->getSecondMoment(); }
+			inline const Polygon& getShape() const { return prototype->getShape(); }
 			inline const Polygon& getTransformedShape() const { return transformedShape; }
-			inline const Point& getCentroid() const { return centroid; }
+			inline const SmallVector<Vector, 16>& getTransformedNormals() const { return transformedNormals; }
+			inline const Point& getCentroid() const { return prototype->getCentroid(); }
 			inline const Point& getTransformedCentroid() const { return transformedCentroid; }
-			inline const Textures& getTextures() const { return textures; }
-			inline bool isTextured() const { return !textures.empty(); }
+			inline Scalar getBoundingRadius() const { return prototype->getBoundingRadius(); }
+			inline const Point& getTransformedBottomLeft() const { return transformedBottomLeft; }
+			inline const Point& getTransformedTopRight() const { return transformedTopRight; }
+			inline const Textures& getTextures() const { return prototype->getTextures(); }
+			inline bool isTextured() const { return prototype->isTextured(); }
+			inline const std::shared_ptr<const HullPrototype>& getPrototype() const { return prototype; }
 			
 		private:
 			friend class PhysicalObject;
-			// geometrical properties
 			
-			//! The height of the part, used for interaction with the sensors of other robots.
-			double height;
-			//! The area of this part
-			double area;
-			//! The shape of the part in object coordinates.
-			Polygon shape;
-			//! The shape of the part in world coordinates, updated on initPhysicsInteractions().
+			//! The geometry of the part in object coordinates, shared with identical parts
+			std::shared_ptr<const HullPrototype> prototype;
+			//! The shape of the part in world coordinates, updated on demand by PhysicalObject::updateTransformedShape().
 			Polygon transformedShape;
-			//! The centroid (barycenter) of the part in object coordinates.
-			Point centroid;
-			//! The centroid (barycenter) of the part in world coordinates, updated on initPhysicsInteractions().
+			//! The outward unit normals of the sides of transformedShape, rotated from the ones of the prototype, updated with transformedShape
+			SmallVector<Vector, 16> transformedNormals;
+			//! The centroid (barycenter) of the part in world coordinates, updated on demand by PhysicalObject::updateTransformedShape().
 			Point transformedCentroid;
-			
-			// visual properties
-			
-			//! Texture for several faces of this object.
-			Textures textures;
+			//! The bottom-left corner of the axis-aligned bounding box of transformedShape, updated with it
+			Point transformedBottomLeft;
+			//! The top-right corner of the axis-aligned bounding box of transformedShape, updated with it
+			Point transformedTopRight;
 		
 		private:
-			//! Compute the area and the centroid (barycenter) of this shape in object coordinates.
-			void computeAreaAndCentroid();
 			//! Compute the shape of this part in world coordinates with respect to object
 			void computeTransformedShape(const Matrix22& rot, const Point& trans);
 		};
 		
-		//! A hull is a vector of Hull
-		struct Hull:std::vector<Part>
+		//! A hull is a vector of Part, a single part is stored inline
+		struct Hull:SmallVector<Part, 1>
 		{
 			//! Construct an empty hull
 			Hull() {}
 			//! Construct a hull with a single part
-			Hull(const Part& part) : std::vector<Part>(1, part) {}
+			Hull(const Part& part) : SmallVector<Part, 1>(1, part) {}
 			//! Return the convex hull of this hull, using a simple Jarvis march/gift wrapping algorithm
 			Polygon getConvexHull() const;
 			//! Add this hull to another one
@@ -266,6 +338,32 @@ namespace Enki
 		//! How much this object did penetrate other objects in the course of physics steps since last control step
 		double interlacedDistance;
 		
+		// world-space hull
+		
+		//! Whether the hull in world coordinates is valid for transformedPos and transformedAngle
+		bool transformedShapeValid;
+		//! Position for which the hull in world coordinates was last computed
+		Point transformedPos;
+		//! Orientation for which the hull in world coordinates was last computed
+		Scalar transformedAngle;
+		//! Rotation matrix of transformedAngle, shared by the hull and the interactions of robots
+		Matrix22 transformedRotation;
+		
+		// sleep
+		
+		//! Whether the object is sleeping, that is, excluded from integration until it is moved
+		bool sleeping;
+		//! Number of consecutive physics steps the object has been still
+		unsigned stillSubsteps;
+		//! Position when the object fell asleep, used to detect moves
+		Point sleepPos;
+		//! Orientation when the object fell asleep, used to detect moves
+		Scalar sleepAngle;
+		//! Speed when the object fell asleep, used to detect pushes
+		Vector sleepSpeed;
+		//! Rotation speed when the object fell asleep, used to detect pushes
+		Scalar sleepAngSpeed;
+		
 		// mass and inertia tensor
 		
 		//! The mass of the object. If below zero, the object can't move (infinite mass).
@@ -277,6 +375,9 @@ namespace Enki
 		
 		//! The hull of this object, which can be composed of several Hull
 		Hull hull;
+		
+		//! Hierarchy of the parts of the hull, empty if the hull has no more parts than a leaf; its structure is built with the hull and its boxes are updated with the world-space hull
+		BoxHierarchy partHierarchy;
 		//! The radius of circular objects or, if hull is not empty, the bounding circle
 		double r;
 		//! The height of circular object or, if hull is not empty, the maximum height
@@ -284,6 +385,15 @@ namespace Enki
 		//! The overall color of this object, if hull is empty or if it does not contain any texture
 		Color color;
 		
+		// body type
+		
+		//! How the world moves this object
+		BodyType bodyType;
+		//! If bodyType is BODY_KINEMATIC, the trajectory of this object
+		KinematicTrajectory kinematicTrajectory;
+		//! If bodyType is BODY_KINEMATIC, the time along kinematicTrajectory
+		double kinematicTime;
+		
 	public:			// methods
 		
 		//! Constructor
@@ -297,21 +407,67 @@ namespace Enki
 		inline double getHeight() const { return height; }
 		inline bool isCylindric() const { return hull.empty(); }
 		inline const Hull& getHull() const { return hull; }
+		
+		//! Call visitor(part) on every part whose world-space box passes boxTest(bottomLeft, topRight), as well as the boxes of all nodes of the hierarchy containing it; boxTest must be conservative and the world-space hull up to date
+		template<typename BoxTest, typename Visitor>
+		void visitParts(BoxTest boxTest, Visitor visitor) const
+		{
+			if (partHierarchy.empty())
+			{
+				for (Hull::const_iterator it = hull.begin(); it != hull.end(); ++it)
+					if (boxTest(it->getTransformedBottomLeft(), it->getTransformedTopRight()))
+						visitor(*it);
+				return;
+			}
+			partHierarchy.visit(boxTest, [this, &boxTest, &visitor](unsigned index) {
+				const Part& part(hull[index]);
+				if (boxTest(part.getTransformedBottomLeft(), part.getTransformedTopRight()))
+					visitor(part);
+			});
+		}
+		//! Call visitor(part) on every part whose world-space box overlaps the box from bottomLeft to topRight, the world-space hull must be up to date
+		template<typename Visitor>
+		void visitOverlappingParts(const Point& bottomLeft, const Point& topRight, Visitor visitor) const
+		{
+			visitParts([&bottomLeft, &topRight](const Point& partBottomLeft, const Point& partTopRight) {
+				return partBottomLeft.x <= topRight.x && partTopRight.x >= bottomLeft.x && partBottomLeft.y <= topRight.y && partTopRight.y >= bottomLeft.y;
+			}, visitor);
+		}
+		
+		//! Compute the hull of this object in world coordinates if the pose changed since it was last computed.
+		/*!	The world calls this when it needs world-space vertices, and for all objects at the end of every step,
+			so that the transformed shapes of the hull are valid between steps.
+		*/
+		void updateTransformedShape();
+		//! Return the rotation matrix of the orientation of the object, valid after updateTransformedShape() as long as the pose does not change
+		inline const Matrix22& getRotation() const { return transformedRotation; }
 		inline const Color& getColor() const { return color; }
 		inline double getMass() const { return mass; }
 		inline double getMomentOfInertia() const { return momentOfInertia; }
 		inline double getInterlacedDistance() const { return interlacedDistance; }
+		inline bool isSleeping() const { return sleeping; }
+		inline BodyType getBodyType() const { return bodyType; }
+		inline double getKinematicTime() const { return kinematicTime; }
+		
+		//! Wake the object up if it is sleeping, so that it is integrated again from the next physics step; modifying its pose or speed wakes it up as well
+		void wakeUp();
 		
 		// setters
 		
-		//! Make the object cylindric with a given mass
+		//! Make the object cylindric with a given mass, ignored if the object is static or kinematic
 		void setCylindric(double radius, double height, double mass);
-		//! Make the object rectangular of size l1 x l2 with a given mass
+		//! Make the object rectangular of size l1 x l2 with a given mass, ignored if the object is static or kinematic
 		void setRectangular(double l1, double l2, double height, double mass);
-		//! Set a custom shape and mass to the object
+		//! Set a custom shape and mass to the object, the mass being ignored if the object is static or kinematic
 		void setCustomHull(const Hull& hull, double mass);
 		//! Set the overall color of this object, if hull is empty or if it does not contain any texture
 		void setColor(const Color &color);
+		//! Make the object dynamic with a given mass, which is the default
+		void setDynamic(double mass);
+		//! Make the object static, with infinite mass; the world rebuilds its index of static objects when one is added, removed or moved, so static objects should rarely move
+		void setStatic();
+		//! Make the object kinematic, with infinite mass, and put it at the pose of trajectory at time 0; at every physics substep, the world moves it along trajectory and sets its speeds from its motion; an empty trajectory is rejected
+		void setKinematic(const KinematicTrajectory& trajectory);
 
 		//! A struct with bitfields for buttons
 		enum MouseButtonCode
@@ -325,6 +481,20 @@ namespace Enki
 		//! Called for a robot if a previously mouse button was pressed and is now released
 		virtual void mouseReleaseEvent(unsigned button) {};
 		
+		// state
+		
+		//! Append the dynamic state of this object to state: its pose, speeds, interlaced distance, sleep state and random stream. Subclasses append the state of their actuators and interactions.
+		virtual void saveState(StateWriter& state) const;
+		//! Load the dynamic state saved by saveState() from state, which must come from an object of the same class with the same interactions. Parameters such as the shape or the mass are not part of the state.
+		virtual void loadState(StateReader& state);
+		//! Return a new object with the same uid, parameters and dynamic state as this one but no user data, or 0 if its class does not support copies; by default only objects of class PhysicalObject can be copied.
+		virtual PhysicalObject* clone() const;
+		
+	protected:		// state
+		
+		//! Copy the parameters and the dynamic state of that into this object, freshly constructed with the same class and constructor arguments as that; used to implement clone().
+		void copyStateFrom(const PhysicalObject& that);
+		
 	private:		// setup methods
 		
 		//! When a physical parameter (color, shape, ...) has been changed, the user data must be updated.
@@ -333,8 +503,12 @@ namespace Enki
 		void computeMomentOfInertia();
 		//! Compute the center of mass and move bounding surfaces accordingly. Does not update the moment of inertia tensor.
 		void setupCenterOfMass();
+		//! Build the structure of the hierarchy of the parts, from their centroids in object coordinates
+		void buildPartHierarchy();
 		//! Compute the hull of this object in world coordinates.
 		void computeTransformedShape();
+		//! Mark the hull in world coordinates as outdated, after it was replaced
+		void dirtyTransformedShape();
 	
 	protected:		// physical actions
 		
@@ -343,11 +517,20 @@ namespace Enki
 		//! Control step, not oversampled
 		virtual void controlStep(double dt);
 		//! Apply forces, typically friction to reduce speed, but one can override to change behaviour.
+		//! For objects of class PhysicalObject, the world applies the same friction for all objects at once, without calling this method.
 		virtual void applyForces(double dt);
+		//! Return whether the world may put this object to sleep when it is still, true only for objects of class PhysicalObject.
+		//! Subclasses that override applyForces() can return true if they call wakeUp() whenever their forces might make them move.
+		virtual bool canSleep() const;
 		
-		//! The object collided with o during the current physical step, if o is null, it collided with walls. Called just before the object is de-interlaced
+		//! The object collided with o during the current physical step, if o is null, it collided with walls. Called just before the object is de-interlaced. Not called between two sleeping objects, nor between a sleeping object and walls
 		virtual void collisionEvent(PhysicalObject *o) {}
 		
+		//! Return the range of the longest local interaction, or a negative value if there is none. The world only calls doLocalInteractions() on objects whose bounding circle is within this range.
+		//! Subclasses overriding doLocalInteractions() must override this method as well, returning infinity to see all objects.
+		virtual double getLocalInteractionsRange() const { return -1; }
+		//! Update the world poses of the mounts of interactions, do nothing for PhysicalObject.
+		virtual void updateMountPoses() { }
 		//! Initialize the object specific interactions, do nothing for PhysicalObject.
 		virtual void initLocalInteractions(double dt, World* w) { }
 		//! Do the interactions with the other PhysicalObject, do nothing for PhysicalObject.
@@ -366,13 +549,15 @@ namespace Enki
 
 	private:		// physical actions
 		
-		//! Initialize the collision logic
-		void initPhysicsInteractions(double dt);
-		//! All collisions are finished, deinterlace the object.
-		void finalizePhysicsInteractions(double dt);
+		//! Put the object to sleep, zeroing its speeds
+		void fallAsleep();
+		//! Return whether the pose or speed of the sleeping object changed since it fell asleep
+		bool isDisturbed() const;
 		
-		//! Dynamics for collision with a static object at points cp with normal vector n
-		void collideWithStaticObject(const Vector &n, const Point &cp);
+		//! Dynamics for collision with a static object at points cp with normal vector n, whose surface moves at surfaceSpeed
+		void collideWithStaticObject(const Vector &n, const Point &cp, const Vector &surfaceSpeed = Vector());
+		//! Return the speed of the surface of this object at point p if it is kinematic, as seen by the objects it pushes, or zero
+		Vector getSurfaceSpeed(const Point &p) const;
 		//! Dynamics for collision with that at point cp (on that) with a penetrated distance of dist,
 		void collideWithObject(PhysicalObject &that, Point cp, const Vector &dist);
 
@@ -381,23 +566,51 @@ namespace Enki
 		//! possible to associate client objects with their corresponding ones on
 		//! the server even if they don't have the same pointer address.
 		unsigned int uid;
+		//! Random stream of this object, for its sensor and motor noise; keyed by the seed of its world and the index of this object in that world
+		CounterRandom randomStream;
 	};
 
 	//! A robot is a PhysicalObject that has additional interactions and a controller.
 	/*! \ingroup core */
 	class Robot: public PhysicalObject
 	{
+	public:
+		//! A pose relative to the robot, where an interaction such as a sensor is mounted
+		struct Mount
+		{
+			//! Position in robot coordinates
+			Vector pos;
+			//! Orientation relative to the one of the robot
+			double angle;
+		};
+		
 	protected:
 		//! Vector of local interactions
 		std::vector<LocalInteraction *> localInteractions;
 		//! Vector of global interactions
 		std::vector<GlobalInteraction *> globalInteractions;
+		//! Mounts of the interactions, in robot coordinates
+		std::vector<Mount> mounts;
+		//! Mounts of the interactions in world coordinates, updated by updateMountPoses()
+		std::vector<Mount> mountPoses;
 		
 	public:
+		//! Add a mount at pos with orientation angle in robot coordinates and return its index, typically called by the constructors of interactions
+		size_t addMount(const Vector& pos, double angle = 0);
+		//! Return the position in the world of mount i, updated at the beginning of the interactions of every step
+		inline const Point& getMountPos(size_t i) const { return mountPoses[i].pos; }
+		//! Return the orientation in the world of mount i, updated at the beginning of the interactions of every step
+		inline double getMountAngle(size_t i) const { return mountPoses[i].angle; }
+		//! Update the world poses of all mounts from the pose of the robot, computing its rotation only once
+		virtual void updateMountPoses();
+		
 		//! Add a new local interaction, re-sort interaction vector from long ranged to short ranged.
 		void addLocalInteraction(LocalInteraction *li);
 		//! Add a global interaction, just add it at the end of the vector.
 		void addGlobalInteraction(GlobalInteraction *gi) {globalInteractions.push_back(gi);}
+		//! Return the range of the first local interaction, which is the longest one as they are sorted, or -1 if there is none.
+		//! Subclasses overriding doLocalInteractions() must override this method as well if they might have no local interaction.
+		virtual double getLocalInteractionsRange() const;
 		//! Initialize the local interactions, call init on each one.
 		virtual void initLocalInteractions(double dt, World* w);
 		//! Do the local interactions with other objects, call objectStep on each one.
@@ -407,10 +620,65 @@ namespace Enki
 		//! All the local interactions are finished, call finalize on each one.
 		virtual void finalizeLocalInteractions(double dt, World* w);
 		
+		//! Initialize the global interactions, call init on each one.
+		virtual void initGlobalInteractions(double dt, World* w);
 		//! Do the global interactions, call step on each one.
 		virtual void doGlobalInteractions(double dt, World* w);
 		//! Sort local interactions. Called by addLocalInteraction ; can be called by subclasses in case of interaction radius change.
 		void sortLocalInteractions(void);
+		
+		//! Append the state of the object, then the one of each interaction.
+		virtual void saveState(StateWriter& state) const;
+		//! Load the state of the object, then the one of each interaction.
+		virtual void loadState(StateReader& state);
+	};
+
+	//! A dense table of objects indexed by their uid, used to store the objects of a world.
+	/*! \ingroup core
+		Objects are stored contiguously in a vector, in the order they were inserted, except that
+		erasing an object moves the last one in its place. Iteration order therefore only depends on
+		the sequence of insertions and removals, not on the addresses of objects. Insertion, removal
+		and lookup by uid take constant time. The uid of objects must be unique and must not change
+		while they are in the table.
+	*/
+	class ObjectTable
+	{
+	public:
+		//! Objects are iterated as pointers that cannot be modified through the iterator
+		typedef std::vector<PhysicalObject *>::const_iterator iterator;
+		//! Same as iterator
+		typedef std::vector<PhysicalObject *>::const_iterator const_iterator;
+		
+	protected:
+		//! The objects, contiguous
+		std::vector<PhysicalObject *> dense;
+		//! For each uid, the index of its object in dense
+		std::unordered_map<unsigned, size_t> indices;
+		
+	public:
+		//! Insert o, return its position and true, or the position of the object of the same uid and false if there is one, which might be another object
+		std::pair<iterator, bool> insert(PhysicalObject *o);
+		//! Erase o, return the number of erased objects (0 or 1)
+		size_t erase(PhysicalObject *o);
+		//! Erase all objects
+		void clear() { dense.clear(); indices.clear(); }
+		//! Return the position of o, or end() if it is not present
+		iterator find(PhysicalObject *o) const;
+		//! Return the number of occurrences of o (0 or 1)
+		size_t count(PhysicalObject *o) const { return find(o) != end() ? 1 : 0; }
+		//! Return the object of a given uid, or 0 if there is none
+		PhysicalObject* getByUid(unsigned uid) const;
+		
+		//! Return the position of the first object
+		iterator begin() const { return dense.begin(); }
+		//! Return the position after the last object
+		iterator end() const { return dense.end(); }
+		//! Return the object at index i, in iteration order
+		PhysicalObject* operator[](size_t i) const { return dense[i]; }
+		//! Return the number of objects
+		size_t size() const { return dense.size(); }
+		//! Return whether there is no object
+		bool empty() const { return dense.empty(); }
 	};
 
 	//! The world is the container of all objects and robots.
@@ -461,24 +729,173 @@ namespace Enki
 		//! Current ground texture
 		const GroundTexture groundTexture;
 		
-		typedef std::set<PhysicalObject *> Objects;
+		typedef ObjectTable Objects;
 		typedef Objects::iterator ObjectsIterator;
+		//! A function returning a new object of the same class as its argument, constructed with the same arguments, see fork()
+		typedef std::function<PhysicalObject*(const PhysicalObject& original)> ObjectFactory;
 		
 		//! Whether the world should delete the objects upon destruction, true by default
 		bool takeObjectOwnership;
 		
-		//! All the objects in the world
+		//! Number of consecutive physics steps after which a still object falls asleep, 0 by default, which disables sleeping
+		/*!	Sleeping objects are neither integrated nor collided with walls or with other sleeping objects.
+			They are woken up by contacts with awake objects, by modifications of their pose or speed, or by wakeUp().
+			As a sleeping object pushed against another sleeping one is not separated from it, enabling sleeping may change results.
+		*/
+		unsigned sleepSubsteps;
+		//! Speed below which an object is considered still, 0 by default so that only objects at rest sleep, which does not change results
+		double sleepSpeedThreshold;
+		//! Rotation speed below which an object is considered still, 0 by default
+		double sleepAngSpeedThreshold;
+		
+		//! Whether step() chooses the number of physics substeps of every object, false by default
+		/*!	In this mode, the physicsOversampling argument of step() is the finest subdivision of the step.
+			Every object gets a number of substeps dividing physicsOversampling, depending on its speed with respect to
+			its radius and to the distance to its neighbours: slow or isolated objects are integrated once per step,
+			while fast ones close to others are subdivided. Objects that might touch during the step get the same number
+			of substeps, and collisions are resolved at every substep of either object of a pair.
+		*/
+		bool adaptiveOversampling;
+		//! In adaptive mode, the fraction of the radius of the smallest object of a pair that their relative motion may cover in a substep, 0.25 by default
+		double adaptiveDisplacementRatio;
+		
+		//! All the objects in the world, in a deterministic order; use addObject() and removeObject() to modify
 		Objects objects;
 		//! Base for the Bluetooth connections between robots
 		BluetoothBase* bluetoothBase;
+		//! Mask of the sound frequencies emitted by the robots of this world, cleared at every step before global interactions are initialised, see SbotGlobalSound
+		unsigned globalSoundFrequencies;
+		//! Recorder of the trajectories of objects, called at the end of every step if not 0; not owned by the world, 0 by default
+		TrajectoryRecorder* trajectoryRecorder;
+		//! Static obstacles and maze walls, which objects collide with and sensors see like walls; must not be modified during step()
+		StaticGeometry staticGeometry;
+		
+		//! The dynamic state of a world and of its objects, see snapshot() and restore()
+		class Snapshot
+		{
+		protected:
+			friend class World;
+			
+			//! The uid of the objects, in iteration order
+			std::vector<unsigned> uids;
+			//! The state of the objects, in iteration order, as saved by PhysicalObject::saveState()
+			std::vector<char> data;
+			//! Random generator of the world
+			FastRandom worldRandom;
+			//! Seed of the random streams of the objects of the world
+			unsigned long randomSeed;
+			//! Index of the random stream of the next object added to the world
+			unsigned long nextRandomStream;
+			
+		public:
+			//! Return the number of objects in this snapshot
+			size_t getObjectCount() const { return uids.size(); }
+			//! Return the size of the state of the objects, in bytes
+			size_t getDataSize() const { return data.size(); }
+		};
 
 	protected:
+		//! Objects of the current step, in the iteration order of objects
+		std::vector<PhysicalObject *> stepObjects;
+		//! Uids of stepObjects, to find out without dereferencing them which ones controllers removed during the step
+		std::vector<unsigned> stepUids;
+		//! Indices in stepObjects of the objects that are not static, in increasing order
+		std::vector<unsigned> movingObjects;
+		//! Indices in stepObjects of the kinematic objects
+		std::vector<unsigned> kinematicObjects;
+		//! Indices in stepObjects of the static objects
+		std::vector<unsigned> staticObjects;
+		//! Broadphase for collisions with static objects, indexed by position in staticObjects and only rebuilt when they change
+		SpatialHash staticBroadPhase;
+		//! Position of the static objects when staticBroadPhase was built
+		std::vector<Point> staticBroadPhasePositions;
+		//! Radius of the static objects when staticBroadPhase was built
+		std::vector<double> staticBroadPhaseRadii;
+		//! Indices in staticObjects of the static objects overlapping an object, used when pairing objects with static ones
+		std::vector<unsigned> staticNeighbours;
+		//! Broadphase for collisions between objects, rebuilt every physics step
+		SpatialHash collisionBroadPhase;
+		//! Pairs of indices in stepObjects of objects that might collide, updated every physics step
+		SpatialHash::IndexPairs collisionPairs;
+		//! Collision pairs reordered in batches of pairs not sharing any object of finite mass, used when multithreaded
+		SpatialHash::IndexPairs collisionBatches;
+		//! Index in collisionBatches of the first pair of every batch, plus the total number of pairs
+		std::vector<size_t> collisionBatchesBegins;
+		//! For every object, the first batch in which it is free to collide, used when building batches
+		std::vector<unsigned> collisionObjectBatch;
+		//! Index of the objects for local interactions, rebuilt every step after physics
+		SpatialHash interactionBroadPhase;
+		//! For every thread, indices in stepObjects of the objects within the local interactions range of the current object
+		std::vector<std::vector<unsigned> > interactionNeighbours;
+		//! Threads running the physics and the local interactions, 0 if they run in the calling thread
+		ThreadPool* threadPool;
+		//! Time and counters of the phases of step(), only filled if Enki is built with ENKI_PROFILING
+		StepProfiler profiler;
+		//! Random generator of this world, used as Enki::random while the world is stepping
+		FastRandom worldRandom;
+		//! Seed of the random streams of the objects of this world
+		unsigned long randomSeed;
+		//! Index of the random stream of the next object added to this world
+		unsigned long nextRandomStream;
+		
+		//! Indices in stepObjects of the objects that are awake in the current physics step
+		std::vector<unsigned> awakeObjects;
+		//! Dynamic state of the awake objects of the current physics step, in the order of awakeObjects
+		RigidBodies bodies;
+		
+		//! Index of the current physics substep
+		unsigned currentSubstep;
+		//! In adaptive mode, for every object, the number of finest substeps between two of its integrations; empty otherwise
+		std::vector<unsigned> substepPeriods;
+		//! In adaptive mode, for every finest substep, whether any object is integrated in it
+		std::vector<unsigned char> substepUsed;
+		//! In adaptive mode, for every object, whether it is in collisionPairs of the current substep
+		std::vector<unsigned char> collidingObjects;
+		//! In adaptive mode, pairs of objects whose bounding circles might overlap until the end of the step
+		SpatialHash::IndexPairs sweptPairs;
+		//! In adaptive mode, the position of every object when sweptPairs were found
+		std::vector<Point> sweptPositions;
+		//! In adaptive mode, how far every object can move before sweptPairs must be found again
+		std::vector<double> sweptMargins;
+		
+		//! Return the size of the cells of the broadphases, the average diameter of objects
+		double getBroadPhaseCellSize() const;
+		//! Fill movingObjects, kinematicObjects and staticObjects, and rebuild staticBroadPhase if static objects changed since last step
+		void listBodyTypes();
+		//! Move kinematic objects along their trajectory for dt and set their speeds accordingly
+		void moveKinematicObjects(double dt);
+		//! Append to pairs the pairs of an object of finite mass and a static object whose bounding circles might overlap, the former being enlarged by margins if not 0; skip sleeping objects unless withSleeping
+		void findStaticPairs(SpatialHash::IndexPairs& pairs, const std::vector<double>* margins, bool withSleeping);
+		//! Apply forces and integrate the state of all objects of the current substep, dt being the duration of the finest substep
+		void initPhysicsInteractions(double dt);
+		//! Collide all awake objects with walls, then deinterlace them, normalize their angles and put the still ones to sleep
+		void finalizePhysicsInteractions();
+		//! Wake up sleeping objects that were moved, and fill awakeObjects with the objects integrated or colliding in the current substep
+		void listAwakeObjects();
+		//! Return whether the object at index i in stepObjects is integrated in the current substep, unless it is sleeping
+		bool isIntegrated(size_t i) const { return substepPeriods.empty() || currentSubstep % substepPeriods[i] == 0; }
+		//! Fill collisionPairs with the pairs of objects whose bounding circles might overlap
+		void findCollisionPairs();
+		//! Fill substepPeriods and substepUsed for a step of dt split in at most physicsOversampling substeps
+		void computeSubstepPeriods(double dt, unsigned physicsOversampling);
+		//! Fill sweptPairs with the pairs of objects that might collide within dt
+		void findSweptPairs(double dt);
+		//! Return whether an object of the current substep moved further than its swept margin
+		bool isOutsideSweptMargins() const;
+		//! Split collisionPairs in collisionBatches, such that resolving batches in order, and pairs of a batch in any order, gives the same result as resolving collisionPairs in order
+		void buildCollisionBatches();
+		//! Call job for all indices in [0, count), using the thread pool if any
+		void parallelFor(size_t count, const ThreadPool::Job& job);
+		//! Do the local interactions of object at index i in stepObjects with all objects in its range, using the neighbours buffer of thread
+		void doLocalInteractions(double dt, size_t i, unsigned thread);
 		//! Collide two objects. Correct functions will be called depending on type of object (circular or other shape).
 		void collideObjects(PhysicalObject *object1, PhysicalObject *object2);
 		//! Collide the object with square walls.
 		void collideWithSquareWalls(PhysicalObject *object);
 		//! Collide the object with circular walls.
 		void collideWithCircularWalls(PhysicalObject *object);
+		//! Collide the object with the elements of staticGeometry around it.
+		void collideWithStaticGeometry(PhysicalObject *object);
 
 	public:
 		//! Construct a world with square walls, takes width and height of the world arena in cm.
@@ -496,17 +913,56 @@ namespace Enki
 		Color getGroundColor(const Point& p) const;
 		
 		//! Simulate a timestep of dt. dt should be below 1 (typically .02-.1); physicsOversampling is the amount of time the physics is run per step, as usual collisions require a more precise simulation than the sensor-motor loop frequency.
+		//! Different worlds can be stepped concurrently from different threads, see WorldBatch.
 		virtual void step(double dt, unsigned physicsOversampling = 1);
 		//! Add an object to the world, simply add it to the vector. Object will be automatically deleted when world will be destroyed.
-		//! If the object is already in the world, do nothing
-		void addObject(PhysicalObject *o);
+		//! The random stream of the object is keyed by the seed of the world and the number of objects added before it.
+		//! If the object is already in the world, do nothing and return false.
+		//! If another object of the world has the same uid, for instance o is a copy from fork(), print an error and return false; o is then not owned by the world.
+		bool addObject(PhysicalObject *o);
 		//! Remove an object from the world and destroy it. If object is not in the world, do nothing
 		void removeObject(PhysicalObject *o);
+		//! Return the object of the world with a given uid, or 0 if there is none
+		PhysicalObject* getObjectByUid(unsigned uid) const;
+		
+		//! Return the dynamic state of this world and of its objects; must not be called from step().
+		Snapshot snapshot() const;
+		//! Save the dynamic state of this world and of its objects into snapshot, reusing its memory; must not be called from step().
+		void snapshot(Snapshot& snapshot) const;
+		//! Bring this world and its objects back to the dynamic state of snapshot, taken from this world; must not be called from step().
+		/*!	Objects added since the snapshot was taken are removed from the world, and deleted if takeObjectOwnership is true.
+			The objects of the snapshot must still be in the world and their states must match the data of the snapshot,
+			otherwise the world is left unchanged and false is returned.
+			Bluetooth modules register again at their address in the next step.
+		*/
+		bool restore(const Snapshot& snapshot);
+		//! Return a new world with the same walls, ground, settings, dynamic state and copies of all objects, or 0 if an object cannot be copied.
+		/*!	Objects are copied by PhysicalObject::clone(), which only supports the classes of Enki and not their subclasses,
+			so without newObject, fork() fails on any world containing for instance a robot subclassed to add a controller.
+			For such objects, newObject(original) is called and must return a new object of the same class as original,
+			constructed with the same arguments; fork() then copies the parameters and the state of original into it.
+			The new world owns its objects, runs in the calling thread and is of class World, even if this one is of a subclass.
+			The copies of the objects keep their uid and have no user data.
+		*/
+		World* fork(const ObjectFactory& newObject = ObjectFactory()) const;
 		//! Set to 0 the userData member of all object whose value userData->deletedWithObject are false; call this before the creator of user data is destroyed, this method is typically called from a viewer just before its destruction.
 		void disconnectExternalObjectsUserData();
 		
-		//! Set the seed of the random generator.
+		//! Set the seed of the random generator of this world, which is Enki::random during step(), and restart the random streams of its objects; must not be called from step().
 		void setRandomSeed(unsigned long seed);
+		//! Set the number of threads running the physics and the local interactions of objects, 1 (the default) runs them in the calling thread, 0 uses one thread per hardware thread.
+		/*!	Results are identical to the single-threaded ones. Collisions are resolved in batches of pairs
+			not sharing any moving object, and every object only modifies its own state while doing its
+			local interactions; custom interactions and collisionEvent() must follow this rule as well,
+			and must not use Enki::random, which is only the generator of the world in the calling thread.
+		*/
+		void setThreadCount(unsigned threadCount);
+		//! Return the number of threads running the physics and the local interactions of objects
+		unsigned getThreadCount() const;
+		//! Return the time and counters of the phases of step(), which stay at zero unless Enki is built with the ENKI_PROFILING CMake option
+		StepProfiler& getProfiler() { return profiler; }
+		//! Return the time and counters of the phases of step(), which stay at zero unless Enki is built with the ENKI_PROFILING CMake option
+		const StepProfiler& getProfiler() const { return profiler; }
 		//! Initialise and activate the Bluetooth base
 		void initBluetoothBase();
 		//! Return the address of the Bluetooth base
@@ -517,8 +973,8 @@ namespace Enki
 		virtual void controlStep(double dt) { }
 	};
 	
-	//! Fast random for use by Enki
-	extern FastRandom random;
+	//! Fast random for use by Enki, one per thread; while a world is stepping, this is the generator of that world
+	extern thread_local FastRandom random;
 }
 
 #endif
@@ -34,8 +34,13 @@
 #ifndef __ENKI_RANDOM_H
 #define __ENKI_RANDOM_H
 
+#ifdef WIN32
+#define _USE_MATH_DEFINES
+#include <math.h>
+#endif
 #include <cmath>
 #include <cstdlib>
+#include <stdint.h>
 
 /*!	\file Random.h
 	\brief The mathematic classes for random work
@@ -61,6 +66,83 @@ namespace Enki
 		double getRange(double range) { return (static_cast<double>(get()) * range) / 2147483648.0; }
 	};
 	
+	//! A counter-based random generator, whose n-th number only depends on its key and n
+	/*! \ingroup an
+		Numbers are obtained by hashing a counter with the SplitMix64 finaliser, so that independent
+		streams are simply generators with different keys, for instance derived from a seed and an object index.
+		Gaussian numbers are produced in blocks using the Box-Muller transform without rejection,
+		in loops that the compiler can vectorise.
+	*/
+	class CounterRandom
+	{
+	public:
+		//! Number of Gaussian numbers generated at once
+		static const unsigned gaussianBlockSize = 16;
+		
+	private:
+		uint64_t stream; //!< index of the stream
+		uint64_t key; //!< key of the stream, derived from the seed and the index of the stream
+		uint64_t counter; //!< index of the next number of the stream
+		double gaussians[gaussianBlockSize]; //!< block of Gaussian numbers with zero mean and unit standard deviation
+		unsigned gaussianIndex; //!< index of the next Gaussian number in gaussians, gaussianBlockSize if the block is used up
+		
+	public:
+		//! Construct the random generator for a given seed and stream
+		CounterRandom(uint64_t seed = 0, uint64_t stream = 0) { setSeed(seed, stream); }
+		//! Set the seed and stream, and restart the stream
+		void setSeed(uint64_t seed, uint64_t stream)
+		{
+			this->stream = stream;
+			key = mix(mix(seed) + stream * 0x9e3779b97f4a7c15ULL);
+			counter = 0;
+			gaussianIndex = gaussianBlockSize;
+		}
+		//! Return the index of the stream
+		uint64_t getStream(void) const { return stream; }
+		//! Get a random number between 0 and 2^64
+		uint64_t get(void) { return mix(key + (++counter) * 0x9e3779b97f4a7c15ULL); }
+		//! Get a random double in [0;1[
+		double getUniform(void) { return double(get() >> 11) * (1.0 / 9007199254740992.0); }
+		//! Get a random double between 0 and range
+		double getRange(double range) { return getUniform() * range; }
+		//! Get a random double with a Gaussian distribution of a certain mean and standard deviation
+		double getGaussian(double mean, double sigm)
+		{
+			if (gaussianIndex == gaussianBlockSize)
+				fillGaussians();
+			return mean + sigm * gaussians[gaussianIndex++];
+		}
+		
+	private:
+		//! SplitMix64 finaliser, a bijective hash of 64-bit numbers
+		static uint64_t mix(uint64_t z)
+		{
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+			return z ^ (z >> 31);
+		}
+		//! Fill the block of Gaussian numbers
+		void fillGaussians()
+		{
+			const unsigned pairCount = gaussianBlockSize / 2;
+			double radii[pairCount];
+			double angles[pairCount];
+			for (unsigned i = 0; i < pairCount; ++i)
+			{
+				// 1 - uniform is in ]0;1], so its logarithm is finite
+				radii[i] = 1. - getUniform();
+				angles[i] = getUniform() * (2 * M_PI);
+			}
+			for (unsigned i = 0; i < pairCount; ++i)
+			{
+				const double radius = sqrt(-2. * log(radii[i]));
+				gaussians[2 * i] = radius * cos(angles[i]);
+				gaussians[2 * i + 1] = radius * sin(angles[i]);
+			}
+			gaussianIndex = 0;
+		}
+	};
+	
 	//! Return a number in [0;1[ in a uniform distribution
 	/*! \ingroup an */
 	inline double uniformRand(void)
@@ -0,0 +1,180 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include "RigidBodies.h"
+#include "Geometry.h"
+#include <limits>
+
+/*!	\file RigidBodies.cpp
+	\brief Implementation of the vectorisable physics kernels
+*/
+
+// The loops below avoid branches and function calls so that the compiler can vectorise them,
+// but carry out exactly the same floating-point operations as the scalar code in PhysicalObject.
+
+namespace Enki
+{
+	void RigidBodies::resize(size_t count)
+	{
+		x.resize(count);
+		y.resize(count);
+		angle.resize(count);
+		speedX.resize(count);
+		speedY.resize(count);
+		angSpeed.resize(count);
+		dryFrictionCoefficient.resize(count);
+		viscousFrictionCoefficient.resize(count);
+		viscousMomentFrictionCoefficient.resize(count);
+		defaultForces.resize(count);
+	}
+	
+	void RigidBodies::applyFriction(Scalar dt, Scalar g)
+	{
+		applyFriction(dt, g, 0, size());
+	}
+	
+	void RigidBodies::applyFriction(Scalar dt, Scalar g, size_t begin, size_t end)
+	{
+		const size_t count(end - begin);
+		if (count == 0)
+			return;
+		const Scalar* const mu(&dryFrictionCoefficient[begin]);
+		const unsigned char* const enabled(&defaultForces[begin]);
+		const Scalar epsilon(std::numeric_limits<Scalar>::epsilon());
+		
+		// linear and angular parts are in separate loops, to keep the number of arrays per loop low
+		Scalar* const vx(&speedX[begin]);
+		Scalar* const vy(&speedY[begin]);
+		const Scalar* const viscous(&viscousFrictionCoefficient[begin]);
+		for (size_t i = 0; i < count; ++i)
+		{
+			// all loads are unconditional so that the compiler can turn branches into selections
+			const Scalar speedXi(vx[i]);
+			const Scalar speedYi(vy[i]);
+			const Scalar mui(mu[i]);
+			const Scalar viscousi(viscous[i]);
+			const bool apply(enabled[i] != 0);
+			
+			// dry friction, set speed to zero if bigger
+			const Scalar norm(std::sqrt(speedXi * speedXi + speedYi * speedYi));
+			const bool moving(norm >= epsilon);
+			const Scalar dividedX(speedXi / norm);
+			const Scalar dividedY(speedYi / norm);
+			const Scalar unitX(moving ? dividedX : Scalar(0));
+			const Scalar unitY(moving ? dividedY : Scalar(0));
+			const Scalar dryX((-unitX * g) * mui);
+			const Scalar dryY((-unitY * g) * mui);
+			const bool stopped((dryX * dt) * (dryX * dt) + (dryY * dt) * (dryY * dt) > speedXi * speedXi + speedYi * speedYi);
+			const Scalar speedX0(stopped ? Scalar(0) : speedXi);
+			const Scalar speedY0(stopped ? Scalar(0) : speedYi);
+			const Scalar accX0(stopped ? Scalar(0) : Scalar(0) + dryX);
+			const Scalar accY0(stopped ? Scalar(0) : Scalar(0) + dryY);
+			
+			// viscous friction
+			const Scalar accX(accX0 + (-speedX0) * viscousi);
+			const Scalar accY(accY0 + (-speedY0) * viscousi);
+			
+			// el cheapos integration
+			vx[i] = apply ? speedX0 + accX * dt : speedXi;
+			vy[i] = apply ? speedY0 + accY * dt : speedYi;
+		}
+		
+		Scalar* const w(&angSpeed[begin]);
+		const Scalar* const viscousMoment(&viscousMomentFrictionCoefficient[begin]);
+		for (size_t i = 0; i < count; ++i)
+		{
+			const Scalar angSpeedi(w[i]);
+			const Scalar mui(mu[i]);
+			const Scalar viscousMomenti(viscousMoment[i]);
+			const bool apply(enabled[i] != 0);
+			
+			// dry rotation friction, set angSpeed to zero if bigger
+			const Scalar sign(angSpeedi > 0 ? Scalar(1) : (angSpeedi < 0 ? Scalar(-1) : Scalar(0)));
+			const Scalar dryAng((-sign * g) * mui);
+			const bool stopped(std::fabs(dryAng) * dt > std::fabs(angSpeedi));
+			const Scalar angSpeed0(stopped ? Scalar(0) : angSpeedi);
+			const Scalar angAcc0(stopped ? Scalar(0) : Scalar(0) + dryAng);
+			
+			// viscous friction
+			const Scalar angAcc(angAcc0 + (-angSpeed0) * viscousMomenti);
+			
+			// el cheapos integration
+			w[i] = apply ? angSpeed0 + angAcc * dt : angSpeedi;
+		}
+	}
+	
+	void RigidBodies::integrate(Scalar dt)
+	{
+		integrate(dt, 0, size());
+	}
+	
+	void RigidBodies::integrate(Scalar dt, size_t begin, size_t end)
+	{
+		integrate(x, speedX, dt, begin, end);
+		integrate(y, speedY, dt, begin, end);
+		integrate(angle, angSpeed, dt, begin, end);
+	}
+	
+	void RigidBodies::integrate(std::vector<Scalar>& values, const std::vector<Scalar>& derivatives, Scalar dt, size_t begin, size_t end)
+	{
+		const size_t count(end - begin);
+		if (count == 0)
+			return;
+		Scalar* const v(&values[begin]);
+		const Scalar* const d(&derivatives[begin]);
+		for (size_t i = 0; i < count; ++i)
+			v[i] = v[i] + d[i] * dt;
+	}
+	
+	void RigidBodies::normalizeAngles()
+	{
+		const size_t count(size());
+		if (count == 0)
+			return;
+		Scalar* const a(&angle[0]);
+		const Scalar pi(M_PI);
+		
+		// first do a single correction, which is enough in most cases
+		for (size_t i = 0; i < count; ++i)
+		{
+			const Scalar v(a[i]);
+			a[i] = v > pi ? v - 2*pi : (v < -pi ? v + 2*pi : v);
+		}
+		
+		// then finish the correction of angles that were further away
+		for (size_t i = 0; i < count; ++i)
+			if (a[i] > pi || a[i] < -pi)
+				a[i] = normalizeAngle(a[i]);
+	}
+}
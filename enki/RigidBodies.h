@@ -0,0 +1,102 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#ifndef __ENKI_RIGIDBODIES_H
+#define __ENKI_RIGIDBODIES_H
+
+#include <vector>
+#include <cstddef>
+#include "Geometry.h"
+
+/*!	\file RigidBodies.h
+	\brief The dynamic state of objects as a structure of arrays
+*/
+
+namespace Enki
+{
+	//! The dynamic state of the objects of a world, stored as a structure of arrays
+	/*! \ingroup core
+		The world copies the state of its objects in these arrays for every physics step, so that
+		friction, integration and angle normalisation run as loops over contiguous memory that the
+		compiler can vectorise, instead of one virtual call per object.
+		Results are identical to the ones of the corresponding methods of PhysicalObject.
+	*/
+	class RigidBodies
+	{
+	public:
+		//! x coordinate of position
+		std::vector<Scalar> x;
+		//! y coordinate of position
+		std::vector<Scalar> y;
+		//! orientation
+		std::vector<Scalar> angle;
+		//! x component of speed
+		std::vector<Scalar> speedX;
+		//! y component of speed
+		std::vector<Scalar> speedY;
+		//! rotation speed
+		std::vector<Scalar> angSpeed;
+		//! dry friction coefficient, see PhysicalObject::dryFrictionCoefficient
+		std::vector<Scalar> dryFrictionCoefficient;
+		//! viscous friction coefficient, see PhysicalObject::viscousFrictionCoefficient
+		std::vector<Scalar> viscousFrictionCoefficient;
+		//! viscous friction moment coefficient, see PhysicalObject::viscousMomentFrictionCoefficient
+		std::vector<Scalar> viscousMomentFrictionCoefficient;
+		//! 1 if applyFriction() must apply the default friction forces to this body, 0 if its object applied its own forces
+		std::vector<unsigned char> defaultForces;
+		
+	public:
+		//! Set the number of bodies
+		void resize(size_t count);
+		//! Return the number of bodies
+		size_t size() const { return x.size(); }
+		
+		//! Apply dry and viscous friction to bodies with default forces, as PhysicalObject::applyForces() does
+		void applyFriction(Scalar dt, Scalar g);
+		//! Apply dry and viscous friction to bodies in range [begin, end) with default forces
+		void applyFriction(Scalar dt, Scalar g, size_t begin, size_t end);
+		//! Integrate speeds into positions and orientations
+		void integrate(Scalar dt);
+		//! Integrate speeds into positions and orientations of bodies in range [begin, end)
+		void integrate(Scalar dt, size_t begin, size_t end);
+		//! Normalise orientations between -PI and +PI, as normalizeAngle() does
+		void normalizeAngles();
+		
+	protected:
+		//! Integrate derivatives into values in range [begin, end)
+		static void integrate(std::vector<Scalar>& values, const std::vector<Scalar>& derivatives, Scalar dt, size_t begin, size_t end);
+	};
+}
+
+#endif
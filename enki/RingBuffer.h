@@ -0,0 +1,132 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#ifndef __ENKI_RINGBUFFER_H
+#define __ENKI_RINGBUFFER_H
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+
+/*!	\file RingBuffer.h
+	\brief A lock-free ring buffer of bytes between two threads
+*/
+
+namespace Enki
+{
+	//! A lock-free ring buffer of bytes, with a single producer thread and a single consumer thread
+	/*! \ingroup an
+		The producer and the consumer only share two counters, the number of bytes written and the number
+		of bytes read, each of which is only modified by one side. The producer waits when the buffer is full.
+	*/
+	class RingBuffer
+	{
+	protected:
+		//! The bytes, the capacity being a power of two
+		std::vector<char> data;
+		//! Capacity minus one, to wrap positions
+		const size_t mask;
+		//! Keeps written away from the fields above, which both sides read
+		char paddingBeforeWritten[64];
+		//! Number of bytes written since the creation of the buffer, only modified by the producer
+		std::atomic<size_t> written;
+		//! Keeps written and read in different cache lines without over-aligning the buffer, which new does not honour in C++11
+		char paddingBeforeRead[64];
+		//! Number of bytes read since the creation of the buffer, only modified by the consumer
+		std::atomic<size_t> read;
+		//! Keeps read away from the fields that follow the buffer
+		char paddingAfterRead[64];
+		
+		//! Return the smallest power of two not below size
+		static size_t powerOfTwo(size_t size)
+		{
+			size_t capacity(1);
+			while (capacity < size)
+				capacity *= 2;
+			return capacity;
+		}
+		
+	public:
+		//! Constructor, the capacity is rounded up to a power of two
+		explicit RingBuffer(size_t capacity) : data(powerOfTwo(capacity)), mask(data.size() - 1), written(0), read(0) {}
+		
+		//! Return the capacity, in bytes
+		size_t capacity() const { return data.size(); }
+		//! Return the number of bytes that can be popped; from the consumer thread
+		size_t readable() const { return written.load(std::memory_order_acquire) - read.load(std::memory_order_relaxed); }
+		
+		//! Append size bytes, waiting for the consumer whenever the buffer is full; from the producer thread
+		void push(const void* bytes, size_t size)
+		{
+			const char* source(static_cast<const char*>(bytes));
+			const size_t position(written.load(std::memory_order_relaxed));
+			size_t pushed(0);
+			while (pushed < size)
+			{
+				const size_t free(data.size() - (position + pushed - read.load(std::memory_order_acquire)));
+				if (free == 0)
+				{
+					// publish what we have so the consumer can make room
+					written.store(position + pushed, std::memory_order_release);
+					std::this_thread::yield();
+					continue;
+				}
+				const size_t offset((position + pushed) & mask);
+				const size_t count(std::min(std::min(free, size - pushed), data.size() - offset));
+				std::memcpy(&data[offset], source + pushed, count);
+				pushed += count;
+			}
+			written.store(position + pushed, std::memory_order_release);
+		}
+		
+		//! Return a pointer to the contiguous readable bytes at the front and their number, which might be less than readable(); from the consumer thread
+		const char* front(size_t& size) const
+		{
+			const size_t position(read.load(std::memory_order_relaxed));
+			const size_t offset(position & mask);
+			size = std::min(readable(), data.size() - offset);
+			return &data[offset];
+		}
+		//! Remove size bytes from the front, once they have been used; from the consumer thread
+		void pop(size_t size)
+		{
+			read.store(read.load(std::memory_order_relaxed) + size, std::memory_order_release);
+		}
+	};
+}
+
+#endif
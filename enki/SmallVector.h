@@ -0,0 +1,393 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#ifndef __ENKI_SMALLVECTOR_H
+#define __ENKI_SMALLVECTOR_H
+
+#include <cstddef>
+#include <new>
+#include <memory>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <initializer_list>
+
+/*!	\file SmallVector.h
+	\brief A vector storing its first elements inline
+*/
+
+namespace Enki
+{
+	//! A vector with the interface of std::vector, which stores up to N elements inline
+	/*! \ingroup an
+		Elements only go to the heap when there are more than N of them, so that small
+		polygons, hulls and textures live inside the objects that own them.
+		Like for std::vector, inserting or removing elements invalidates iterators.
+	*/
+	template<typename T, size_t N>
+	class SmallVector
+	{
+	public:
+		typedef T value_type;
+		typedef size_t size_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef T& reference;
+		typedef const T& const_reference;
+		typedef T* pointer;
+		typedef const T* const_pointer;
+		typedef T* iterator;
+		typedef const T* const_iterator;
+		typedef std::reverse_iterator<iterator> reverse_iterator;
+		typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+		
+	public:
+		//! Constructor, empty vector
+		SmallVector() : first(inlineData()), count(0), allocated(N) {}
+		//! Constructor, count default-constructed elements
+		explicit SmallVector(size_t count) : first(inlineData()), count(0), allocated(N) { resize(count); }
+		//! Constructor, count copies of value
+		SmallVector(size_t count, const T& value) : first(inlineData()), count(0), allocated(N) { resize(count, value); }
+		//! Constructor, copy of range [begin, end)
+		template<typename InputIt, typename = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+		SmallVector(InputIt begin, InputIt end) : first(inlineData()), count(0), allocated(N) { insert(this->end(), begin, end); }
+		//! Constructor, copy of list
+		SmallVector(std::initializer_list<T> list) : first(inlineData()), count(0), allocated(N) { insert(end(), list.begin(), list.end()); }
+		//! Copy constructor
+		SmallVector(const SmallVector& that) : first(inlineData()), count(0), allocated(N) { insert(end(), that.begin(), that.end()); }
+		//! Move constructor, steals the heap storage of that if any
+		SmallVector(SmallVector&& that) : first(inlineData()), count(0), allocated(N) { takeFrom(that); }
+		//! Destructor
+		~SmallVector() { clear(); releaseStorage(); }
+		
+		//! Copy assignment
+		SmallVector& operator=(const SmallVector& that)
+		{
+			if (this != &that)
+			{
+				clear();
+				insert(end(), that.begin(), that.end());
+			}
+			return *this;
+		}
+		//! Move assignment, steals the heap storage of that if any
+		SmallVector& operator=(SmallVector&& that)
+		{
+			if (this != &that)
+			{
+				clear();
+				releaseStorage();
+				takeFrom(that);
+			}
+			return *this;
+		}
+		//! Assignment from list
+		SmallVector& operator=(std::initializer_list<T> list)
+		{
+			clear();
+			insert(end(), list.begin(), list.end());
+			return *this;
+		}
+		
+		// iterators
+		iterator begin() { return first; }
+		const_iterator begin() const { return first; }
+		const_iterator cbegin() const { return first; }
+		iterator end() { return first + count; }
+		const_iterator end() const { return first + count; }
+		const_iterator cend() const { return first + count; }
+		reverse_iterator rbegin() { return reverse_iterator(end()); }
+		const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+		reverse_iterator rend() { return reverse_iterator(begin()); }
+		const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+		
+		// capacity
+		size_t size() const { return count; }
+		bool empty() const { return count == 0; }
+		size_t capacity() const { return allocated; }
+		size_t max_size() const { return size_t(-1) / sizeof(T); }
+		//! Return whether elements are stored inline
+		bool isInline() const { return first == inlineData(); }
+		//! Make sure that there is room for capacity elements
+		void reserve(size_t capacity)
+		{
+			if (capacity > allocated)
+				reallocate(capacity);
+		}
+		//! Move elements back inline if they fit, otherwise release unused heap storage
+		void shrink_to_fit()
+		{
+			if (!isInline() && count < allocated)
+				reallocate(count);
+		}
+		
+		// element access
+		T& operator[](size_t i) { return first[i]; }
+		const T& operator[](size_t i) const { return first[i]; }
+		T& at(size_t i) { checkIndex(i); return first[i]; }
+		const T& at(size_t i) const { checkIndex(i); return first[i]; }
+		T& front() { return first[0]; }
+		const T& front() const { return first[0]; }
+		T& back() { return first[count - 1]; }
+		const T& back() const { return first[count - 1]; }
+		T* data() { return first; }
+		const T* data() const { return first; }
+		
+		// modifiers
+		//! Remove all elements, keeping the storage
+		void clear()
+		{
+			destroy(first, first + count);
+			count = 0;
+		}
+		//! Add value at the end
+		void push_back(const T& value) { emplace_back(value); }
+		//! Add value at the end
+		void push_back(T&& value) { emplace_back(std::move(value)); }
+		//! Construct an element at the end
+		template<typename... Args>
+		void emplace_back(Args&&... args)
+		{
+			if (count == allocated)
+			{
+				// construct first, as args might refer to an element of this vector
+				T value(std::forward<Args>(args)...);
+				reallocate(grownCapacity(count + 1));
+				new (first + count) T(std::move(value));
+			}
+			else
+				new (first + count) T(std::forward<Args>(args)...);
+			++count;
+		}
+		//! Remove the last element
+		void pop_back()
+		{
+			--count;
+			first[count].~T();
+		}
+		//! Resize, adding default-constructed elements if needed
+		void resize(size_t newCount)
+		{
+			reserve(newCount);
+			for (; count < newCount; ++count)
+				new (first + count) T();
+			shrinkTo(newCount);
+		}
+		//! Resize, adding copies of value if needed
+		void resize(size_t newCount, const T& value)
+		{
+			if (newCount > allocated)
+			{
+				const T copy(value);
+				reallocate(newCount);
+				for (; count < newCount; ++count)
+					new (first + count) T(copy);
+			}
+			else
+			{
+				for (; count < newCount; ++count)
+					new (first + count) T(value);
+			}
+			shrinkTo(newCount);
+		}
+		//! Replace content with count copies of value
+		void assign(size_t newCount, const T& value)
+		{
+			const T copy(value);
+			clear();
+			resize(newCount, copy);
+		}
+		//! Replace content with range [begin, end)
+		template<typename InputIt, typename = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+		void assign(InputIt begin, InputIt end)
+		{
+			const SmallVector copy(begin, end);
+			*this = std::move(copy);
+		}
+		//! Insert value before pos, return an iterator to it
+		iterator insert(const_iterator pos, const T& value)
+		{
+			return emplace(pos, value);
+		}
+		//! Insert value before pos, return an iterator to it
+		iterator insert(const_iterator pos, T&& value)
+		{
+			return emplace(pos, std::move(value));
+		}
+		//! Insert count copies of value before pos, return an iterator to the first of them
+		iterator insert(const_iterator pos, size_t insertedCount, const T& value)
+		{
+			const SmallVector copies(insertedCount, value);
+			return insert(pos, copies.begin(), copies.end());
+		}
+		//! Insert range [begin, end) before pos, return an iterator to the first inserted element
+		template<typename InputIt, typename = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+		iterator insert(const_iterator pos, InputIt begin, InputIt end)
+		{
+			const size_t index(pos - first);
+			const size_t oldCount(count);
+			// append, then rotate in place
+			for (; begin != end; ++begin)
+				emplace_back(*begin);
+			std::rotate(first + index, first + oldCount, first + count);
+			return first + index;
+		}
+		//! Insert a list before pos, return an iterator to the first inserted element
+		iterator insert(const_iterator pos, std::initializer_list<T> list)
+		{
+			return insert(pos, list.begin(), list.end());
+		}
+		//! Construct an element before pos, return an iterator to it
+		template<typename... Args>
+		iterator emplace(const_iterator pos, Args&&... args)
+		{
+			const size_t index(pos - first);
+			emplace_back(std::forward<Args>(args)...);
+			std::rotate(first + index, first + count - 1, first + count);
+			return first + index;
+		}
+		//! Remove the element at pos, return an iterator to the element that followed it
+		iterator erase(const_iterator pos)
+		{
+			return erase(pos, pos + 1);
+		}
+		//! Remove range [begin, end), return an iterator to the element that followed it
+		iterator erase(const_iterator begin, const_iterator end)
+		{
+			iterator b(first + (begin - first));
+			iterator e(first + (end - first));
+			if (b != e)
+				shrinkTo(std::move(e, this->end(), b) - first);
+			return b;
+		}
+		//! Swap content with that
+		void swap(SmallVector& that)
+		{
+			SmallVector temp(std::move(that));
+			that = std::move(*this);
+			*this = std::move(temp);
+		}
+		
+		// comparisons
+		bool operator==(const SmallVector& that) const { return count == that.count && std::equal(begin(), end(), that.begin()); }
+		bool operator!=(const SmallVector& that) const { return !(*this == that); }
+		bool operator<(const SmallVector& that) const { return std::lexicographical_compare(begin(), end(), that.begin(), that.end()); }
+		
+	private:
+		//! Return the address of inline storage
+		T* inlineData() { return reinterpret_cast<T*>(storage); }
+		//! Return the address of inline storage
+		const T* inlineData() const { return reinterpret_cast<const T*>(storage); }
+		
+		//! Destroy elements in range [begin, end)
+		static void destroy(T* begin, T* end)
+		{
+			for (; begin != end; ++begin)
+				begin->~T();
+		}
+		//! Destroy elements after the first newCount ones
+		void shrinkTo(size_t newCount)
+		{
+			if (newCount < count)
+			{
+				destroy(first + newCount, first + count);
+				count = newCount;
+			}
+		}
+		//! Return the capacity to grow to in order to hold required elements
+		size_t grownCapacity(size_t required) const { return std::max(required, 2 * allocated); }
+		//! Move elements to storage for capacity elements, inline if they fit
+		void reallocate(size_t capacity)
+		{
+			T* newFirst(capacity <= N ? inlineData() : static_cast<T*>(::operator new(capacity * sizeof(T))));
+			if (newFirst == first)
+				return;
+			for (size_t i = 0; i < count; ++i)
+			{
+				new (newFirst + i) T(std::move_if_noexcept(first[i]));
+				first[i].~T();
+			}
+			releaseStorage();
+			first = newFirst;
+			allocated = std::max(capacity, N);
+		}
+		//! Free heap storage if any and point to inline storage, elements must already be destroyed or moved
+		void releaseStorage()
+		{
+			if (!isInline())
+				::operator delete(first);
+			first = inlineData();
+			allocated = N;
+		}
+		//! Take the content of that, which must be empty with inline storage, leaving that empty
+		void takeFrom(SmallVector& that)
+		{
+			if (that.isInline())
+			{
+				for (size_t i = 0; i < that.count; ++i)
+					new (first + i) T(std::move(that.first[i]));
+				count = that.count;
+				that.clear();
+			}
+			else
+			{
+				first = that.first;
+				count = that.count;
+				allocated = that.allocated;
+				that.first = that.inlineData();
+				that.count = 0;
+				that.allocated = N;
+			}
+		}
+		//! Throw std::out_of_range if i is not a valid index
+		void checkIndex(size_t i) const
+		{
+			if (i >= count)
+				throw std::out_of_range("SmallVector::at");
+		}
+		
+	private:
+		//! First element, either in storage or on the heap
+		T* first;
+		//! Number of elements
+		size_t count;
+		//! Number of elements that fit in the current storage
+		size_t allocated;
+		//! Inline storage for N elements
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type storage[N];
+	};
+}
+
+#endif
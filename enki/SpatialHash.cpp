@@ -0,0 +1,224 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include "SpatialHash.h"
+#include <algorithm>
+#include <cassert>
+
+/*!	\file SpatialHash.cpp
+	\brief Implementation of the broadphase used to find potentially interacting objects
+*/
+
+namespace Enki
+{
+	SpatialHash::SpatialHash() :
+		cellSize(1),
+		invCellSize(1)
+	{
+	}
+	
+	void SpatialHash::clear(double cellSize)
+	{
+		assert(cellSize > 0);
+		this->cellSize = cellSize;
+		this->invCellSize = 1. / cellSize;
+		elements.clear();
+		used.clear();
+		entries.clear();
+		largeElements.clear();
+	}
+	
+	int32_t SpatialHash::cellCoord(double v) const
+	{
+		// clamp to keep far-away objects in a valid range, they will only share cells
+		const double limit(1 << 30);
+		const double c(floor(v * invCellSize));
+		if (c < -limit)
+			return -(1 << 30);
+		if (c > limit)
+			return (1 << 30);
+		return int32_t(c);
+	}
+	
+	void SpatialHash::insert(unsigned index, const Point& center, double radius)
+	{
+		if (index >= elements.size())
+		{
+			elements.resize(index + 1);
+			used.resize(index + 1, false);
+		}
+		assert(!used[index]);
+		used[index] = true;
+		
+		Element& e(elements[index]);
+		e.center = center;
+		e.radius = radius;
+		e.x0 = cellCoord(center.x - radius);
+		e.y0 = cellCoord(center.y - radius);
+		e.x1 = cellCoord(center.x + radius);
+		e.y1 = cellCoord(center.y + radius);
+		
+		const int64_t cellCount((int64_t(e.x1) - e.x0 + 1) * (int64_t(e.y1) - e.y0 + 1));
+		if (cellCount > maxCellsPerElement)
+		{
+			largeElements.push_back(index);
+			return;
+		}
+		
+		CellEntry entry;
+		entry.index = index;
+		for (int32_t x = e.x0; x <= e.x1; ++x)
+			for (int32_t y = e.y0; y <= e.y1; ++y)
+			{
+				entry.key = cellKey(x, y);
+				entries.push_back(entry);
+			}
+	}
+	
+	void SpatialHash::build()
+	{
+		std::sort(entries.begin(), entries.end());
+		std::sort(largeElements.begin(), largeElements.end());
+	}
+	
+	bool SpatialHash::boxesOverlap(const Element& a, const Element& b) const
+	{
+		const double radiusSum(a.radius + b.radius);
+		return (fabs(a.center.x - b.center.x) <= radiusSum) && (fabs(a.center.y - b.center.y) <= radiusSum);
+	}
+	
+	void SpatialHash::getOverlappingPairs(IndexPairs& pairs) const
+	{
+		pairs.clear();
+		
+		// pairs sharing a cell
+		size_t runBegin(0);
+		while (runBegin < entries.size())
+		{
+			const uint64_t key(entries[runBegin].key);
+			size_t runEnd(runBegin + 1);
+			while (runEnd < entries.size() && entries[runEnd].key == key)
+				++runEnd;
+			
+			const int32_t cellX(int32_t(uint32_t(key >> 32)));
+			const int32_t cellY(int32_t(uint32_t(key & 0xffffffff)));
+			for (size_t i = runBegin; i < runEnd; ++i)
+			{
+				const unsigned iIndex(entries[i].index);
+				const Element& ei(elements[iIndex]);
+				for (size_t j = i + 1; j < runEnd; ++j)
+				{
+					const unsigned jIndex(entries[j].index);
+					const Element& ej(elements[jIndex]);
+					// only report a pair in the first cell both elements share, to avoid duplicates
+					if (std::max(ei.x0, ej.x0) != cellX || std::max(ei.y0, ej.y0) != cellY)
+						continue;
+					if (boxesOverlap(ei, ej))
+						pairs.push_back(IndexPair(iIndex, jIndex));
+				}
+			}
+			runBegin = runEnd;
+		}
+		
+		// pairs involving large elements
+		for (size_t i = 0; i < largeElements.size(); ++i)
+		{
+			const unsigned largeIndex(largeElements[i]);
+			const Element& el(elements[largeIndex]);
+			for (unsigned j = 0; j < elements.size(); ++j)
+			{
+				if (!used[j] || j == largeIndex)
+					continue;
+				// pairs between two large elements are reported once
+				if (j < largeIndex && std::binary_search(largeElements.begin(), largeElements.end(), j))
+					continue;
+				if (boxesOverlap(el, elements[j]))
+					pairs.push_back(j < largeIndex ? IndexPair(j, largeIndex) : IndexPair(largeIndex, j));
+			}
+		}
+		
+		// sort so that pairs are processed in a deterministic order
+		std::sort(pairs.begin(), pairs.end());
+	}
+	
+	void SpatialHash::getOverlappingElements(const Point& center, double radius, std::vector<unsigned>& indices) const
+	{
+		indices.clear();
+		
+		Element query;
+		query.center = center;
+		query.radius = radius;
+		const int32_t x0(cellCoord(center.x - radius));
+		const int32_t y0(cellCoord(center.y - radius));
+		const int32_t x1(cellCoord(center.x + radius));
+		const int32_t y1(cellCoord(center.y + radius));
+		const int64_t cellCount((int64_t(x1) - x0 + 1) * (int64_t(y1) - y0 + 1));
+		
+		if (cellCount > int64_t(entries.size()))
+		{
+			// scanning all cells would be more expensive than testing all elements
+			for (unsigned i = 0; i < elements.size(); ++i)
+				if (used[i] && boxesOverlap(query, elements[i]))
+					indices.push_back(i);
+			return;
+		}
+		
+		// scan the cells covered by the query
+		CellEntry firstEntry;
+		firstEntry.index = 0;
+		for (int32_t x = x0; x <= x1; ++x)
+		{
+			for (int32_t y = y0; y <= y1; ++y)
+			{
+				firstEntry.key = cellKey(x, y);
+				for (std::vector<CellEntry>::const_iterator it = std::lower_bound(entries.begin(), entries.end(), firstEntry); it != entries.end() && it->key == firstEntry.key; ++it)
+				{
+					const Element& e(elements[it->index]);
+					// only report an element in the first cell it shares with the query, to avoid duplicates
+					if (std::max(x0, e.x0) != x || std::max(y0, e.y0) != y)
+						continue;
+					if (boxesOverlap(query, e))
+						indices.push_back(it->index);
+				}
+			}
+		}
+		
+		// large elements
+		for (size_t i = 0; i < largeElements.size(); ++i)
+			if (boxesOverlap(query, elements[largeElements[i]]))
+				indices.push_back(largeElements[i]);
+		
+		std::sort(indices.begin(), indices.end());
+	}
+}
@@ -0,0 +1,132 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#ifndef __ENKI_SPATIALHASH_H
+#define __ENKI_SPATIALHASH_H
+
+#include "Geometry.h"
+#include <vector>
+#include <utility>
+#include <stdint.h> // C99 in waiting for widespread C++11 support
+
+/*!	\file SpatialHash.h
+	\brief The broadphase used to find potentially interacting objects
+*/
+
+namespace Enki
+{
+	//! A spatial hash of bounding circles, used as broadphase to find candidate pairs of objects
+	/*! \ingroup core
+		Circles are inserted in all the cells of a uniform grid that their bounding box overlaps.
+		Cells are addressed by their integer coordinates, so the grid is unbounded and works for
+		all world types. The structure is rebuilt from scratch with clear(), insert() and build().
+		Circles covering too many cells are kept aside and paired with every other circle.
+	*/
+	class SpatialHash
+	{
+	public:
+		//! A pair of indices, first is always smaller than second
+		typedef std::pair<unsigned, unsigned> IndexPair;
+		//! A vector of pairs of indices
+		typedef std::vector<IndexPair> IndexPairs;
+		
+	protected:
+		//! Bounding circle of an inserted element
+		struct Element
+		{
+			//! center of the circle
+			Point center;
+			//! radius of the circle
+			double radius;
+			//! first and last cells covered by this element, inclusive
+			int32_t x0, y0, x1, y1;
+		};
+		//! An entry of an element in a cell
+		struct CellEntry
+		{
+			//! packed coordinates of the cell
+			uint64_t key;
+			//! index of the element
+			unsigned index;
+			
+			//! Order by cell, then by index
+			bool operator <(const CellEntry& that) const { return key < that.key || (key == that.key && index < that.index); }
+		};
+		
+		//! Size of the side of a cell
+		double cellSize;
+		//! Inverse of cellSize
+		double invCellSize;
+		//! All inserted elements, indexed by the index given on insert()
+		std::vector<Element> elements;
+		//! Whether an element was inserted at a given index
+		std::vector<bool> used;
+		//! Entries of elements in cells, sorted by cell on build()
+		std::vector<CellEntry> entries;
+		//! Elements covering more than maxCellsPerElement cells
+		std::vector<unsigned> largeElements;
+		
+	public:
+		//! Maximum number of cells an element can span before it is considered large
+		static const unsigned maxCellsPerElement = 64;
+		
+		//! Constructor, cells have a size of 1
+		SpatialHash();
+		
+		//! Remove all elements and set the size of the cells; size must be strictly positive
+		void clear(double cellSize);
+		//! Insert a circle of a given center and radius under index, each index must be inserted at most once between clear() and build()
+		void insert(unsigned index, const Point& center, double radius);
+		//! Sort the cells, must be called after the last insert() and before any query
+		void build();
+		
+		//! Fill pairs with all pairs of elements whose bounding boxes overlap, sorted by first then second index
+		void getOverlappingPairs(IndexPairs& pairs) const;
+		//! Fill indices with all elements whose bounding box overlaps the one of circle (center, radius), sorted by index
+		void getOverlappingElements(const Point& center, double radius, std::vector<unsigned>& indices) const;
+		
+		//! Return the size of the side of a cell
+		double getCellSize() const { return cellSize; }
+		
+	protected:
+		//! Return the integer coordinate of the cell containing v
+		int32_t cellCoord(double v) const;
+		//! Return the key of the cell at (x, y)
+		static uint64_t cellKey(int32_t x, int32_t y) { return (uint64_t(uint32_t(x)) << 32) | uint64_t(uint32_t(y)); }
+		//! Return whether the bounding boxes of elements a and b overlap
+		bool boxesOverlap(const Element& a, const Element& b) const;
+	};
+}
+
+#endif
@@ -0,0 +1,176 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#ifndef __ENKI_STATE_H
+#define __ENKI_STATE_H
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <valarray>
+#include <type_traits>
+
+/*!	\file State.h
+	\brief Flat binary images of the dynamic state of objects and interactions
+*/
+
+namespace Enki
+{
+	//! Appends the dynamic state of objects and interactions to a flat buffer of bytes
+	/*! \ingroup an
+		Only trivially copyable values are written, by copying their memory, so that saving
+		and loading a state is a sequence of memory copies. The buffer is not portable
+		between builds, it is meant to be read back by StateReader in the same process.
+	*/
+	class StateWriter
+	{
+	protected:
+		//! The buffer values are appended to
+		std::vector<char>& data;
+		
+	public:
+		//! Construct a writer appending to data
+		StateWriter(std::vector<char>& data) : data(data) {}
+		
+		//! Append count values
+		template<typename T>
+		void write(const T* values, size_t count)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable values can be written");
+			const size_t size(count * sizeof(T));
+			if (size == 0)
+				return;
+			const size_t offset(data.size());
+			data.resize(offset + size);
+			std::memcpy(&data[offset], values, size);
+		}
+		//! Append a value
+		template<typename T>
+		void write(const T& value) { write(&value, 1); }
+		//! Append the size and the values of a vector
+		template<typename T>
+		void write(const std::vector<T>& values)
+		{
+			write(values.size());
+			write(values.data(), values.size());
+		}
+		//! Append the size and the values of a valarray
+		template<typename T>
+		void write(const std::valarray<T>& values)
+		{
+			write(values.size());
+			if (values.size())
+				write(&values[0], values.size());
+		}
+	};
+	
+	//! Reads back, in the same order, the values written by a StateWriter
+	/*! \ingroup an
+		Reading past the end of the buffer does not read anything: it sets the values to zero and
+		marks the reader as failed, so that the caller can reject the state once loading is done.
+	*/
+	class StateReader
+	{
+	protected:
+		//! The buffer values are read from
+		const std::vector<char>& data;
+		//! The position of the next value in data
+		size_t offset;
+		//! Whether a read went past the end of data
+		bool failed;
+		
+	public:
+		//! Construct a reader at the beginning of data
+		StateReader(const std::vector<char>& data) : data(data), offset(0), failed(false) {}
+		
+		//! Read count values, or set them to zero and fail if data does not hold them
+		template<typename T>
+		void read(T* values, size_t count)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable values can be read");
+			if (count == 0)
+				return;
+			if (failed || count > (data.size() - offset) / sizeof(T))
+			{
+				failed = true;
+				std::memset(static_cast<void*>(values), 0, count * sizeof(T));
+				return;
+			}
+			const size_t size(count * sizeof(T));
+			std::memcpy(values, &data[offset], size);
+			offset += size;
+		}
+		//! Read a value
+		template<typename T>
+		void read(T& value) { read(&value, 1); }
+		//! Read the size and the values of a vector, resizing it; empty it and fail if data does not hold them
+		template<typename T>
+		void read(std::vector<T>& values)
+		{
+			const size_t size(readSize(sizeof(T)));
+			values.resize(size);
+			read(values.data(), size);
+		}
+		//! Read the size and the values of a valarray, resizing it; empty it and fail if data does not hold them
+		template<typename T>
+		void read(std::valarray<T>& values)
+		{
+			const size_t size(readSize(sizeof(T)));
+			if (values.size() != size)
+				values.resize(size);
+			if (size)
+				read(&values[0], size);
+		}
+		//! Return whether all values have been read
+		bool atEnd() const { return offset == data.size(); }
+		//! Return whether a read went past the end of data
+		bool hasFailed() const { return failed; }
+		
+	protected:
+		//! Read the size of a container of values of elementSize bytes, or return 0 and fail if data does not hold that many values
+		size_t readSize(size_t elementSize)
+		{
+			size_t size;
+			read(size);
+			if (size > (data.size() - offset) / elementSize)
+			{
+				failed = true;
+				return 0;
+			}
+			return size;
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,132 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include "StaticGeometry.h"
+#include <algorithm>
+#include <iostream>
+
+/*!	\file StaticGeometry.cpp
+	\brief Implementation of the static geometry of worlds
+*/
+
+namespace Enki
+{
+	StaticGeometry::StaticGeometry():
+		dirty(false)
+	{
+	}
+	
+	bool StaticGeometry::addPolygon(const Polygon& polygon, double height, const Color& color)
+	{
+		const size_t n(polygon.size());
+		if (n < 3)
+		{
+			std::cerr << "Error: StaticGeometry::addPolygon: polygon has " << n << " vertices, at least 3 are required" << std::endl;
+			return false;
+		}
+		
+		// all turns must be in the same direction
+		double area(0);
+		bool left(false), right(false);
+		for (size_t i = 0; i < n; ++i)
+		{
+			const Vector e0(polygon[(i + 1) % n] - polygon[i]);
+			const Vector e1(polygon[(i + 2) % n] - polygon[(i + 1) % n]);
+			const double turn(e0.cross(e1));
+			left = left || turn > 0;
+			right = right || turn < 0;
+			area += polygon[i].cross(polygon[(i + 1) % n]);
+		}
+		if ((left && right) || area == 0)
+		{
+			std::cerr << "Error: StaticGeometry::addPolygon: polygon is not convex, split it in convex parts" << std::endl;
+			return false;
+		}
+		
+		Element element;
+		element.shape = polygon;
+		if (area < 0)
+			std::reverse(element.shape.begin(), element.shape.end());
+		element.shape.getNormals(element.normals);
+		element.height = height;
+		element.color = color;
+		element.shape.getAxisAlignedBoundingBox(element.bottomLeft, element.topRight);
+		elements.push_back(element);
+		dirty = true;
+		return true;
+	}
+	
+	bool StaticGeometry::addSegment(const Point& a, const Point& b, double thickness, double height, const Color& color)
+	{
+		if (a == b || thickness <= 0)
+		{
+			std::cerr << "Error: StaticGeometry::addSegment: segment is degenerate or thickness is not positive" << std::endl;
+			return false;
+		}
+		const Vector normal((b - a).perp().unitary() * (thickness / 2));
+		Polygon rectangle;
+		rectangle << a - normal << b - normal << b + normal << a + normal;
+		return addPolygon(rectangle, height, color);
+	}
+	
+	void StaticGeometry::clear()
+	{
+		elements.clear();
+		hierarchy.clear();
+		dirty = false;
+	}
+	
+	void StaticGeometry::build()
+	{
+		if (!dirty)
+			return;
+		std::vector<Point> centers;
+		centers.reserve(elements.size());
+		for (size_t i = 0; i < elements.size(); ++i)
+			centers.push_back((elements[i].bottomLeft + elements[i].topRight) / 2);
+		hierarchy.build(centers);
+		hierarchy.refit([this](unsigned index, Point& bottomLeft, Point& topRight) {
+			bottomLeft = elements[index].bottomLeft;
+			topRight = elements[index].topRight;
+		});
+		dirty = false;
+	}
+	
+	bool StaticGeometry::overlaps(const Point& bottomLeft, const Point& topRight) const
+	{
+		bool found(false);
+		visitOverlapping(bottomLeft, topRight, [&found](const Element& element) { found = true; });
+		return found;
+	}
+}
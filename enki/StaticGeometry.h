@@ -0,0 +1,129 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#ifndef __ENKI_STATICGEOMETRY_H
+#define __ENKI_STATICGEOMETRY_H
+
+#include "Geometry.h"
+#include "Types.h"
+#include "BoxHierarchy.h"
+#include <vector>
+
+/*!	\file StaticGeometry.h
+	\brief Static obstacles and maze walls of a world, indexed by a bounding volume hierarchy
+*/
+
+namespace Enki
+{
+	//! Static obstacles and maze walls of a world, indexed by a bounding volume hierarchy
+	/*! \ingroup core
+		Elements are convex polygons of infinite mass, registered once; objects collide with them
+		and sensors see them as they see the walls of the world. Unlike objects, they do not take part
+		in the broadphase of objects, and queries cost O(log m) for m elements.
+		The hierarchy is rebuilt at the beginning of the next step after elements are added or removed,
+		so elements must not be modified while the world is stepping.
+	*/
+	class StaticGeometry
+	{
+	public:
+		//! A static element
+		struct Element
+		{
+			//! Convex polygon, counter-clockwise, in world coordinates
+			Polygon shape;
+			//! Outward unit normals of the sides of shape, normals[i] being the one of side (shape[i], shape[i+1])
+			SmallVector<Vector, 16> normals;
+			//! Height of the element, sensors higher than it do not see it
+			double height;
+			//! Color of the element
+			Color color;
+			//! Bottom-left corner of the axis-aligned bounding box of shape
+			Point bottomLeft;
+			//! Top-right corner of the axis-aligned bounding box of shape
+			Point topRight;
+		};
+		
+	protected:
+		//! All elements, in the order of addition
+		std::vector<Element> elements;
+		//! Hierarchy of the boxes of elements
+		BoxHierarchy hierarchy;
+		//! Whether the hierarchy must be rebuilt
+		bool dirty;
+		
+	public:
+		//! Constructor, no element
+		StaticGeometry();
+		
+		//! Add a convex polygon of a given height, in world coordinates; return false if it is not convex, clockwise polygons are reversed
+		bool addPolygon(const Polygon& polygon, double height, const Color& color = Color::gray);
+		//! Add a wall along the segment from a to b, as a rectangle of a given thickness centered on the segment
+		bool addSegment(const Point& a, const Point& b, double thickness, double height, const Color& color = Color::gray);
+		//! Remove all elements
+		void clear();
+		//! Return the number of elements
+		size_t size() const { return elements.size(); }
+		//! Return whether there is no element
+		bool empty() const { return elements.empty(); }
+		//! Return an element, in the order of addition
+		const Element& operator[](size_t i) const { return elements[i]; }
+		
+		//! Rebuild the hierarchy if elements were added or removed since the last call; queries require an up-to-date hierarchy
+		void build();
+		//! Return whether any element box overlaps the box from bottomLeft to topRight
+		bool overlaps(const Point& bottomLeft, const Point& topRight) const;
+		
+		//! Call visitor(element) on every element whose box overlaps the box from bottomLeft to topRight
+		template<typename Visitor>
+		void visitOverlapping(const Point& bottomLeft, const Point& topRight, Visitor visitor) const
+		{
+			visit([&bottomLeft, &topRight](const Point& nodeBottomLeft, const Point& nodeTopRight) {
+				return nodeBottomLeft.x <= topRight.x && nodeTopRight.x >= bottomLeft.x && nodeBottomLeft.y <= topRight.y && nodeTopRight.y >= bottomLeft.y;
+			}, visitor);
+		}
+		
+		//! Call visitor(element) on every element whose box passes boxTest(bottomLeft, topRight), as well as the boxes of all nodes containing it; boxTest must be conservative
+		template<typename BoxTest, typename Visitor>
+		void visit(BoxTest boxTest, Visitor visitor) const
+		{
+			hierarchy.visit(boxTest, [this, &boxTest, &visitor](unsigned index) {
+				const Element& element(elements[index]);
+				if (boxTest(element.bottomLeft, element.topRight))
+					visitor(element);
+			});
+		}
+	};
+}
+
+#endif
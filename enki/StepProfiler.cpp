@@ -0,0 +1,214 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include "StepProfiler.h"
+#include "Interaction.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <typeinfo>
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+/*!	\file StepProfiler.cpp
+	\brief Implementation of the step profiler
+*/
+
+namespace Enki
+{
+	thread_local StepProfiler::Counters* StepProfiler::threadCounters = 0;
+	
+	StepProfiler::StepProfiler() :
+		counters(1),
+		latencyHistogram(bucketCount, 0),
+		currentPhase(PHASE_PHYSICS_INIT),
+		outerThreadCounters(0)
+	{
+		reset();
+	}
+	
+	bool StepProfiler::isCompiledIn()
+	{
+		#ifdef ENKI_PROFILING
+		return true;
+		#else
+		return false;
+		#endif
+	}
+	
+	const char* StepProfiler::getPhaseName(Phase phase)
+	{
+		static const char* names[PHASE_COUNT] = {
+			"physics init",
+			"object collisions",
+			"wall collisions",
+			"local interactions",
+			"global interactions",
+			"control step",
+			"bluetooth",
+			"trajectory recording"
+		};
+		if (phase < PHASE_COUNT)
+			return names[phase];
+		else
+			return "";
+	}
+	
+	void StepProfiler::reset()
+	{
+		for (size_t i = 0; i < counters.size(); ++i)
+			counters[i] = Counters();
+		for (unsigned i = 0; i < PHASE_COUNT; ++i)
+			phaseTimes[i] = 0;
+		broadPhasePairs = 0;
+		stepCount = 0;
+		std::fill(latencyHistogram.begin(), latencyHistogram.end(), 0);
+	}
+	
+	uint64_t StepProfiler::getContacts() const
+	{
+		uint64_t count(0);
+		for (size_t i = 0; i < counters.size(); ++i)
+			count += counters[i].contacts;
+		return count;
+	}
+	
+	uint64_t StepProfiler::getProcessedInteractionPairs() const
+	{
+		uint64_t count(0);
+		for (size_t i = 0; i < counters.size(); ++i)
+			count += counters[i].processedInteractionPairs;
+		return count;
+	}
+	
+	uint64_t StepProfiler::getRejectedInteractionPairs() const
+	{
+		uint64_t count(0);
+		for (size_t i = 0; i < counters.size(); ++i)
+			count += counters[i].rejectedInteractionPairs;
+		return count;
+	}
+	
+	std::map<std::string, uint64_t> StepProfiler::getObjectStepCalls() const
+	{
+		std::map<std::string, uint64_t> calls;
+		for (size_t i = 0; i < counters.size(); ++i)
+		{
+			for (auto it = counters[i].objectSteps.begin(); it != counters[i].objectSteps.end(); ++it)
+			{
+				std::string name(it->first.name());
+				#ifdef __GNUG__
+				int status;
+				char* demangled(abi::__cxa_demangle(name.c_str(), 0, 0, &status));
+				if (demangled)
+				{
+					name = demangled;
+					free(demangled);
+				}
+				#endif
+				calls[name] += it->second;
+			}
+		}
+		return calls;
+	}
+	
+	double StepProfiler::getStepLatencyPercentile(double p) const
+	{
+		if (stepCount == 0)
+			return 0;
+		const uint64_t rank(std::max<uint64_t>(1, uint64_t(std::ceil(p * double(stepCount)))));
+		uint64_t count(0);
+		for (unsigned i = 0; i < bucketCount; ++i)
+		{
+			count += latencyHistogram[i];
+			if (count >= rank)
+				return std::pow(2., double(i + 1) / double(bucketsPerOctave)) * 1e-9;
+		}
+		return std::pow(2., double(bucketCount) / double(bucketsPerOctave)) * 1e-9;
+	}
+	
+	void StepProfiler::setThreadCount(unsigned threadCount)
+	{
+		// keep the counters of the removed threads in the first one
+		for (size_t i = threadCount; i < counters.size(); ++i)
+		{
+			counters[0].contacts += counters[i].contacts;
+			counters[0].processedInteractionPairs += counters[i].processedInteractionPairs;
+			counters[0].rejectedInteractionPairs += counters[i].rejectedInteractionPairs;
+			for (auto it = counters[i].objectSteps.begin(); it != counters[i].objectSteps.end(); ++it)
+				counters[0].objectSteps[it->first] += it->second;
+		}
+		counters.resize(std::max(threadCount, 1u));
+	}
+	
+	void StepProfiler::beginStep()
+	{
+		stepStart = Clock::now();
+		phaseStart = stepStart;
+		currentPhase = PHASE_PHYSICS_INIT;
+		outerThreadCounters = threadCounters;
+		threadCounters = &counters[0];
+	}
+	
+	void StepProfiler::switchPhase(Phase phase)
+	{
+		const Clock::time_point now(Clock::now());
+		phaseTimes[currentPhase] += std::chrono::duration<double>(now - phaseStart).count();
+		phaseStart = now;
+		currentPhase = phase;
+	}
+	
+	void StepProfiler::endStep()
+	{
+		const Clock::time_point now(Clock::now());
+		phaseTimes[currentPhase] += std::chrono::duration<double>(now - phaseStart).count();
+		const double ns(std::chrono::duration<double, std::nano>(now - stepStart).count());
+		const int bucket(ns > 1 ? int(std::log2(ns) * bucketsPerOctave) : 0);
+		++latencyHistogram[std::min(std::max(bucket, 0), int(bucketCount) - 1)];
+		++stepCount;
+		threadCounters = outerThreadCounters;
+		outerThreadCounters = 0;
+	}
+	
+	void StepProfiler::countObjectStep(const LocalInteraction* interaction)
+	{
+		if (!threadCounters)
+			return;
+		++threadCounters->processedInteractionPairs;
+		++threadCounters->objectSteps[std::type_index(typeid(*interaction))];
+	}
+}
+
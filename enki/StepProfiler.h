@@ -0,0 +1,183 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#ifndef __ENKI_STEPPROFILER_H
+#define __ENKI_STEPPROFILER_H
+
+#include <vector>
+#include <map>
+#include <string>
+#include <chrono>
+#include <typeindex>
+#include <unordered_map>
+#include <stdint.h>
+
+/*!	\file StepProfiler.h
+	\brief Time and counters of the phases of World::step()
+*/
+
+//! Evaluate statement only if Enki is built with ENKI_PROFILING, used to instrument World::step()
+#ifdef ENKI_PROFILING
+#define ENKI_PROFILE(statement) statement
+#else
+#define ENKI_PROFILE(statement)
+#endif
+
+namespace Enki
+{
+	class LocalInteraction;
+	
+	//! Time spent in the phases of World::step() and counters of the work done, accumulated over steps
+	/*! \ingroup core
+		The world only fills its profiler if Enki is built with the ENKI_PROFILING CMake option,
+		otherwise the instrumentation is compiled out and all values stay at zero.
+		Counters are accumulated per thread and summed when queried.
+	*/
+	class StepProfiler
+	{
+	public:
+		//! The phases of a step
+		enum Phase
+		{
+			PHASE_PHYSICS_INIT = 0,		//!< forces and integration of objects, and setup of the step
+			PHASE_OBJECT_COLLISIONS,	//!< broadphase and collisions between objects
+			PHASE_WALL_COLLISIONS,		//!< collisions with walls, de-interlacing and sleep
+			PHASE_LOCAL_INTERACTIONS,	//!< update of world-space hulls, broadphase and local interactions
+			PHASE_GLOBAL_INTERACTIONS,	//!< global interactions and finalisation of all interactions
+			PHASE_CONTROL_STEP,			//!< control steps of objects and of the world
+			PHASE_BLUETOOTH,			//!< BluetoothBase::step()
+			PHASE_TRAJECTORY_RECORDING,	//!< TrajectoryRecorder::record()
+			PHASE_COUNT
+		};
+		
+		//! Counters of a thread, padded so that counters of different threads do not share a cache line
+		struct Counters
+		{
+			//! Number of pairs of objects colliding
+			uint64_t contacts;
+			//! Number of pairs of a local interaction and an object in its range
+			uint64_t processedInteractionPairs;
+			//! Number of pairs of a local interaction and a neighbouring object out of its range, skipped by Robot::doLocalInteractions()
+			uint64_t rejectedInteractionPairs;
+			//! Number of calls to LocalInteraction::objectStep(), per class of interaction
+			std::unordered_map<std::type_index, uint64_t> objectSteps;
+			//! Separates the fields above from the ones of the next counters, as alignas() is not honoured by std::vector in C++11
+			char padding[64];
+			
+			//! Constructor, all counters at zero
+			Counters() : contacts(0), processedInteractionPairs(0), rejectedInteractionPairs(0) {}
+		};
+		
+		//! The counters of the thread running the current part of a step, 0 outside steps
+		static thread_local Counters* threadCounters;
+		
+	protected:
+		typedef std::chrono::steady_clock Clock;
+		
+		//! Number of histogram buckets per doubling of latency
+		static const unsigned bucketsPerOctave = 8;
+		//! Number of histogram buckets, covering latencies up to 2^40 ns
+		static const unsigned bucketCount = 40 * bucketsPerOctave;
+		
+		//! Counters of every thread
+		std::vector<Counters> counters;
+		//! Time spent in every phase, in seconds
+		double phaseTimes[PHASE_COUNT];
+		//! Number of pairs found by the broadphase of collisions
+		uint64_t broadPhasePairs;
+		//! Number of steps
+		uint64_t stepCount;
+		//! Histogram of the durations of steps, bucket i counting durations around 2^(i/bucketsPerOctave) ns
+		std::vector<uint64_t> latencyHistogram;
+		//! Phase being timed
+		Phase currentPhase;
+		//! Time at which the current phase started
+		Clock::time_point phaseStart;
+		//! Time at which the current step started
+		Clock::time_point stepStart;
+		//! The counters the calling thread used before beginStep(), restored by endStep(), so that a world stepped while another one is stepping does not stop the counting of the latter
+		Counters* outerThreadCounters;
+		
+	public:
+		//! Constructor, all values at zero
+		StepProfiler();
+		
+		//! Return whether Enki was built with ENKI_PROFILING, otherwise all values stay at zero
+		static bool isCompiledIn();
+		//! Return the name of a phase
+		static const char* getPhaseName(Phase phase);
+		
+		//! Set all values to zero
+		void reset();
+		//! Return the number of profiled steps
+		uint64_t getStepCount() const { return stepCount; }
+		//! Return the time spent in a phase, in seconds
+		double getPhaseTime(Phase phase) const { return phaseTimes[phase]; }
+		//! Return the number of pairs of objects found by the broadphase of collisions and tested for contacts
+		uint64_t getBroadPhasePairs() const { return broadPhasePairs; }
+		//! Return the number of pairs of objects in contact
+		uint64_t getContacts() const;
+		//! Return the number of pairs of a local interaction and an object in its range, for which objectStep() was called
+		uint64_t getProcessedInteractionPairs() const;
+		//! Return the number of pairs of a local interaction and a neighbouring object out of its range, skipped by Robot::doLocalInteractions()
+		uint64_t getRejectedInteractionPairs() const;
+		//! Return the number of calls to LocalInteraction::objectStep(), per name of class of interaction
+		std::map<std::string, uint64_t> getObjectStepCalls() const;
+		//! Return the duration of steps, in seconds, below which a fraction p of the steps are, with a precision of 9%
+		double getStepLatencyPercentile(double p) const;
+		
+		// instrumentation, called by the world through ENKI_PROFILE
+		
+		//! Set the number of threads whose counters are kept
+		void setThreadCount(unsigned threadCount);
+		//! Start a step, in PHASE_PHYSICS_INIT, and use the counters of thread 0 in the calling thread, remembering the ones it used
+		void beginStep();
+		//! End the current phase and start phase
+		void switchPhase(Phase phase);
+		//! End the current phase and the step, and give the calling thread back the counters it used before beginStep()
+		void endStep();
+		//! Use the counters of thread in the calling thread
+		void setThread(unsigned thread) { threadCounters = &counters[thread]; }
+		//! Add pairs found by the broadphase of collisions
+		void addBroadPhasePairs(size_t count) { broadPhasePairs += count; }
+		//! Count a contact in the calling thread
+		static void countContact() { if (threadCounters) ++threadCounters->contacts; }
+		//! Count pairs of a local interaction and an object out of its range in the calling thread
+		static void countRejectedInteractionPairs(size_t count) { if (threadCounters) threadCounters->rejectedInteractionPairs += count; }
+		//! Count a call to objectStep() of interaction in the calling thread
+		static void countObjectStep(const LocalInteraction* interaction);
+	};
+}
+
+#endif
@@ -0,0 +1,184 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include "ThreadPool.h"
+#include <cassert>
+#include <algorithm>
+
+/*!	\file ThreadPool.cpp
+	\brief Implementation of the work-stealing thread pool
+*/
+
+namespace Enki
+{
+	ThreadPool::ThreadPool(unsigned threadCount) :
+		currentJob(0),
+		generation(0),
+		pendingWorkers(0),
+		stopping(false)
+	{
+		if (threadCount == 0)
+			threadCount = std::max(1u, std::thread::hardware_concurrency());
+		
+		for (unsigned i = 0; i < threadCount; ++i)
+			ranges.push_back(std::unique_ptr<Range>(new Range));
+		for (unsigned i = 1; i < threadCount; ++i)
+			workers.push_back(std::thread(&ThreadPool::workerMain, this, i));
+	}
+	
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		wakeCondition.notify_all();
+		for (size_t i = 0; i < workers.size(); ++i)
+			workers[i].join();
+	}
+	
+	void ThreadPool::parallelFor(size_t count, const Job& job)
+	{
+		if (count == 0)
+			return;
+		
+		// without workers, or with a single index, run in the calling thread
+		if (workers.empty() || count == 1)
+		{
+			for (size_t i = 0; i < count; ++i)
+				job(i, 0);
+			return;
+		}
+		
+		// split indices evenly, workers will balance the load by stealing
+		const size_t threadCount(ranges.size());
+		for (size_t t = 0; t < threadCount; ++t)
+		{
+			std::lock_guard<std::mutex> lock(ranges[t]->mutex);
+			ranges[t]->begin = (count * t) / threadCount;
+			ranges[t]->end = (count * (t + 1)) / threadCount;
+		}
+		
+		// wake workers
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			currentJob = &job;
+			pendingWorkers = unsigned(workers.size());
+			++generation;
+		}
+		wakeCondition.notify_all();
+		
+		// participate
+		work(0, job);
+		
+		// wait for workers to finish their last index
+		std::unique_lock<std::mutex> lock(mutex);
+		while (pendingWorkers != 0)
+			doneCondition.wait(lock);
+		currentJob = 0;
+	}
+	
+	void ThreadPool::workerMain(unsigned thread)
+	{
+		unsigned long seenGeneration(0);
+		while (true)
+		{
+			const Job* job;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				while (!stopping && generation == seenGeneration)
+					wakeCondition.wait(lock);
+				if (stopping)
+					return;
+				seenGeneration = generation;
+				job = currentJob;
+			}
+			
+			work(thread, *job);
+			
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				assert(pendingWorkers > 0);
+				if (--pendingWorkers == 0)
+					doneCondition.notify_one();
+			}
+		}
+	}
+	
+	void ThreadPool::work(unsigned thread, const Job& job)
+	{
+		size_t index;
+		while (nextIndex(thread, index))
+			job(index, thread);
+	}
+	
+	bool ThreadPool::nextIndex(unsigned thread, size_t& index)
+	{
+		Range& own(*ranges[thread]);
+		{
+			std::lock_guard<std::mutex> lock(own.mutex);
+			if (own.begin < own.end)
+			{
+				index = own.begin++;
+				return true;
+			}
+		}
+		
+		// own range is empty, steal the back half of the range of another thread
+		const size_t threadCount(ranges.size());
+		for (size_t i = 1; i < threadCount; ++i)
+		{
+			Range& victim(*ranges[(thread + i) % threadCount]);
+			size_t stolenBegin, stolenEnd;
+			{
+				std::lock_guard<std::mutex> lock(victim.mutex);
+				const size_t remaining(victim.end - victim.begin);
+				if (remaining == 0)
+					continue;
+				stolenEnd = victim.end;
+				stolenBegin = victim.end - (remaining + 1) / 2;
+				victim.end = stolenBegin;
+			}
+			// process the first stolen index now, keep the others in our range
+			{
+				std::lock_guard<std::mutex> lock(own.mutex);
+				own.begin = stolenBegin + 1;
+				own.end = stolenEnd;
+			}
+			index = stolenBegin;
+			return true;
+		}
+		return false;
+	}
+}
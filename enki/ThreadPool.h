@@ -0,0 +1,127 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#ifndef __ENKI_THREADPOOL_H
+#define __ENKI_THREADPOOL_H
+
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+
+/*!	\file ThreadPool.h
+	\brief A work-stealing thread pool for parallel loops
+*/
+
+namespace Enki
+{
+	//! A pool of threads running parallel loops with work stealing
+	/*! \ingroup core
+		The indices of a loop are split evenly between threads, each thread takes them one by one
+		from the front of its own range and, once it is empty, steals the back half of the range of
+		another thread. This balances loops whose iterations have very different costs.
+		The calling thread participates to the loop as thread 0.
+	*/
+	class ThreadPool
+	{
+	public:
+		//! A job, called with the index of the iteration and the index of the thread running it
+		typedef std::function<void(size_t index, unsigned thread)> Job;
+		
+	protected:
+		//! The range of indices a thread still has to process, padded so that ranges of different threads do not share a cache line
+		struct Range
+		{
+			//! Protects begin and end
+			std::mutex mutex;
+			//! First index to process
+			size_t begin;
+			//! One past the last index to process
+			size_t end;
+			//! Separates the fields above from the ones of the next range, as alignas() is not honoured by std::vector in C++11
+			char padding[64];
+			
+			//! Constructor, empty range
+			Range() : begin(0), end(0) {}
+		};
+		
+		//! Worker threads, the calling thread is not part of them
+		std::vector<std::thread> workers;
+		//! The ranges of all threads, including the calling one at index 0
+		std::vector<std::unique_ptr<Range> > ranges;
+		
+		//! Protects the state below
+		std::mutex mutex;
+		//! Signals workers that a job is available or that they must stop
+		std::condition_variable wakeCondition;
+		//! Signals the calling thread that all workers are done
+		std::condition_variable doneCondition;
+		//! Job of the current loop, valid while workers are running
+		const Job* currentJob;
+		//! Incremented on every loop, to wake workers once per loop
+		unsigned long generation;
+		//! Number of workers that have not yet finished the current loop
+		unsigned pendingWorkers;
+		//! Whether the workers must terminate
+		bool stopping;
+		
+	public:
+		//! Constructor, creates a pool running loops on threadCount threads including the calling one; 0 means one per hardware thread
+		explicit ThreadPool(unsigned threadCount = 0);
+		//! Destructor, waits for all workers to terminate
+		~ThreadPool();
+		
+		//! Return the number of threads running loops, including the calling one
+		unsigned getThreadCount() const { return unsigned(ranges.size()); }
+		//! Call job for all indices in [0, count) and return once all of them are done; must not be called from a job
+		void parallelFor(size_t count, const Job& job);
+		
+	protected:
+		//! Main function of worker threads
+		void workerMain(unsigned thread);
+		//! Process indices of the current job until none is left
+		void work(unsigned thread, const Job& job);
+		//! Get the next index for thread, from its own range or by stealing; return false if none is left
+		bool nextIndex(unsigned thread, size_t& index);
+		
+	private:
+		// a pool cannot be copied
+		ThreadPool(const ThreadPool&);
+		ThreadPool& operator=(const ThreadPool&);
+	};
+}
+
+#endif
@@ -0,0 +1,457 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include "TrajectoryRecorder.h"
+#include <iostream>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <chrono>
+#include <assert.h>
+#ifdef _WIN32
+#include <fstream>
+#include <iterator>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/*!	\file TrajectoryRecorder.cpp
+	\brief Implementation of the recording of trajectories
+*/
+
+namespace Enki
+{
+	using namespace TrajectoryFormat;
+	
+	size_t TrajectoryFormat::formatSize(uint32_t format)
+	{
+		switch (format)
+		{
+			case FORMAT_INT8: return 1;
+			case FORMAT_INT16: return 2;
+			case FORMAT_INT32: return 4;
+			default: return 8;
+		}
+	}
+	
+	//! Number of columns for the pose and the speed
+	static const size_t baseColumnCount = 6;
+	//! Names of the columns for the pose and the speed
+	static const char* baseColumnNames[baseColumnCount] = { "x", "y", "angle", "xSpeed", "ySpeed", "angSpeed" };
+	
+	//! Append count bytes to data
+	static void append(std::vector<char>& data, const void* bytes, size_t count)
+	{
+		const size_t offset(data.size());
+		data.resize(offset + count);
+		std::memcpy(&data[offset], bytes, count);
+	}
+	
+	//! Append integers to data, converted to T
+	template<typename T>
+	static void appendIntegers(std::vector<char>& data, const int64_t* values, size_t count)
+	{
+		const size_t offset(data.size());
+		data.resize(offset + count * sizeof(T));
+		T* destination(reinterpret_cast<T*>(&data[offset]));
+		for (size_t i = 0; i < count; ++i)
+			destination[i] = T(values[i]);
+	}
+	
+	//! Set values to integers of type T from source
+	template<typename T>
+	static void readIntegers(const char* source, size_t count, bool delta, std::vector<int64_t>& values)
+	{
+		const T* integers(reinterpret_cast<const T*>(source));
+		if (delta)
+			for (size_t i = 0; i < count; ++i)
+				values[i] += integers[i];
+		else
+			for (size_t i = 0; i < count; ++i)
+				values[i] = integers[i];
+	}
+	
+	// TrajectoryRecorder
+	
+	TrajectoryRecorder::TrajectoryRecorder(const std::string& fileName, size_t bufferSize) :
+		positionQuantum(0),
+		angleQuantum(0),
+		deltaEncoding(false),
+		keyframeInterval(100),
+		file(fopen(fileName.c_str(), "wb")),
+		buffer(bufferSize),
+		stopping(false),
+		headerWritten(false),
+		stepCount(0),
+		time(0),
+		framesSinceKeyframe(0)
+	{
+		if (file)
+			writer = std::thread(&TrajectoryRecorder::writerMain, this);
+		else
+			std::cerr << "Error: TrajectoryRecorder::TrajectoryRecorder: cannot open " << fileName << " for writing" << std::endl;
+	}
+	
+	TrajectoryRecorder::~TrajectoryRecorder()
+	{
+		close();
+	}
+	
+	void TrajectoryRecorder::addChannel(const std::string& name, const ChannelFunction& function, double quantum)
+	{
+		assert(!headerWritten);
+		Channel channel;
+		channel.name = name;
+		channel.function = function;
+		channel.quantum = quantum;
+		channels.push_back(channel);
+	}
+	
+	double TrajectoryRecorder::getQuantum(size_t column) const
+	{
+		if (column == 0 || column == 1 || column == 3 || column == 4)
+			return positionQuantum;
+		else if (column < baseColumnCount)
+			return angleQuantum;
+		else
+			return channels[column - baseColumnCount].quantum;
+	}
+	
+	void TrajectoryRecorder::writeHeader()
+	{
+		std::vector<char> header;
+		FileHeader fileHeader;
+		std::memcpy(fileHeader.magic, "ENKITRJ", 8);
+		fileHeader.version = 1;
+		fileHeader.columnCount = uint32_t(baseColumnCount + channels.size());
+		append(header, &fileHeader, sizeof(fileHeader));
+		for (size_t column = 0; column < fileHeader.columnCount; ++column)
+		{
+			ColumnInfo info;
+			std::memset(info.name, 0, sizeof(info.name));
+			const std::string name(column < baseColumnCount ? baseColumnNames[column] : channels[column - baseColumnCount].name);
+			std::strncpy(info.name, name.c_str(), sizeof(info.name) - 1);
+			info.quantum = getQuantum(column);
+			append(header, &info, sizeof(info));
+		}
+		buffer.push(&header[0], header.size());
+		headerWritten = true;
+	}
+	
+	void TrajectoryRecorder::record(const World* world, double dt)
+	{
+		if (!file)
+			return;
+		if (!headerWritten)
+			writeHeader();
+		
+		++stepCount;
+		time += dt;
+		const size_t columnCount(baseColumnCount + channels.size());
+		const size_t objectCount(world->objects.size());
+		uids.resize(objectCount);
+		for (size_t i = 0; i < objectCount; ++i)
+			uids[i] = world->objects[i]->uid;
+		
+		// integers can be relative to the previous frame if it has the same objects
+		const bool delta(deltaEncoding && stepCount > 1 && framesSinceKeyframe + 1 < keyframeInterval && uids == previousUids);
+		framesSinceKeyframe = delta ? framesSinceKeyframe + 1 : 0;
+		
+		// header and encodings are filled once the columns are encoded
+		frame.clear();
+		frame.resize(sizeof(FrameHeader) + padded(columnCount * sizeof(ColumnEncoding)));
+		if (objectCount)
+			append(frame, &uids[0], objectCount * sizeof(uint32_t));
+		frame.resize(padded(frame.size()));
+		
+		std::vector<ColumnEncoding> encodings(columnCount);
+		values.resize(columnCount * objectCount);
+		columnValues.resize(objectCount);
+		for (size_t column = 0; column < columnCount; ++column)
+		{
+			for (size_t i = 0; i < objectCount; ++i)
+			{
+				const PhysicalObject* o(world->objects[i]);
+				switch (column)
+				{
+					case 0: columnValues[i] = o->pos.x; break;
+					case 1: columnValues[i] = o->pos.y; break;
+					case 2: columnValues[i] = o->angle; break;
+					case 3: columnValues[i] = o->speed.x; break;
+					case 4: columnValues[i] = o->speed.y; break;
+					case 5: columnValues[i] = o->angSpeed; break;
+					default: columnValues[i] = channels[column - baseColumnCount].function(o); break;
+				}
+			}
+			
+			const double quantum(getQuantum(column));
+			if (quantum == 0 || objectCount == 0)
+			{
+				encodings[column].format = FORMAT_FLOAT64;
+				encodings[column].delta = 0;
+				append(frame, &columnValues[0], objectCount * sizeof(double));
+				continue;
+			}
+			
+			// quantize, take differences with the previous frame, and find the smallest type holding them
+			int64_t* quantized(&values[column * objectCount]);
+			std::vector<int64_t>& stored(storedValues);
+			stored.resize(objectCount);
+			int64_t maxMagnitude(0);
+			for (size_t i = 0; i < objectCount; ++i)
+			{
+				quantized[i] = int64_t(std::llround(columnValues[i] / quantum));
+				stored[i] = delta ? quantized[i] - previousValues[column * objectCount + i] : quantized[i];
+				maxMagnitude = std::max(maxMagnitude, stored[i] < 0 ? -(stored[i] + 1) : stored[i]);
+			}
+			encodings[column].delta = delta ? 1 : 0;
+			if (maxMagnitude <= std::numeric_limits<int8_t>::max())
+			{
+				encodings[column].format = FORMAT_INT8;
+				appendIntegers<int8_t>(frame, &stored[0], objectCount);
+			}
+			else if (maxMagnitude <= std::numeric_limits<int16_t>::max())
+			{
+				encodings[column].format = FORMAT_INT16;
+				appendIntegers<int16_t>(frame, &stored[0], objectCount);
+			}
+			else if (maxMagnitude <= std::numeric_limits<int32_t>::max())
+			{
+				encodings[column].format = FORMAT_INT32;
+				appendIntegers<int32_t>(frame, &stored[0], objectCount);
+			}
+			else
+			{
+				encodings[column].format = FORMAT_INT64;
+				appendIntegers<int64_t>(frame, &stored[0], objectCount);
+			}
+			frame.resize(padded(frame.size()));
+		}
+		
+		FrameHeader header;
+		header.size = frame.size();
+		header.step = stepCount;
+		header.time = time;
+		header.objectCount = uint32_t(objectCount);
+		header.keyframe = delta ? 0 : 1;
+		std::memcpy(&frame[0], &header, sizeof(header));
+		std::memcpy(&frame[sizeof(header)], &encodings[0], columnCount * sizeof(ColumnEncoding));
+		buffer.push(&frame[0], frame.size());
+		
+		previousUids.swap(uids);
+		previousValues.swap(values);
+	}
+	
+	void TrajectoryRecorder::close()
+	{
+		if (!file)
+			return;
+		stopping.store(true, std::memory_order_release);
+		writer.join();
+		fclose(file);
+		file = 0;
+	}
+	
+	void TrajectoryRecorder::writerMain()
+	{
+		while (true)
+		{
+			size_t size;
+			const char* bytes(buffer.front(size));
+			if (size)
+			{
+				fwrite(bytes, 1, size, file);
+				buffer.pop(size);
+			}
+			else if (stopping.load(std::memory_order_acquire))
+			{
+				// the producer is done, write what it pushed before stopping
+				if (buffer.readable() == 0)
+					break;
+			}
+			else
+				std::this_thread::sleep_for(std::chrono::microseconds(200));
+		}
+	}
+	
+	// TrajectoryReader
+	
+	TrajectoryReader::TrajectoryReader(const std::string& fileName) :
+		data(0),
+		size(0)
+	{
+		const char* mapped(0);
+		#ifdef _WIN32
+		std::ifstream stream(fileName.c_str(), std::ios::binary);
+		if (stream)
+		{
+			copy.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+			size = copy.size();
+			mapped = copy.empty() ? 0 : &copy[0];
+		}
+		#else
+		const int fd(open(fileName.c_str(), O_RDONLY));
+		struct stat status;
+		if (fd >= 0 && fstat(fd, &status) == 0 && status.st_size > 0)
+		{
+			void* address(mmap(0, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0));
+			if (address != MAP_FAILED)
+			{
+				mapped = static_cast<const char*>(address);
+				size = status.st_size;
+			}
+		}
+		if (fd >= 0)
+			::close(fd);
+		#endif
+		if (!mapped)
+		{
+			std::cerr << "Error: TrajectoryReader::TrajectoryReader: cannot read " << fileName << std::endl;
+			return;
+		}
+		
+		// check the header, then index the complete frames
+		FileHeader header;
+		std::memset(&header, 0, sizeof(header));
+		if (size >= sizeof(header))
+			std::memcpy(&header, mapped, sizeof(header));
+		if (std::memcmp(header.magic, "ENKITRJ", 8) != 0 || header.version != 1 || size < sizeof(header) + header.columnCount * sizeof(ColumnInfo))
+		{
+			std::cerr << "Error: TrajectoryReader::TrajectoryReader: " << fileName << " is not a trajectory file" << std::endl;
+			#ifndef _WIN32
+			munmap(const_cast<char*>(mapped), size);
+			#endif
+			return;
+		}
+		data = mapped;
+		const ColumnInfo* infos(reinterpret_cast<const ColumnInfo*>(data + sizeof(header)));
+		columns.assign(infos, infos + header.columnCount);
+		size_t offset(sizeof(header) + header.columnCount * sizeof(ColumnInfo));
+		while (offset + sizeof(FrameHeader) <= size)
+		{
+			const FrameHeader* frameHeader(reinterpret_cast<const FrameHeader*>(data + offset));
+			if (frameHeader->size < sizeof(FrameHeader) || frameHeader->size > size - offset)
+				break;
+			frameOffsets.push_back(offset);
+			offset += frameHeader->size;
+		}
+	}
+	
+	TrajectoryReader::~TrajectoryReader()
+	{
+		#ifndef _WIN32
+		if (data)
+			munmap(const_cast<char*>(data), size);
+		#endif
+	}
+	
+	size_t TrajectoryReader::findColumn(const std::string& name) const
+	{
+		for (size_t column = 0; column < columns.size(); ++column)
+			if (name == columns[column].name)
+				return column;
+		return columns.size();
+	}
+	
+	const FrameHeader& TrajectoryReader::getFrameHeader(size_t frame) const
+	{
+		return *reinterpret_cast<const FrameHeader*>(data + frameOffsets[frame]);
+	}
+	
+	const ColumnEncoding& TrajectoryReader::getEncoding(size_t frame, size_t column) const
+	{
+		return reinterpret_cast<const ColumnEncoding*>(data + frameOffsets[frame] + sizeof(FrameHeader))[column];
+	}
+	
+	const uint32_t* TrajectoryReader::getUids(size_t frame) const
+	{
+		return reinterpret_cast<const uint32_t*>(data + frameOffsets[frame] + sizeof(FrameHeader) + padded(columns.size() * sizeof(ColumnEncoding)));
+	}
+	
+	const char* TrajectoryReader::getColumnData(size_t frame, size_t column) const
+	{
+		const size_t objectCount(getFrameHeader(frame).objectCount);
+		const char* columnData(reinterpret_cast<const char*>(getUids(frame)) + padded(objectCount * sizeof(uint32_t)));
+		for (size_t i = 0; i < column; ++i)
+			columnData += padded(objectCount * formatSize(getEncoding(frame, i).format));
+		return columnData;
+	}
+	
+	const double* TrajectoryReader::getRawColumn(size_t frame, size_t column) const
+	{
+		if (getEncoding(frame, column).format != FORMAT_FLOAT64)
+			return 0;
+		return reinterpret_cast<const double*>(getColumnData(frame, column));
+	}
+	
+	void TrajectoryReader::accumulate(size_t frame, size_t column, std::vector<int64_t>& values) const
+	{
+		const ColumnEncoding& encoding(getEncoding(frame, column));
+		const char* columnData(getColumnData(frame, column));
+		const size_t count(values.size());
+		switch (encoding.format)
+		{
+			case FORMAT_INT8: readIntegers<int8_t>(columnData, count, encoding.delta != 0, values); break;
+			case FORMAT_INT16: readIntegers<int16_t>(columnData, count, encoding.delta != 0, values); break;
+			case FORMAT_INT32: readIntegers<int32_t>(columnData, count, encoding.delta != 0, values); break;
+			default: readIntegers<int64_t>(columnData, count, encoding.delta != 0, values); break;
+		}
+	}
+	
+	void TrajectoryReader::readColumn(size_t frame, size_t column, std::vector<double>& values) const
+	{
+		const size_t objectCount(getFrameHeader(frame).objectCount);
+		values.resize(objectCount);
+		const double* raw(getRawColumn(frame, column));
+		if (raw)
+		{
+			std::copy(raw, raw + objectCount, values.begin());
+			return;
+		}
+		
+		// go back to the last frame whose integers are absolute, then add the differences
+		size_t first(frame);
+		while (getEncoding(first, column).delta)
+			--first;
+		std::vector<int64_t> integers(objectCount);
+		for (size_t i = first; i <= frame; ++i)
+			accumulate(i, column, integers);
+		const double quantum(columns[column].quantum);
+		for (size_t i = 0; i < objectCount; ++i)
+			values[i] = double(integers[i]) * quantum;
+	}
+}
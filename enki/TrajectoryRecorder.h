@@ -0,0 +1,270 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#ifndef __ENKI_TRAJECTORYRECORDER_H
+#define __ENKI_TRAJECTORYRECORDER_H
+
+#include "PhysicalEngine.h"
+#include "RingBuffer.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <stdint.h>
+
+/*!	\file TrajectoryRecorder.h
+	\brief Recording of the trajectories of objects to a binary file, and reading them back
+	
+	The file is little endian and all its blocks are aligned on 8 bytes, so that once mapped in memory
+	columns can be used in place, for instance with numpy.frombuffer(). It starts with a FileHeader,
+	followed by one ColumnInfo per column, followed by frames. Every frame is a FrameHeader, then one
+	ColumnEncoding per column, then the uids of the objects as uint32, then every column; uids and every
+	column are padded to a multiple of 8 bytes. The first columns are x, y, angle, xSpeed, ySpeed and
+	angSpeed, followed by the channels added by the user.
+	
+	A column without quantum is stored as float64. A column with a quantum q is stored as the integers
+	round(value / q), using int8, int16, int32 or int64, whichever is the smallest to hold all values of
+	the frame. With delta encoding, these integers are the difference with the ones of the previous
+	frame, which requires the same objects in the same order; frames not using it are keyframes.
+*/
+
+namespace Enki
+{
+	//! Binary layout of trajectory files, see TrajectoryRecorder.h
+	namespace TrajectoryFormat
+	{
+		//! Start of a trajectory file
+		struct FileHeader
+		{
+			char magic[8]; //!< "ENKITRJ" followed by a null character
+			uint32_t version; //!< version of the format, 1
+			uint32_t columnCount; //!< number of columns in every frame
+		};
+		
+		//! Description of a column of the file
+		struct ColumnInfo
+		{
+			char name[32]; //!< name of the column, null terminated
+			double quantum; //!< the step values are rounded to, or 0 if they are stored as float64
+		};
+		
+		//! Start of a frame
+		struct FrameHeader
+		{
+			uint64_t size; //!< size of the frame in bytes, including this header
+			uint64_t step; //!< index of the step after which this frame was recorded
+			double time; //!< simulated time after that step
+			uint32_t objectCount; //!< number of objects, the number of values in every column
+			uint32_t keyframe; //!< 1 if no column of this frame is relative to the previous frame, 0 otherwise
+		};
+		
+		//! Format of the values of a column in a frame
+		enum Format
+		{
+			FORMAT_FLOAT64 = 0,
+			FORMAT_INT8,
+			FORMAT_INT16,
+			FORMAT_INT32,
+			FORMAT_INT64
+		};
+		
+		//! Encoding of a column in a frame
+		struct ColumnEncoding
+		{
+			uint32_t format; //!< a Format
+			uint32_t delta; //!< 1 if the integers are relative to the ones of the previous frame
+		};
+		
+		//! Return the size in bytes of the values of a given format
+		size_t formatSize(uint32_t format);
+		//! Return size rounded up to a multiple of 8
+		inline size_t padded(size_t size) { return (size + 7) & ~size_t(7); }
+	}
+	
+	//! Records the trajectory of all objects of a world in a binary file, from a background thread
+	/*! \ingroup core
+		Assign the recorder to World::trajectoryRecorder, the world then calls record() after every step.
+		Frames are encoded in the stepping thread and passed through a lock-free ring buffer to a thread
+		that writes them, so that the file system never stalls the simulation unless the buffer is full.
+		The settings and the channels must not change once the first frame is recorded.
+	*/
+	class TrajectoryRecorder
+	{
+	public:
+		//! Return the value of a channel for an object, called from the thread stepping the world
+		typedef std::function<double(const PhysicalObject* object)> ChannelFunction;
+		
+		//! The step positions and speeds are rounded to, 0 (the default) to store them as float64
+		double positionQuantum;
+		//! The step angles and rotation speeds are rounded to, 0 (the default) to store them as float64
+		double angleQuantum;
+		//! Whether quantized values are stored relatively to the previous frame, false by default
+		bool deltaEncoding;
+		//! With delta encoding, the maximum number of frames between two keyframes, 100 by default
+		unsigned keyframeInterval;
+		
+	protected:
+		//! A channel recorded in addition to the pose and the speed
+		struct Channel
+		{
+			//! Name of the channel
+			std::string name;
+			//! Value of the channel for an object
+			ChannelFunction function;
+			//! The step values are rounded to, 0 to store them as float64
+			double quantum;
+		};
+		
+		//! The file frames are written to, 0 if it could not be opened
+		FILE* file;
+		//! The channels added by the user
+		std::vector<Channel> channels;
+		//! Bytes waiting to be written to the file
+		RingBuffer buffer;
+		//! Writes bytes from buffer to file
+		std::thread writer;
+		//! Whether the writer must terminate once the buffer is empty
+		std::atomic<bool> stopping;
+		
+		//! Whether the header of the file is written
+		bool headerWritten;
+		//! Number of steps recorded
+		uint64_t stepCount;
+		//! Simulated time
+		double time;
+		//! Number of frames since the last keyframe
+		unsigned framesSinceKeyframe;
+		//! Uids of the objects in the current frame
+		std::vector<uint32_t> uids;
+		//! Uids of the objects in the previous frame
+		std::vector<uint32_t> previousUids;
+		//! Values of the column being encoded
+		std::vector<double> columnValues;
+		//! Integers of the column being encoded, as written to the file
+		std::vector<int64_t> storedValues;
+		//! Quantized values of the previous frame, column by column
+		std::vector<int64_t> previousValues;
+		//! Quantized values of the current frame, column by column
+		std::vector<int64_t> values;
+		//! Frame being encoded
+		std::vector<char> frame;
+		
+	public:
+		//! Constructor, opens fileName for writing and starts the writing thread; bufferSize is the size in bytes of the ring buffer
+		TrajectoryRecorder(const std::string& fileName, size_t bufferSize = 1 << 22);
+		//! Destructor, calls close()
+		~TrajectoryRecorder();
+		
+		//! Return whether the file is open
+		bool isOpen() const { return file != 0; }
+		//! Add a column to the frames with the value of function for every object; quantum is the step values are rounded to, 0 to store them as float64
+		void addChannel(const std::string& name, const ChannelFunction& function, double quantum = 0);
+		//! Record the state of world after a step of dt
+		void record(const World* world, double dt);
+		//! Write the remaining frames, stop the writing thread and close the file
+		void close();
+		
+	protected:
+		//! Write the file header and the column descriptions
+		void writeHeader();
+		//! Return the quantum of a column
+		double getQuantum(size_t column) const;
+		//! Main function of the writing thread
+		void writerMain();
+		
+	private:
+		// a recorder cannot be copied
+		TrajectoryRecorder(const TrajectoryRecorder&);
+		TrajectoryRecorder& operator=(const TrajectoryRecorder&);
+	};
+	
+	//! Reads a file written by TrajectoryRecorder, mapping it in memory
+	/*! \ingroup core */
+	class TrajectoryReader
+	{
+	protected:
+		//! Start of the file in memory, 0 if it could not be opened
+		const char* data;
+		//! Size of the file in bytes
+		size_t size;
+		//! Copy of the file, when it cannot be mapped
+		std::vector<char> copy;
+		//! Columns of the file
+		std::vector<TrajectoryFormat::ColumnInfo> columns;
+		//! Offset of every frame in the file
+		std::vector<size_t> frameOffsets;
+		
+	public:
+		//! Constructor, opens and maps fileName and indexes its frames; frames that were not completely written are ignored
+		TrajectoryReader(const std::string& fileName);
+		//! Destructor, unmaps the file
+		~TrajectoryReader();
+		
+		//! Return whether the file is open and valid
+		bool isOpen() const { return data != 0; }
+		//! Return the number of columns
+		size_t getColumnCount() const { return columns.size(); }
+		//! Return the name of a column
+		std::string getColumnName(size_t column) const { return columns[column].name; }
+		//! Return the index of the column of a given name, or getColumnCount() if there is none
+		size_t findColumn(const std::string& name) const;
+		//! Return the number of frames
+		size_t getFrameCount() const { return frameOffsets.size(); }
+		//! Return the header of a frame
+		const TrajectoryFormat::FrameHeader& getFrameHeader(size_t frame) const;
+		//! Return the uids of the objects of a frame, getFrameHeader(frame).objectCount of them
+		const uint32_t* getUids(size_t frame) const;
+		//! Return the values of a column stored as float64 in a frame, in place, or 0 if it is quantized
+		const double* getRawColumn(size_t frame, size_t column) const;
+		//! Decode the values of a column in a frame, reading previous frames back to the last keyframe if needed
+		void readColumn(size_t frame, size_t column, std::vector<double>& values) const;
+		
+	protected:
+		//! Return the encoding of a column in a frame
+		const TrajectoryFormat::ColumnEncoding& getEncoding(size_t frame, size_t column) const;
+		//! Return the start of the values of a column in a frame
+		const char* getColumnData(size_t frame, size_t column) const;
+		//! Add the integers of a column in a frame to values, or set values to them if they are not relative to the previous frame
+		void accumulate(size_t frame, size_t column, std::vector<int64_t>& values) const;
+		
+	private:
+		// a reader cannot be copied
+		TrajectoryReader(const TrajectoryReader&);
+		TrajectoryReader& operator=(const TrajectoryReader&);
+	};
+}
+
+#endif
@@ -45,7 +45,7 @@ namespace Enki
 		const unsigned r((color>>16)&0xff);
 		const unsigned g((color>>8)&0xff);
 		const unsigned b((color>>0)&0xff);
-		return Color(double(r)/255., double(g)/255., double(b)/255., double(a)/255.);
+		return Color(Scalar(r)/255, Scalar(g)/255, Scalar(b)/255, Scalar(a)/255);
 	}
 	
 	Color Color::fromABGR(uint32_t color)
@@ -54,7 +54,7 @@ namespace Enki
 		const unsigned g((color>>8)&0xff);
 		const unsigned b((color>>16)&0xff);
 		const unsigned a((color>>24)&0xff);
-		return Color(double(r)/255., double(g)/255., double(b)/255., double(a)/255.);
+		return Color(Scalar(r)/255, Scalar(g)/255, Scalar(b)/255, Scalar(a)/255);
 	}
 
 	uint32_t Color::toARGB(Color color)
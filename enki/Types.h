@@ -39,6 +39,8 @@
 #include <string>
 #include <cassert>
 #include <stdint.h> // C99 in waiting for widespread C++11 support
+#include "SmallVector.h"
+#include "Geometry.h"
 
 /*!	\file Types.h
 	\brief Basic useful types
@@ -55,10 +57,10 @@ namespace Enki
 	struct Color
 	{
 		//! RGBA values in range [0..1]
-		double components[4];
+		Scalar components[4];
 		
 		//! Constructor from separated components
-		Color(double r = 0.0, double g = 0.0, double b = 0.0, double a = 1.0)
+		Color(Scalar r = 0.0, Scalar g = 0.0, Scalar b = 0.0, Scalar a = 1.0)
 		{
 			components[0] = r;
 			components[1] = g;
@@ -67,30 +69,30 @@ namespace Enki
 		}
 		
 		//! access component i
-		const double& operator[](size_t i) const { assert(i < 4); return components[i]; }
+		const Scalar& operator[](size_t i) const { assert(i < 4); return components[i]; }
 		//! access component i
-		double& operator[](size_t i) { assert(i < 4); return components[i]; }
+		Scalar& operator[](size_t i) { assert(i < 4); return components[i]; }
 		
 		// operations with scalar
 		//! Add d to each component
-		void operator +=(double d) { for (size_t i=0; i<3; i++) components[i] += d; }
+		void operator +=(Scalar d) { for (size_t i=0; i<3; i++) components[i] += d; }
 		//! Add d to each component and return result in a new color. I'm left unchanged
-		Color operator +(double d) const { Color c; for (size_t i=0; i<3; i++) c.components[i] = components[i] + d; return c; }
+		Color operator +(Scalar d) const { Color c; for (size_t i=0; i<3; i++) c.components[i] = components[i] + d; return c; }
 		
 		//! Substract d from each component
-		void operator -=(double d) { for (size_t i=0; i<3; i++) components[i] -= d; }
+		void operator -=(Scalar d) { for (size_t i=0; i<3; i++) components[i] -= d; }
 		//! Substract d from each component and return result in a new color. I'm left unchanged
-		Color operator -(double d) const { Color c; for (size_t i=0; i<3; i++) c.components[i] = components[i] - d; return c; }
+		Color operator -(Scalar d) const { Color c; for (size_t i=0; i<3; i++) c.components[i] = components[i] - d; return c; }
 		
 		//! Multiply each component with d
-		void operator *=(double d) { for (size_t i=0; i<3; i++) components[i] *= d; }
+		void operator *=(Scalar d) { for (size_t i=0; i<3; i++) components[i] *= d; }
 		//! Multiply each component with d and return result in a new color. I'm left unchanged
-		Color operator *(double d) const { Color c; for (size_t i=0; i<3; i++) c.components[i] = components[i] * d; return c; }
+		Color operator *(Scalar d) const { Color c; for (size_t i=0; i<3; i++) c.components[i] = components[i] * d; return c; }
 		
 		//! Divide each component with d
-		void operator /=(double d) { for (size_t i=0; i<3; i++) components[i] /= d; }
+		void operator /=(Scalar d) { for (size_t i=0; i<3; i++) components[i] /= d; }
 		//! Divide each component with d and return result in a new color. I'm left unchanged
-		Color operator /(double d) const { Color c; for (size_t i=0; i<3; i++) c.components[i] = components[i] / d; return c; }
+		Color operator /(Scalar d) const { Color c; for (size_t i=0; i<3; i++) c.components[i] = components[i] / d; return c; }
 		
 		// operation with another color
 		//! Add oc's components to ours
@@ -110,34 +112,34 @@ namespace Enki
 		//! Threshold the color using limit. For each component, if value is below limit, set it to 0
 		void threshold(const Color &limit) { for (size_t i=0; i<3; i++) components[i] = components[i] > limit.components[i] ? components[i] : 0; }
 		//! Return the grey level value
-		double toGray() const { return (components[0] + components[1] + components[2]) / 3; }
+		Scalar toGray() const { return (components[0] + components[1] + components[2]) / 3; }
 		
 		//! Return a string describing this color
 		std::string toString() const { std::ostringstream oss; oss << *this; return oss.str(); }
 		
 		//! Red component value getter
-		double r() const { return components[0]; }
+		Scalar r() const { return components[0]; }
 		
 		//! Set the value of red component
-		void setR(double value) { components[0] = value; }
+		void setR(Scalar value) { components[0] = value; }
 		
 		//! Green component value getter
-		double g() const { return components[1]; }
+		Scalar g() const { return components[1]; }
 		
 		//! Set the value of green component
-		void setG(double value) { components[1] = value; }
+		void setG(Scalar value) { components[1] = value; }
 		
 		//! Blue component value getter
-		double b() const { return components[2]; }
+		Scalar b() const { return components[2]; }
 		
 		//! Set the value of blue component
-		void setB(double value) { components[2] = value; }
+		void setB(Scalar value) { components[2] = value; }
 		
 		//! Alpha component value getter
-		double a() const { return components[3]; }
+		Scalar a() const { return components[3]; }
 		
 		//! Set the value of alpha component
-		void setA(double value) { components[3] = value; }
+		void setA(Scalar value) { components[3] = value; }
 		
 		//! Build from an ARGB uint32_t (0xAARRGGBB in little endian)
 		static Color fromARGB(uint32_t color);
@@ -194,11 +196,11 @@ namespace Enki
 		friend std::ostream & operator<<(std::ostream &os, const Color& c);
 	};
 	
-	//! A texture
-	typedef std::vector<Color> Texture;
+	//! A texture, up to 4 colors are stored inline
+	typedef SmallVector<Color, 4> Texture;
 	
-	//! Textures for all sides of an object
-	typedef std::vector<Texture> Textures;
+	//! Textures for all sides of an object, up to 4 textures are stored inline
+	typedef SmallVector<Texture, 4> Textures;
 }
 
 #endif
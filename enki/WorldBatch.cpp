@@ -0,0 +1,120 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include "WorldBatch.h"
+
+/*!	\file WorldBatch.cpp
+	\brief Implementation of the batch of independent worlds
+*/
+
+namespace Enki
+{
+	WorldBatch::WorldBatch(unsigned threadCount) :
+		takeWorldOwnership(true),
+		threadPool(threadCount),
+		runningWorldCount(0),
+		nextId(0)
+	{
+	}
+	
+	WorldBatch::~WorldBatch()
+	{
+		if (takeWorldOwnership)
+			for (std::deque<PendingWorld>::iterator it = pendingWorlds.begin(); it != pendingWorlds.end(); ++it)
+				delete it->world;
+	}
+	
+	size_t WorldBatch::addWorld(World* world, unsigned stepCount)
+	{
+		std::lock_guard<std::mutex> lock(pendingMutex);
+		PendingWorld pendingWorld;
+		pendingWorld.id = nextId++;
+		pendingWorld.world = world;
+		pendingWorld.stepCount = stepCount;
+		pendingWorlds.push_back(pendingWorld);
+		pendingCondition.notify_one();
+		return pendingWorld.id;
+	}
+	
+	size_t WorldBatch::getPendingWorldCount()
+	{
+		std::lock_guard<std::mutex> lock(pendingMutex);
+		return pendingWorlds.size();
+	}
+	
+	void WorldBatch::run(double dt, unsigned physicsOversampling, const CompletionCallback& completed)
+	{
+		// every thread runs whole worlds one after the other until none is left,
+		// and waits while others run, as their completion callbacks might add worlds
+		threadPool.parallelFor(threadPool.getThreadCount(), [&](size_t index, unsigned thread) {
+			PendingWorld pendingWorld;
+			while (takePendingWorld(pendingWorld))
+			{
+				for (unsigned i = 0; i < pendingWorld.stepCount; ++i)
+					pendingWorld.world->step(dt, physicsOversampling);
+				
+				if (completed)
+				{
+					std::lock_guard<std::mutex> lock(completionMutex);
+					completed(pendingWorld.id, pendingWorld.world);
+				}
+				if (takeWorldOwnership)
+					delete pendingWorld.world;
+				completeWorld();
+			}
+		});
+	}
+	
+	bool WorldBatch::takePendingWorld(PendingWorld& pendingWorld)
+	{
+		std::unique_lock<std::mutex> lock(pendingMutex);
+		while (pendingWorlds.empty() && runningWorldCount > 0)
+			pendingCondition.wait(lock);
+		if (pendingWorlds.empty())
+			return false;
+		pendingWorld = pendingWorlds.front();
+		pendingWorlds.pop_front();
+		++runningWorldCount;
+		return true;
+	}
+	
+	void WorldBatch::completeWorld()
+	{
+		std::lock_guard<std::mutex> lock(pendingMutex);
+		--runningWorldCount;
+		// the last running world wakes up all waiting threads so that they can return
+		if (runningWorldCount == 0)
+			pendingCondition.notify_all();
+	}
+}
@@ -0,0 +1,125 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#ifndef __ENKI_WORLDBATCH_H
+#define __ENKI_WORLDBATCH_H
+
+#include "PhysicalEngine.h"
+#include "ThreadPool.h"
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/*!	\file WorldBatch.h
+	\brief A batch of independent worlds stepped in parallel
+*/
+
+namespace Enki
+{
+	//! A batch of independent worlds, each run for a given number of steps, in parallel on a thread pool
+	/*! \ingroup core
+		Every world is stepped from a single thread at a time and keeps its own random generator,
+		so its results do not depend on the other worlds or on the number of threads.
+		Worlds should not have threads of their own (see World::setThreadCount()), as the batch already uses all threads.
+		When a world has done all its steps, the completion callback is called with that world;
+		callbacks are never called concurrently and can add new worlds to the batch,
+		which allows, for instance, to evaluate the individuals of a steady-state evolutionary algorithm.
+	*/
+	class WorldBatch
+	{
+	public:
+		//! Called once a world has done all its steps, with the identifier returned by addWorld() and the world
+		typedef std::function<void(size_t id, World* world)> CompletionCallback;
+		
+		//! Whether the batch should delete the worlds once they are completed or upon destruction, true by default
+		bool takeWorldOwnership;
+		
+	protected:
+		//! A world waiting to be run
+		struct PendingWorld
+		{
+			//! Identifier returned by addWorld()
+			size_t id;
+			//! The world to run
+			World* world;
+			//! Number of steps to do
+			unsigned stepCount;
+		};
+		
+		//! Threads running the worlds
+		ThreadPool threadPool;
+		//! Protects pendingWorlds, runningWorldCount and nextId
+		std::mutex pendingMutex;
+		//! Signalled when a world is added or completed, threads without world wait on it while others run
+		std::condition_variable pendingCondition;
+		//! Worlds waiting to be run, in the order they were added
+		std::deque<PendingWorld> pendingWorlds;
+		//! Number of worlds taken by threads and not completed yet, whose completion callback might add worlds
+		unsigned runningWorldCount;
+		//! Identifier of the next added world
+		size_t nextId;
+		//! Serialises calls to the completion callback
+		std::mutex completionMutex;
+		
+	public:
+		//! Constructor, worlds will be run on threadCount threads including the calling one; 0 means one per hardware thread
+		explicit WorldBatch(unsigned threadCount = 0);
+		//! Destructor, delete pending worlds if takeWorldOwnership is true
+		~WorldBatch();
+		
+		//! Add a world that will be run for stepCount steps, return its identifier; can be called from the completion callback
+		size_t addWorld(World* world, unsigned stepCount);
+		//! Return the number of worlds waiting to be run
+		size_t getPendingWorldCount();
+		//! Return the number of threads running the worlds
+		unsigned getThreadCount() const { return threadPool.getThreadCount(); }
+		
+		//! Run all pending worlds, including the ones added while running, with timesteps of dt (see World::step()); return once all of them are completed
+		void run(double dt, unsigned physicsOversampling = 1, const CompletionCallback& completed = CompletionCallback());
+		
+	protected:
+		//! Take the next pending world, waiting for one while other worlds are running; return false once none is pending or running
+		bool takePendingWorld(PendingWorld& pendingWorld);
+		//! Mark a world taken by takePendingWorld() as completed, after its completion callback
+		void completeWorld();
+		
+	private:
+		// a batch cannot be copied
+		WorldBatch(const WorldBatch&);
+		WorldBatch& operator=(const WorldBatch&);
+	};
+}
+
+#endif
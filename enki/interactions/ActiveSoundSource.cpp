@@ -66,6 +66,22 @@ namespace Enki
 	{
 		delete[] pitch;
 	}
+	
+	void ActiveSoundSource::saveState(StateWriter& state) const
+	{
+		state.write(pitch, noOfChannels);
+		state.write(enableFlag);
+		state.write(elapsedTime);
+		state.write(activityTime);
+	}
+	
+	void ActiveSoundSource::loadState(StateReader& state)
+	{
+		state.read(pitch, noOfChannels);
+		state.read(enableFlag);
+		state.read(elapsedTime);
+		state.read(activityTime);
+	}
 
 	void ActiveSoundSource::setSoundRange(double range)
 	{
@@ -94,7 +110,7 @@ namespace Enki
 				if (channel+i < noOfChannels) pitch[channel+i] = gaussian*signal;
 			}
 			*/
-			int c = (int)channel + round(gaussianRand(0, variance));
+			int c = (int)channel + round(owner->randomStream.getGaussian(0, variance));
 			if (c < 0)
 				c = 0;
 			if (c >= noOfChannels)
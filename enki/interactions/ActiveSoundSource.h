@@ -68,6 +68,10 @@ namespace Enki
 		// Local interaction functions
 		virtual void init() {}
 		virtual void objectStep(double dt, PhysicalObject *po, World *w) {}
+		//! Save the produced sound and the activity
+		virtual void saveState(StateWriter& state) const;
+		//! Load the produced sound and the activity
+		virtual void loadState(StateReader& state);
 		
 		//! Set the range of this sound interraction
 		void setSoundRange(double range);
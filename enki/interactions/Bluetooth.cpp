@@ -321,7 +321,11 @@ namespace Enki
 				while (bb->registerClient(this,address) == false)
 					address=random.get()%UINT_MAX;
 			else
-				assert(bb->registerClient(this,address));
+			{
+				const bool registered(bb->registerClient(this,address));
+				assert(registered);
+				(void)registered;
+			}
 			updateAddress=false;
 		}
 		
@@ -353,6 +357,90 @@ namespace Enki
 		}
 	}
 	
+	void Bluetooth::saveState(StateWriter& state) const
+	{
+		state.write(maxConnections);
+		state.write(rxBufferSize);
+		state.write(txBufferSize);
+		state.write(nbConnections);
+		state.write(address);
+		state.write(updateAddress);
+		state.write(randomAddress);
+		for (unsigned i=0;i<maxConnections;++i)
+		{
+			state.write(rxBuffer[i], rxBufferSize);
+			state.write(txBuffer[i], txBufferSize);
+		}
+		state.write(receptionFlags, maxConnections);
+		state.write(destAddress, maxConnections);
+		state.write(sizeToSend, maxConnections);
+		state.write(sizeReceived, maxConnections);
+		state.write(transmissionError, maxConnections);
+		state.write(connectionError);
+		state.write(disconnectionError);
+		
+		// queues are saved as vectors, front first
+		std::queue<unsigned> requests(connectToRobot);
+		std::vector<unsigned> connectRequests;
+		for (;!requests.empty();requests.pop())
+			connectRequests.push_back(requests.front());
+		state.write(connectRequests);
+		requests=closeConnectionToRobot;
+		std::vector<unsigned> closeRequests;
+		for (;!requests.empty();requests.pop())
+			closeRequests.push_back(requests.front());
+		state.write(closeRequests);
+	}
+	
+	void Bluetooth::loadState(StateReader& state)
+	{
+		unsigned savedMaxConnections, savedRxBufferSize, savedTxBufferSize;
+		state.read(savedMaxConnections);
+		state.read(savedRxBufferSize);
+		state.read(savedTxBufferSize);
+		if (savedMaxConnections!=maxConnections || savedRxBufferSize!=rxBufferSize || savedTxBufferSize!=txBufferSize)
+		{
+			cancelAllData();
+			maxConnections=savedMaxConnections;
+			rxBufferSize=savedRxBufferSize;
+			txBufferSize=savedTxBufferSize;
+			initAllData();
+		}
+		state.read(nbConnections);
+		state.read(address);
+		state.read(updateAddress);
+		state.read(randomAddress);
+		for (unsigned i=0;i<maxConnections;++i)
+		{
+			state.read(rxBuffer[i], rxBufferSize);
+			state.read(txBuffer[i], txBufferSize);
+		}
+		state.read(receptionFlags, maxConnections);
+		state.read(destAddress, maxConnections);
+		state.read(sizeToSend, maxConnections);
+		state.read(sizeReceived, maxConnections);
+		state.read(transmissionError, maxConnections);
+		state.read(connectionError);
+		state.read(disconnectionError);
+		
+		std::vector<unsigned> requests;
+		state.read(requests);
+		connectToRobot=std::queue<unsigned>();
+		for (size_t i=0;i<requests.size();++i)
+			connectToRobot.push(requests[i]);
+		state.read(requests);
+		closeConnectionToRobot=std::queue<unsigned>();
+		for (size_t i=0;i<requests.size();++i)
+			closeConnectionToRobot.push(requests[i]);
+		
+		// the base of the world might not know this module any more, so register again at the same address
+		if (!updateAddress)
+		{
+			updateAddress=true;
+			randomAddress=false;
+		}
+	}
+	
 	unsigned Bluetooth::getConnectionError()
 	{
 		return (unsigned)connectionError;
@@ -131,6 +131,10 @@ public:
 		
 		//! On every timestep, send the commands recorded to the bluetooth Base to be executed
 		virtual void step(double dt, World *w);
+		//! Save the connections, the buffers and the pending requests of the module
+		virtual void saveState(StateWriter& state) const;
+		//! Load the connections, the buffers and the pending requests of the module; if it was registered, it registers again at the same address in the next step
+		virtual void loadState(StateReader& state);
 		
 		//! Change the address of the module
 		void setAddress(unsigned address);
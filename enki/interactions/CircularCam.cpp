@@ -46,7 +46,7 @@ namespace Enki
 	struct DepthTest : public PixelOperationFunctor
 	{
 		//! If objectDist2 < zBuffer2, then pixelBuffer = objectColor and zBuffer2 = objectDist2
-		virtual void operator()(double &zBuffer2, Color &pixelBuffer, const double &objectDist2, const Color &objectColor)
+		virtual void operator()(Scalar &zBuffer2, Color &pixelBuffer, const Scalar &objectDist2, const Color &objectColor)
 		{
 			if (objectDist2 < zBuffer2)
 			{
@@ -83,18 +83,17 @@ namespace Enki
 		
 		if (!po->isCylindric())
 		{
-			// object has a hull
-			for (PhysicalObject::Hull::const_iterator it = po->getHull().begin(); it != po->getHull().end(); ++it)
-			{
-				if (height > it->getHeight())
-					continue;
+			// object has a hull, draw its parts that might be in the field of view, as the whole object is drawn if it is in range
+			po->visitParts([this](const Point& bottomLeft, const Point& topRight) { return isBoxInFieldOfView(bottomLeft, topRight); }, [this, po](const PhysicalObject::Part& part) {
+				if (height > part.getHeight())
+					return;
 				
-				const Polygon& shape = it->getTransformedShape();
+				const Polygon& shape = part.getTransformedShape();
 				const size_t faceCount = shape.size();
-				if (it->isTextured())
+				if (part.isTextured())
 				{
 					for (size_t i = 0; i<faceCount; i++)
-						drawTexturedLine(shape[i], shape[(i+1) % faceCount], it->getTextures()[i]);
+						drawTexturedLine(shape[i], shape[(i+1) % faceCount], part.getTextures()[i]);
 				}
 				else
 				{
@@ -102,7 +101,7 @@ namespace Enki
 					for (size_t i = 0; i<faceCount; i++)
 						drawTexturedLine(shape[i], shape[(i+1) % faceCount], texture);
 				}
-			}
+			});
 		}
 		else
 		{
@@ -288,18 +287,36 @@ namespace Enki
 
 	void CircularCam::init(double dt, World* w)
 	{
-		// compute absolute position and orientation
-		const Matrix22 rot(owner->angle);
-		absPos = owner->pos + rot * positionOffset;
+		// absolute position and orientation, from the rotation cached by the owner as the offsets can change at any time
+		absPos = owner->pos + owner->getRotation() * positionOffset;
 		absOrientation = owner->angle + angleOffset;
 		
 		// fill zbuffer with infinite
-		std::fill( &zbuffer[0], &zbuffer[zbuffer.size()], std::numeric_limits<double>::max() );
+		std::fill( &zbuffer[0], &zbuffer[zbuffer.size()], std::numeric_limits<Scalar>::max() );
 		std::fill( &image[0], &image[image.size()], w->color);
 	}
 	
 	void CircularCam::wallsStep(double dt, World* w)
 	{
+		// static geometry in range and in the field of view
+		w->staticGeometry.visit([this](const Point& bottomLeft, const Point& topRight) {
+			return isBoxVisible(bottomLeft, topRight);
+		}, [this](const StaticGeometry::Element& element) {
+			if (height > element.height)
+				return;
+			// only draw the faces turned towards the camera, which is on their right as shapes are counter-clockwise
+			const Texture texture(1, element.color);
+			const Polygon& shape(element.shape);
+			const size_t faceCount(shape.size());
+			for (size_t i = 0; i < faceCount; ++i)
+			{
+				const Point& p0(shape[i]);
+				const Point& p1(shape[(i + 1) % faceCount]);
+				if ((p1 - p0).cross(absPos - p0) < 0)
+					drawTexturedLine(p0, p1, texture);
+			}
+		});
+		
 		Texture texture(1, w->color);
 		
 		switch (w->wallsType)
@@ -346,6 +363,38 @@ namespace Enki
 			drawTexturedLine(Point(0, w->h), Point(0, 0), w->wallTextures[3]);*/
 	}
 	
+	bool CircularCam::isBoxVisible(const Point& bottomLeft, const Point& topRight) const
+	{
+		// out of range
+		const Vector toBox(
+			std::max(std::max(bottomLeft.x - absPos.x, absPos.x - topRight.x), Scalar(0)),
+			std::max(std::max(bottomLeft.y - absPos.y, absPos.y - topRight.y), Scalar(0))
+		);
+		if (toBox.norm2() > r * r)
+			return false;
+		return isBoxInFieldOfView(bottomLeft, topRight);
+	}
+	
+	bool CircularCam::isBoxInFieldOfView(const Point& bottomLeft, const Point& topRight) const
+	{
+		// the camera is in the box
+		if (absPos.x >= bottomLeft.x && absPos.x <= topRight.x && absPos.y >= bottomLeft.y && absPos.y <= topRight.y)
+			return true;
+		
+		// the box covers less than half a turn, so its angles relative to its center are within [-pi/2, pi/2], as is the field of view
+		const Point corners[4] = { bottomLeft, Point(topRight.x, bottomLeft.y), topRight, Point(bottomLeft.x, topRight.y) };
+		const double centerAngle(((bottomLeft + topRight) / 2 - absPos).angle());
+		double minAngle(M_PI), maxAngle(-M_PI);
+		for (size_t i = 0; i < 4; ++i)
+		{
+			const double angle(normalizeAngle((corners[i] - absPos).angle() - centerAngle));
+			minAngle = std::min(minAngle, angle);
+			maxAngle = std::max(maxAngle, angle);
+		}
+		const double offset(normalizeAngle(centerAngle - absOrientation));
+		return offset + maxAngle >= -halfFieldOfView && offset + minAngle <= halfFieldOfView;
+	}
+	
 	void CircularCam::finalize(double dt, World* w)
 	{
 		if (useFog)
@@ -358,6 +407,22 @@ namespace Enki
 		}
 	}
 	
+	void CircularCam::saveState(StateWriter& state) const
+	{
+		state.write(absPos);
+		state.write(absOrientation);
+		state.write(zbuffer);
+		state.write(image);
+	}
+	
+	void CircularCam::loadState(StateReader& state)
+	{
+		state.read(absPos);
+		state.read(absOrientation);
+		state.read(zbuffer);
+		state.read(image);
+	}
+	
 	void CircularCam::setRange(double range)
 	{
 		this->r = range;
@@ -405,6 +470,22 @@ namespace Enki
 		std::copy(&cam1.image[0], &cam1.image[camPixelCount], &image[camPixelCount]);
 	}
 	
+	void OmniCam::saveState(StateWriter& state) const
+	{
+		state.write(zbuffer);
+		state.write(image);
+		cam0.saveState(state);
+		cam1.saveState(state);
+	}
+	
+	void OmniCam::loadState(StateReader& state)
+	{
+		state.read(zbuffer);
+		state.read(image);
+		cam0.loadState(state);
+		cam1.loadState(state);
+	}
+	
 	void OmniCam::setRange(double range)
 	{
 		this->r = range;
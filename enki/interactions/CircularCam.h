@@ -54,7 +54,7 @@ namespace Enki
 		//! Virtual destructor, do nothing
 		virtual ~PixelOperationFunctor() { }
 		//! Modify the pixel and depth buffer² for a given object color and distance²
-		virtual void operator()(double &zBuffer2, Color &pixelBuffer, const double &objectDist2, const Color &objectColor) = 0;
+		virtual void operator()(Scalar &zBuffer2, Color &pixelBuffer, const Scalar &objectDist2, const Color &objectColor) = 0;
 	};
 	
 	
@@ -77,8 +77,8 @@ namespace Enki
 		double absOrientation;
 
 	public:
-		//! zbuffer: distances at square (array of size pixelCount of double)
-		std::valarray<double> zbuffer;
+		//! zbuffer: distances at square (array of size pixelCount of Scalar)
+		std::valarray<Scalar> zbuffer;
 		//! Image (array of size pixelCount of Color)
 		std::valarray<Color> image;
 		//! Field of view = [-halfFieldOfView; + halfFieldOfView]. [0; PI/2]
@@ -113,6 +113,10 @@ namespace Enki
 		virtual void objectStep(double dt, World *w, PhysicalObject *po);
 		virtual void wallsStep(double dt, World* w);
 		virtual void finalize(double dt, World* w);
+		//! Save the absolute position and the buffers
+		virtual void saveState(StateWriter& state) const;
+		//! Load the absolute position and the buffers
+		virtual void loadState(StateReader& state);
 		
 		//! Change the sight range of the camera
 		void setRange(double range);
@@ -126,6 +130,10 @@ namespace Enki
 		double interpolateLinear(double s0, double s1, double sv, double d0, double d1);
 		//! Draw a textured line from point p0 to p1 using texture - WTF are p0 and p1??
 		void drawTexturedLine(const Point &p0, const Point &p1, const Texture &texture);
+		//! Return whether a part of the axis-aligned box from bottomLeft to topRight might be in range and in the field of view
+		bool isBoxVisible(const Point& bottomLeft, const Point& topRight) const;
+		//! Return whether a part of the axis-aligned box from bottomLeft to topRight might be in the field of view, whatever its distance
+		bool isBoxInFieldOfView(const Point& bottomLeft, const Point& topRight) const;
 	};
 	
 	
@@ -135,8 +143,8 @@ namespace Enki
 	class OmniCam : public LocalInteraction
 	{
 	public:
-		//! zbuffer: distances at square (array of size pixelCount of double)
-		std::valarray<double> zbuffer;
+		//! zbuffer: distances at square (array of size pixelCount of Scalar)
+		std::valarray<Scalar> zbuffer;
 		//! Image (array of size pixelCount of Color)
 		std::valarray<Color> image;
 		
@@ -160,6 +168,10 @@ namespace Enki
 		virtual void objectStep(double dt, World *w, PhysicalObject *po);
 		virtual void wallsStep(double dt, World* w);
 		virtual void finalize(double dt, World* w);
+		//! Save the buffers of this camera and of the two cameras doing the real job
+		virtual void saveState(StateWriter& state) const;
+		//! Load the buffers of this camera and of the two cameras doing the real job
+		virtual void loadState(StateReader& state);
 		//! Change the sight range of the camera
 		void setRange(double range);
 		//! Change the fog condition for this camera. If useFog is true, an exponential fog with density will be used. Additionally, a threshold can be applied on the resulting color
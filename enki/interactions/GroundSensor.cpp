@@ -51,6 +51,7 @@ namespace Enki
 	{
 		assert(owner);
 		this->owner = owner;
+		mount = owner->addMount(pos);
 		// compute kernel up to a constant factor
 		const double var(spatialSd * spatialSd);
 		double sum(0);
@@ -81,9 +82,8 @@ namespace Enki
 	
 	void GroundSensor::init(double dt, World* w)
 	{
-		// compute absolute position
-		const Matrix22 rot(owner->angle);
-		absPos = owner->pos + rot * pos;
+		// absolute position, computed by the owner for all its sensors
+		absPos = owner->getMountPos(mount);
 		
 		// compute sensor value on a gaussian filtered ground
 		double v(0);
@@ -99,6 +99,18 @@ namespace Enki
 		}
 		
 		// changing value to response space and adding Gaussian noise before returning value
-		finalValue = gaussianRand(_sigm(v - cFactor, sFactor) * mFactor + aFactor, noiseSd);
+		finalValue = owner->randomStream.getGaussian(_sigm(v - cFactor, sFactor) * mFactor + aFactor, noiseSd);
+	}
+	
+	void GroundSensor::saveState(StateWriter& state) const
+	{
+		state.write(absPos);
+		state.write(finalValue);
+	}
+	
+	void GroundSensor::loadState(StateReader& state)
+	{
+		state.read(absPos);
+		state.read(finalValue);
 	}
 }
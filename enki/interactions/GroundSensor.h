@@ -66,6 +66,8 @@ namespace Enki
 		Vector absPos;
 		//! Relative position on the robot
 		const Vector pos;
+		//! Index of the mount of this sensor on the robot, which gives its absolute position
+		size_t mount;
 		//! Center of the sigmoid
 		const double cFactor;
 		//! Multiplication factor for the argument of the sigmoid
@@ -99,6 +101,10 @@ namespace Enki
 		GroundSensor(Robot *owner, Vector pos, double cFactor, double sFactor, double mFactor, double aFactor, double spatialSd = 0.4, double noiseSd = 0.);
 		//! Compute absolute position
 		void init(double dt, World* w);
+		//! Save the absolute position and the final value
+		virtual void saveState(StateWriter& state) const;
+		//! Load the absolute position and the final value
+		virtual void loadState(StateReader& state);
 		
 		//! Reset intensity value
 		//! Return the final sensor value
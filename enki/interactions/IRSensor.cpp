@@ -61,6 +61,7 @@ namespace Enki
 	{
 		assert(owner);
 		this->owner = owner;
+		mount = owner->addMount(pos, orientation);
 		// must be strictly positive to avoid division by zero and negative numbers in response function
 		assert(c-x0*x0 > 0);
 		// maximum must be positive
@@ -90,10 +91,10 @@ namespace Enki
 		std::fill(rayDists.begin(), rayDists.end(), range);
 		std::fill(rayValues.begin(), rayValues.end(), 0);
 
-		// compute absolute position and orientation
-		const Matrix22 rot(owner->angle);
-		absPos = owner->pos + rot * pos;
-		absOrientation = owner->angle + orientation;
+		// absolute position and orientation, computed by the owner for all its sensors
+		const Matrix22& rot(owner->getRotation());
+		absPos = owner->getMountPos(mount);
+		absOrientation = owner->getMountAngle(mount);
 		// compute correct absolute angles
 		for (size_t i = 0; i<rayCount; i++)
 			absRayAngles[i] = absOrientation + rayAngles[i];
@@ -149,36 +150,31 @@ namespace Enki
 		}
 		else
 		{
-			// Calculate distance for each ray...
-			for (size_t i = 0; i<rayCount; i++)
-			{
-				double dist = HUGE_VAL;
-				// angle between sensor ray and v1
-				const double myAngle = absRayAngles[i] - v1.angle();
-				const double sine = sin(myAngle);
-				// normal distance of bounding circle center to sensor ray
-				const double distsc2 = v1.norm2() * (sine * sine);
+			// only parts whose bounding box and circle overlap the circle enclosing all rays can be hit
+			const Vector smartExtent(smartRadius, smartRadius);
+			po->visitOverlappingParts(absSmartPos - smartExtent, absSmartPos + smartExtent, [this](const PhysicalObject::Part& part) {
+				const double reach(part.getBoundingRadius() + smartRadius);
+				if (height > part.getHeight() || (part.getTransformedCentroid() - absSmartPos).norm2() > reach * reach)
+					return;
 				
-				// if there is an intersection with the object's bounding circle
-				if (distsc2 < r2)
-				{
-					// iterate over all shapes
-					for (PhysicalObject::Hull::const_iterator it = po->getHull().begin(); it != po->getHull().end(); ++it)
-					{
-						if (height > it->getHeight())
-							continue;
-						
-						// check intersection with polygon
-						dist = distanceToPolygon(absRayAngles[i], it->getTransformedShape());
-						updateRay(i, dist);
-					}
-				}
-			}
+				// check intersection of each ray with polygon
+				for (size_t i = 0; i<rayCount; i++)
+					updateRay(i, distanceToPolygon(absRayAngles[i], part.getTransformedShape()));
+			});
 		}
 	}
 
 	void IRSensor::wallsStep (double dt, World* w)
 	{
+		// static geometry within the circle enclosing all rays
+		const Vector smartExtent(smartRadius, smartRadius);
+		w->staticGeometry.visitOverlapping(absSmartPos - smartExtent, absSmartPos + smartExtent, [this](const StaticGeometry::Element& element) {
+			if (height > element.height)
+				return;
+			for (size_t i = 0; i < rayCount; i++)
+				updateRay(i, distanceToPolygon(absRayAngles[i], element.shape));
+		});
+		
 		switch (w->wallsType)
 		{
 			case World::WALLS_SQUARE:
@@ -261,10 +257,34 @@ namespace Enki
 	void IRSensor::finalize(double dt, World* w)
 	{
 		finalValue = rayValues[0] + rayValues[1] + rayValues[2];
-		finalValue = std::max(0., std::min(m, gaussianRand(finalValue, noiseSd)));
+		finalValue = std::max(0., std::min(m, owner->randomStream.getGaussian(finalValue, noiseSd)));
 		finalDist = inverseResponseFunction(finalValue);
 	}
 	
+	void IRSensor::saveState(StateWriter& state) const
+	{
+		state.write(absPos);
+		state.write(absOrientation);
+		state.write(absSmartPos);
+		state.write(rayDists);
+		state.write(rayValues);
+		state.write(absRayAngles);
+		state.write(finalValue);
+		state.write(finalDist);
+	}
+	
+	void IRSensor::loadState(StateReader& state)
+	{
+		state.read(absPos);
+		state.read(absOrientation);
+		state.read(absSmartPos);
+		state.read(rayDists);
+		state.read(rayValues);
+		state.read(absRayAngles);
+		state.read(finalValue);
+		state.read(finalDist);
+	}
+	
 	void IRSensor::updateRay(size_t i, double dist)
 	{
 		// if we have a smaller distance than the initial one, replace it
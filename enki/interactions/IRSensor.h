@@ -96,6 +96,8 @@ namespace Enki
 		const double height;
 		//! Relative orientation on the robot
 		const double orientation;
+		//! Index of the mount of this sensor on the robot, which gives its absolute pose
+		size_t mount;
 		//! Actual detection range
 		const double range;
 		//! Aperture angle
@@ -155,6 +157,10 @@ namespace Enki
 		void wallsStep(double dt, World* w);
 		//! Applies the SensorResponseFunction to each ray and combines all rays using weights defined in the rayCombinationKernel.
 		void finalize(double dt, World* w);
+		//! Save the absolute position, the rays and the final values
+		virtual void saveState(StateWriter& state) const;
+		//! Load the absolute position, the rays and the final values
+		virtual void loadState(StateReader& state);
 		
 		//! Return the final sensor value
 		double getValue(void) const { return finalValue; }
@@ -56,6 +56,7 @@ namespace Enki
 		for (size_t i=0; i<noOfChannels; i++)
 			acquiredSound[i] = 0.0;
 
+		mount = owner->addMount(micRelPos);
 		Matrix22 rot(owner->angle);
 		micAbsPos = owner->pos + rot*micRelPos;
 	}
@@ -67,8 +68,7 @@ namespace Enki
 	
 	void Microphone::init()
 	{
-		Matrix22 rot(owner->angle);
-		micAbsPos = owner->pos + rot*micRelPos;
+		micAbsPos = owner->getMountPos(mount);
 		resetSound();
 	}
 
@@ -123,6 +123,18 @@ namespace Enki
 		for (size_t i=0; i<noOfChannels; i++) acquiredSound[i] = 0.0;
 	}
 
+	void Microphone::saveState(StateWriter& state) const
+	{
+		state.write(micAbsPos);
+		state.write(acquiredSound, noOfChannels);
+	}
+
+	void Microphone::loadState(StateReader& state)
+	{
+		state.read(micAbsPos);
+		state.read(acquiredSound, noOfChannels);
+	}
+
 	void Microphone::getMaxChannel(double *intensity, int *channel)
 	{
 		*intensity = 0;
@@ -157,6 +169,10 @@ namespace Enki
 				acquiredSound[i][j] = 0.0;
 		}
 
+		firstMount = owner->addMount(Vector( micDist, micDist));
+		owner->addMount(Vector( micDist,-micDist));
+		owner->addMount(Vector(-micDist, micDist));
+		owner->addMount(Vector(-micDist,-micDist));
 		Matrix22 rot(owner->angle);
 		allMicAbsPos[0] = owner->pos + rot*Vector( micDist, micDist);
 		allMicAbsPos[1] = owner->pos + rot*Vector( micDist,-micDist);
@@ -172,11 +188,8 @@ namespace Enki
 		
 	void FourWayMic::init()
 	{
-		Matrix22 rot(owner->angle);
-		allMicAbsPos[0] = owner->pos + rot*Vector( micDist, micDist);
-		allMicAbsPos[1] = owner->pos + rot*Vector( micDist,-micDist);
-		allMicAbsPos[2] = owner->pos + rot*Vector(-micDist, micDist);
-		allMicAbsPos[3] = owner->pos + rot*Vector(-micDist,-micDist);
+		for (size_t i=0; i<4; i++)
+			allMicAbsPos[i] = owner->getMountPos(firstMount + i);
 		resetSound();
 	}
 
@@ -238,6 +251,20 @@ namespace Enki
 				acquiredSound[i][j] = 0.0;
 	}
 
+	void FourWayMic::saveState(StateWriter& state) const
+	{
+		state.write(allMicAbsPos, 4);
+		for (size_t i=0; i<4; i++)
+			state.write(acquiredSound[i], noOfChannels);
+	}
+
+	void FourWayMic::loadState(StateReader& state)
+	{
+		state.read(allMicAbsPos, 4);
+		for (size_t i=0; i<4; i++)
+			state.read(acquiredSound[i], noOfChannels);
+	}
+
 	void FourWayMic::getMaxChannel(unsigned micNo, double *intensity, int *channel)
 	{
 		*intensity = 0;
@@ -55,11 +55,13 @@ namespace Enki
 	{
 	protected:
 		//! Robot/object with the microphone
-		PhysicalObject *owner;
+		Robot *owner;
 		//! Absolute position in the world, updated on init()
 		Vector micAbsPos;
 		//! Relative position of mic on object
 		Vector micRelPos;
+		//! Index of the mount of the mic on the robot, which gives its absolute position
+		size_t mount;
 		//! Microphone frequency response model
 		MicrophoneResponseModel micModel;
 		//! Actual detection range
@@ -84,6 +86,10 @@ namespace Enki
 		virtual void objectStep(double dt, PhysicalObject *po, World *w);
 		//! Reset sound buffer to 0 after one time-step in experiment
 		void resetSound(void);
+		//! Save the absolute position and the acquired sound
+		virtual void saveState(StateWriter& state) const;
+		//! Load the absolute position and the acquired sound
+		virtual void loadState(StateReader& state);
 		//! Return frequencies of input sound
 		double* getAcquiredSound(void);
 		//! Find frequency with maximum intensity
@@ -98,11 +104,13 @@ namespace Enki
 	{
 	protected:
 		//! Robot/object with the microphone
-		PhysicalObject *owner;
+		Robot *owner;
 		//! Absolute position in the world, updated on init()
 		Vector allMicAbsPos[4];
 		//! Distance of the mics from centre of object
 		double micDist;
+		//! Index of the mount of the first mic on the robot, the other ones follow
+		size_t firstMount;
 		//! Microphone frequency response model
 		MicrophoneResponseModel micModel;
 		//! Actual detection range
@@ -127,6 +135,10 @@ namespace Enki
 		virtual void objectStep(double dt, PhysicalObject *po, World *w);
 		//! Reset sound buffer to 0 after one time-step in experiment
 		void resetSound(void);
+		//! Save the absolute positions and the acquired sound of the 4 mics
+		virtual void saveState(StateWriter& state) const;
+		//! Load the absolute positions and the acquired sound of the 4 mics
+		virtual void loadState(StateReader& state);
 		//! Return frequencies of input sound
 		double* getAcquiredSound(unsigned micNo);
 		//! Find frequency with maximum intensity
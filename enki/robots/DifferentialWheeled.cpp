@@ -73,11 +73,11 @@ namespace Enki
 		const double noiseFactor = 2 * noiseAmount;
 		
 		const double realLeftSpeed = clamp(
-			leftSpeed * (baseFactor + random.getRange(noiseFactor)),
+			leftSpeed * (baseFactor + randomStream.getRange(noiseFactor)),
 			-maxSpeed,maxSpeed
 		);
 		const double realRightSpeed = clamp(
-			rightSpeed * (baseFactor + random.getRange(noiseFactor)),
+			rightSpeed * (baseFactor + randomStream.getRange(noiseFactor)),
 			-maxSpeed, maxSpeed
 		);
 		
@@ -85,6 +85,10 @@ namespace Enki
 		cmdSpeed = (realLeftSpeed + realRightSpeed) * 0.5;
 		cmdAngSpeed = (realRightSpeed - realLeftSpeed) / distBetweenWheels;
 		
+		// a robot that is commanded to move cannot sleep
+		if (cmdSpeed != 0 || cmdAngSpeed != 0)
+			wakeUp();
+		
 		// Compute encoders
 		leftEncoder = realLeftSpeed;
 		rightEncoder = realRightSpeed;
@@ -104,5 +108,45 @@ namespace Enki
 		angSpeed = cmdAngSpeed;
 		speed = cmdVelocity;
 	}
+	
+	bool DifferentialWheeled::canSleep() const
+	{
+		return true;
+	}
+	
+	void DifferentialWheeled::saveState(StateWriter& state) const
+	{
+		Robot::saveState(state);
+		state.write(leftSpeed);
+		state.write(rightSpeed);
+		state.write(leftEncoder);
+		state.write(rightEncoder);
+		state.write(leftOdometry);
+		state.write(rightOdometry);
+		state.write(cmdAngSpeed);
+		state.write(cmdSpeed);
+	}
+	
+	void DifferentialWheeled::loadState(StateReader& state)
+	{
+		Robot::loadState(state);
+		state.read(leftSpeed);
+		state.read(rightSpeed);
+		state.read(leftEncoder);
+		state.read(rightEncoder);
+		state.read(leftOdometry);
+		state.read(rightOdometry);
+		state.read(cmdAngSpeed);
+		state.read(cmdSpeed);
+	}
+	
+	PhysicalObject* DifferentialWheeled::clone() const
+	{
+		if (typeid(*this) != typeid(DifferentialWheeled))
+			return 0;
+		DifferentialWheeled* copy(new DifferentialWheeled(distBetweenWheels, maxSpeed, noiseAmount));
+		copy->copyStateFrom(*this);
+		return copy;
+	}
 }
 
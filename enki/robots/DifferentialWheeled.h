@@ -84,6 +84,15 @@ namespace Enki
 		virtual void controlStep(double dt);
 		//! Consider that robot wheels have immobile contact points with ground, and override speeds. This kills three objects dynamics, but is good enough for the type of simulation Enki covers (and the correct solution is immensely more complex)
 		virtual void applyForces(double dt);
+		//! Return true, as controlStep() wakes the robot up whenever its wheels are commanded to move.
+		//! Subclasses that override applyForces(), or controlStep() without calling this one, must return false unless they call wakeUp() whenever they might move.
+		virtual bool canSleep() const;
+		//! Save the state of the object and of the interactions, then the wheels speeds, commands, encoders and odometry
+		virtual void saveState(StateWriter& state) const;
+		//! Load the state of the object and of the interactions, then the wheels speeds, commands, encoders and odometry
+		virtual void loadState(StateReader& state);
+		//! Return a copy of this robot if it is of class DifferentialWheeled, 0 otherwise
+		virtual PhysicalObject* clone() const;
 	};
 }
 
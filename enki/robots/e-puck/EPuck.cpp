@@ -35,6 +35,7 @@
 #include <algorithm>
 #include <functional>
 #include <climits>
+#include <typeinfo>
 
 /*! \file EPuck.cpp
 \brief Implementation of the E-Puck robot
@@ -75,6 +76,18 @@ namespace Enki
 		}
 	}
 	
+	void EPuckScannerTurret::saveState(StateWriter& state) const
+	{
+		OmniCam::saveState(state);
+		state.write(scan);
+	}
+	
+	void EPuckScannerTurret::loadState(StateReader& state)
+	{
+		OmniCam::loadState(state);
+		state.read(scan);
+	}
+	
 	
 	#define deg2rad(x) ((x)*M_PI/180.)
 	
@@ -91,7 +104,8 @@ namespace Enki
 		infraredSensor7(this, Vector(3.35, 1.05),   2.5, deg2rad(18),  12, 3731, 0.3, 0.7, 10),
 		camera(this, Vector(3.7, 0.0), 2.2, 0.0, M_PI/6.0, 60),
 		scannerTurret(this, 7.2, 32),
-		bluetooth(NULL)
+		bluetooth(NULL),
+		capabilities(capabilities)
 	{
 		if (capabilities & CAPABILITY_BASIC_SENSORS)
 		{
@@ -139,5 +153,14 @@ namespace Enki
 	{
 		setColor(status ? Color::red : Color(0, 0.7, 0));
 	}
+	
+	PhysicalObject* EPuck::clone() const
+	{
+		if (typeid(*this) != typeid(EPuck))
+			return 0;
+		EPuck* copy(new EPuck(capabilities));
+		copy->copyStateFrom(*this);
+		return copy;
+	}
 }
 
@@ -63,6 +63,10 @@ namespace Enki
 		EPuckScannerTurret(Robot *owner, double height, unsigned halfPixelCount);
 		
 		virtual void finalize(double dt, World* w);
+		//! Save the buffers of the camera, then the scan
+		virtual void saveState(StateWriter& state) const;
+		//! Load the buffers of the camera, then the scan
+		virtual void loadState(StateReader& state);
 	
 	public:
 		std::valarray<double> scan;
@@ -120,6 +124,13 @@ namespace Enki
 		
 		//! Set ring color (true = red, false = black) 
 		void setLedRing(bool status);
+		
+		//! Return a copy of this robot if it is of class EPuck, 0 otherwise
+		virtual PhysicalObject* clone() const;
+		
+	protected:
+		//! The capabilities this robot was created with
+		const unsigned capabilities;
 	};
 }
 
@@ -32,6 +32,7 @@
 */
 
 #include "Khepera.h"
+#include <typeinfo>
 
 /*! \file Khepera.cpp
 	\brief Implementation of the Khepera robot
@@ -48,7 +49,8 @@ namespace Enki
 		infraredSensor5(this, Vector(1.0, -1.5), 1.8, -M_PI/2,10, 1200, -0.9, 7, 20),
 		infraredSensor6(this, Vector(-1.5, -1.0),1.8, -M_PI,  10, 1200, -0.9, 7, 20),
 		infraredSensor7(this, Vector(-1.5, 1.0), 1.8, -M_PI,  10, 1200, -0.9, 7, 20),
-		camera(this, Vector(0, 0), 0, 0.0, M_PI/4, 50)
+		camera(this, Vector(0, 0), 0, 0.0, M_PI/4, 50),
+		capabilities(capabilities)
 	{
 		if (capabilities & CAPABILITIY_BASIC_SENSORS)
 		{
@@ -69,5 +71,14 @@ namespace Enki
 		
 		setCylindric(2.6, 5, 80);
 	}
+	
+	PhysicalObject* Khepera::clone() const
+	{
+		if (typeid(*this) != typeid(Khepera))
+			return 0;
+		Khepera* copy(new Khepera(capabilities));
+		copy->copyStateFrom(*this);
+		return copy;
+	}
 }
 
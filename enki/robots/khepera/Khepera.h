@@ -83,6 +83,13 @@ namespace Enki
 	public:
 		//! Create a Khepera with certain modules aka capabilities (basic)
 		Khepera(unsigned capabilities = CAPABILITIY_BASIC_SENSORS);
+		
+		//! Return a copy of this robot if it is of class Khepera, 0 otherwise
+		virtual PhysicalObject* clone() const;
+		
+	protected:
+		//! The capabilities this robot was created with
+		const unsigned capabilities;
 	};
 }
 
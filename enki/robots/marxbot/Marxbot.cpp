@@ -33,6 +33,7 @@
 
 #include "enki/robots/marxbot/Marxbot.h"
 #include <cassert>
+#include <typeinfo>
 
 /*!	\file Marxbot.cpp
 	\brief Implementation of the marXbot robot
@@ -43,7 +44,7 @@ namespace Enki
 	// TODO: use similar function as for distance sensors
 	// if we were to use IRSensors, the parameters would be
 	// around m=3000, x0=0.2, c=1
-	double marxbotVirtualBumperResponseFunction(double dist)
+	double marxbotVirtualBumperResponseFunction(double dist, CounterRandom& random)
 	{
 		if (dist<0.5)
 			dist = -440*dist+3000;
@@ -71,7 +72,16 @@ namespace Enki
 	{
 		assert(number < 24);
 		unsigned physicalNumber = (24 + 12 - number) % 24;
-		return marxbotVirtualBumperResponseFunction(sqrt(rotatingDistanceSensor.zbuffer[(physicalNumber * 180) / 24]) - getRadius());
+		return marxbotVirtualBumperResponseFunction(sqrt(rotatingDistanceSensor.zbuffer[(physicalNumber * 180) / 24]) - getRadius(), randomStream);
+	}
+	
+	PhysicalObject* Marxbot::clone() const
+	{
+		if (typeid(*this) != typeid(Marxbot))
+			return 0;
+		Marxbot* copy(new Marxbot);
+		copy->copyStateFrom(*this);
+		return copy;
 	}
 }
 
@@ -63,6 +63,8 @@ namespace Enki
 		~Marxbot() {}
 		//! Return the value of a virtual bumper
 		double getVirtualBumper(unsigned number);
+		//! Return a copy of this robot if it is of class Marxbot, 0 otherwise
+		virtual PhysicalObject* clone() const;
 	};
 
 }
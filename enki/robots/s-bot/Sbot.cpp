@@ -32,6 +32,7 @@
 */
 
 #include "enki/robots/s-bot/Sbot.h"
+#include <typeinfo>
 
 /*!	\file Sbot.cpp
 	\brief Implementation of the Sbot robot
@@ -115,16 +116,36 @@ namespace Enki
 		globalSound(this)
 	{
 		addLocalInteraction(&camera);
-		//addGlobalInteraction(&globalSound);
+		addGlobalInteraction(&globalSound);
 		
 		setCylindric(6, 15, 500);
 	}
 	
-	unsigned SbotGlobalSound::worldFrequenciesState = 0;
+	void Sbot::saveState(StateWriter& state) const
+	{
+		DifferentialWheeled::saveState(state);
+		state.write(globalSound.frequenciesState);
+	}
+	
+	void Sbot::loadState(StateReader& state)
+	{
+		DifferentialWheeled::loadState(state);
+		state.read(globalSound.frequenciesState);
+	}
 	
-	unsigned SbotGlobalSound::getWorldFrequenciesState(void)
+	PhysicalObject* Sbot::clone() const
 	{
-		return worldFrequenciesState;
+		if (typeid(*this) != typeid(Sbot))
+			return 0;
+		Sbot* copy(new Sbot);
+		copy->copyStateFrom(*this);
+		return copy;
+	}
+	
+	unsigned SbotGlobalSound::getWorldFrequenciesState(const World *w)
+	{
+		// the world gathers the frequencies once per step, so that concurrent worlds do not share any state
+		return w->globalSoundFrequencies;
 	}
 		
 	void FeedableSbot::controlStep(double dt)
@@ -136,6 +157,31 @@ namespace Enki
 		lastDEnergy = dEnergy;
 		dEnergy = 0;
 	}
+	
+	void FeedableSbot::saveState(StateWriter& state) const
+	{
+		Sbot::saveState(state);
+		state.write(energy);
+		state.write(dEnergy);
+		state.write(lastDEnergy);
+	}
+	
+	void FeedableSbot::loadState(StateReader& state)
+	{
+		Sbot::loadState(state);
+		state.read(energy);
+		state.read(dEnergy);
+		state.read(lastDEnergy);
+	}
+	
+	PhysicalObject* FeedableSbot::clone() const
+	{
+		if (typeid(*this) != typeid(FeedableSbot))
+			return 0;
+		FeedableSbot* copy(new FeedableSbot);
+		copy->copyStateFrom(*this);
+		return copy;
+	}
 
 	SoundSbot::SoundSbot() :
 		// microphones can pick up sound reaching up to 1m away
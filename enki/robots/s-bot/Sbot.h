@@ -52,25 +52,18 @@ namespace Enki
 	*/
 	class SbotGlobalSound : public GlobalInteraction
 	{
-	protected:
-		// FIXME: ugly and not re-entrant, will be removed by ECS refactor
-		//! The world frequencies state, mask of all frequencies
-		static unsigned worldFrequenciesState;
-		
 	public:
 		//! The frequencies state of this robot, mask of all frequencies
 		unsigned frequenciesState;
 		
 	public:
 		//! Constructor
-		SbotGlobalSound (Robot *me) { this->owner = me; }
-		//! Initialisation, set world frequencies to zero. Called one time for each robot, which could be optimised.
-		virtual void init() { worldFrequenciesState = 0; }
-		//! Emit our frequencies to the world
-		virtual void step(double dt, World *w) { worldFrequenciesState |= frequenciesState; }
-		// FIXME: ugly and not re-entrant, will be removed by ECS refactor
-		//! Return state of the frequencies in the world
-		static unsigned getWorldFrequenciesState(void);
+		SbotGlobalSound (Robot *me) : frequenciesState(0) { this->owner = me; }
+		//! Emit our frequencies to the world, which clears them at the beginning of every step
+		virtual void init(double dt, World *w) { w->globalSoundFrequencies |= frequenciesState; }
+		//! Return state of the frequencies in world w, the mask of the frequencies of all its Sbots at the beginning of the current step
+		/*!	This used to be a static state shared by all worlds and taking no argument; it is now kept by each world. */
+		static unsigned getWorldFrequenciesState(const World *w);
 	};
 
 
@@ -111,6 +104,12 @@ namespace Enki
 		Sbot();
 		//! Destructor
 		~Sbot() {}
+		//! Save the state of the differential wheeled robot, then the one of the global sound
+		virtual void saveState(StateWriter& state) const;
+		//! Load the state of the differential wheeled robot, then the one of the global sound
+		virtual void loadState(StateReader& state);
+		//! Return a copy of this robot if it is of class Sbot, 0 otherwise
+		virtual PhysicalObject* clone() const;
 	};
 
 
@@ -132,6 +131,12 @@ namespace Enki
 		FeedableSbot() { energy=0; dEnergy=0; lastDEnergy=0; }
 		//! Call DifferentialWheeled::step and compute the new energy
 		virtual void controlStep(double dt) ;
+		//! Save the state of the Sbot, then the energy
+		virtual void saveState(StateWriter& state) const;
+		//! Load the state of the Sbot, then the energy
+		virtual void loadState(StateReader& state);
+		//! Return a copy of this robot if it is of class FeedableSbot, 0 otherwise
+		virtual PhysicalObject* clone() const;
 	};
 
 
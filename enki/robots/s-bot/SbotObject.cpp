@@ -109,6 +109,18 @@ namespace Enki
 		owner->setColor((actualTime < activeDuration) ? activeColor : inactiveColor);
 	}
 
+	void SbotFeeding::saveState(StateWriter& state) const
+	{
+		state.write(actualEnergy);
+		state.write(actualTime);
+	}
+
+	void SbotFeeding::loadState(StateReader& state)
+	{
+		state.read(actualEnergy);
+		state.read(actualTime);
+	}
+
 	SbotActiveObject::SbotActiveObject(double objectRadius, double actionRange) :
 		feeding(actionRange, this)
 	{
@@ -72,6 +72,10 @@ namespace Enki
 		SbotFeeding(double r, Robot *owner);
 		virtual void objectStep (double dt, PhysicalObject *po, World *w);
 		virtual void finalize(double dt);
+		//! Save the energy in stock and the actual time
+		virtual void saveState(StateWriter& state) const;
+		//! Load the energy in stock and the actual time
+		virtual void loadState(StateReader& state);
 	};
 
 	//! SbotActiveObject give or remove energy to nearby Sbots through an SbotFeeding interaction
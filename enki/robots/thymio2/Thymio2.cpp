@@ -36,6 +36,7 @@
 #include <functional>
 #include <climits>
 #include <math.h>
+#include <typeinfo>
 
 /*! \file Thymio2.cpp
 	\brief Implementation of the Thymio II robot
@@ -163,5 +164,27 @@ namespace Enki
 		else
 			return ledColor[ledIndex];
 	}
+
+	void Thymio2::saveState(StateWriter& state) const
+	{
+		DifferentialWheeled::saveState(state);
+		state.write(ledColor, LED_COUNT);
+	}
+
+	void Thymio2::loadState(StateReader& state)
+	{
+		DifferentialWheeled::loadState(state);
+		state.read(ledColor, LED_COUNT);
+		ledTextureNeedUpdate = true;
+	}
+
+	PhysicalObject* Thymio2::clone() const
+	{
+		if (typeid(*this) != typeid(Thymio2))
+			return 0;
+		Thymio2* copy(new Thymio2);
+		copy->copyStateFrom(*this);
+		return copy;
+	}
 }
 
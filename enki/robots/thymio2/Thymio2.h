@@ -102,6 +102,13 @@ namespace Enki
 		void setLedIntensity(LedIndex ledIndex, double intensity = 1.f);
 		void setLedColor(LedIndex ledIndex, const Color& color = Color(1.,1.,1.,1.));
 		Color getColorLed(LedIndex ledIndex) const;
+		
+		//! Save the state of the differential wheeled robot, then the colors of the leds
+		virtual void saveState(StateWriter& state) const;
+		//! Load the state of the differential wheeled robot, then the colors of the leds
+		virtual void loadState(StateReader& state);
+		//! Return a copy of this robot if it is of class Thymio2, 0 otherwise
+		virtual PhysicalObject* clone() const;
 
 	protected:
 		Color ledColor[LED_COUNT];
@@ -33,7 +33,6 @@
 
 #include <Python.h>
 #include <boost/python.hpp>
-#include <boost/python/suite/indexing/vector_indexing_suite.hpp>
 #include <boost/python/return_value_policy.hpp>
 #include "../enki/Types.h"
 #include "../enki/Geometry.h"
@@ -74,6 +73,45 @@ void setColorComponents(Color& color, tuple values)
 	color.components[3] = extract<double>(values[3]);
 }
 
+// Texture and Textures are SmallVector, which vector_indexing_suite does not support, so they are given a list-like interface by hand
+
+template<typename Container>
+size_t checkIndex(const Container& container, long index)
+{
+	if (index < 0)
+		index += container.size();
+	if (index < 0 || index >= long(container.size()))
+	{
+		PyErr_SetString(PyExc_IndexError, "Index out of range");
+		throw_error_already_set();
+	}
+	return size_t(index);
+}
+
+template<typename Container>
+size_t getLength(const Container& container)
+{
+	return container.size();
+}
+
+template<typename Container>
+typename Container::value_type getItem(const Container& container, long index)
+{
+	return container[checkIndex(container, index)];
+}
+
+template<typename Container>
+void setItem(Container& container, long index, const typename Container::value_type& value)
+{
+	container[checkIndex(container, index)] = value;
+}
+
+template<typename Container>
+void append(Container& container, const typename Container::value_type& value)
+{
+	container.push_back(value);
+}
+
 #define def_readwrite_by_value(name, target) \
 	add_property(\
 		(name), \
@@ -414,6 +452,23 @@ void run(World& world, unsigned steps)
 		world.step(1./30., 3);
 }
 
+dict getProfilerPhaseTimes(const StepProfiler& profiler)
+{
+	dict d;
+	for (unsigned i = 0; i < StepProfiler::PHASE_COUNT; ++i)
+		d[StepProfiler::getPhaseName(StepProfiler::Phase(i))] = profiler.getPhaseTime(StepProfiler::Phase(i));
+	return d;
+}
+
+dict getProfilerObjectStepCalls(const StepProfiler& profiler)
+{
+	dict d;
+	const std::map<std::string, uint64_t> calls(profiler.getObjectStepCalls());
+	for (std::map<std::string, uint64_t>::const_iterator it = calls.begin(); it != calls.end(); ++it)
+		d[it->first] = it->second;
+	return d;
+}
+
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(step_overloads, step, 1, 2)
 BOOST_PYTHON_FUNCTION_OVERLOADS(runInViewer_overloads, runInViewer, 1, 6)
 
@@ -470,11 +525,19 @@ BOOST_PYTHON_MODULE(pyenki)
 	;
 	
 	class_<Texture>("Texture")
-		.def(vector_indexing_suite<Texture>())
+		.def("__len__", &getLength<Texture>)
+		.def("__getitem__", &getItem<Texture>)
+		.def("__setitem__", &setItem<Texture>)
+		.def("__iter__", iterator<Texture, return_value_policy<return_by_value> >())
+		.def("append", &append<Texture>)
 	;
 	
 	class_<Textures>("Textures")
-		.def(vector_indexing_suite<Textures>())
+		.def("__len__", &getLength<Textures>)
+		.def("__getitem__", &getItem<Textures>)
+		.def("__setitem__", &setItem<Textures>)
+		.def("__iter__", iterator<Textures, return_value_policy<return_by_value> >())
+		.def("append", &append<Textures>)
 	;
 	
 	// Physical objects
@@ -495,6 +558,8 @@ BOOST_PYTHON_MODULE(pyenki)
 		.def_readwrite_by_value("speed", &PhysicalObject::speed)
 		.def_readwrite("angSpeed", &PhysicalObject::angSpeed)
 		.add_property("color",  make_function(&PhysicalObject::getColor, return_value_policy<copy_const_reference>()), &PhysicalObject::setColor)
+		.def("setStatic", &PhysicalObject::setStatic)
+		.def("setDynamic", &PhysicalObject::setDynamic, args("mass"))
 		// warning setting the "color" property at run time using the viewer from the non-gui thread will lead to a crash because it will do an OpenGL call from that thread
 	;
 	
@@ -540,6 +605,22 @@ BOOST_PYTHON_MODULE(pyenki)
 	
 	// World
 	
+	class_<StepProfiler, boost::noncopyable>("StepProfiler",
+		"Time and counters of the phases of World.step(), which stay at zero unless Enki is built with ENKI_PROFILING",
+		no_init
+	)
+		.add_static_property("isCompiledIn", &StepProfiler::isCompiledIn)
+		.def("reset", &StepProfiler::reset)
+		.add_property("stepCount", &StepProfiler::getStepCount)
+		.add_property("phaseTimes", getProfilerPhaseTimes)
+		.add_property("broadPhasePairs", &StepProfiler::getBroadPhasePairs)
+		.add_property("contacts", &StepProfiler::getContacts)
+		.add_property("processedInteractionPairs", &StepProfiler::getProcessedInteractionPairs)
+		.add_property("rejectedInteractionPairs", &StepProfiler::getRejectedInteractionPairs)
+		.add_property("objectStepCalls", getProfilerObjectStepCalls)
+		.def("getStepLatencyPercentile", &StepProfiler::getStepLatencyPercentile, args("p"))
+	;
+	
 	class_<World>("WorldBase", no_init)
 	;
 	
@@ -555,6 +636,9 @@ BOOST_PYTHON_MODULE(pyenki)
 		.def("addObject", &World::addObject, with_custodian_and_ward<1,2>())
 		.def("removeObject", &World::removeObject)
 		.def("setRandomSeed", &World::setRandomSeed)
+		.def("setThreadCount", &World::setThreadCount)
+		.def("getThreadCount", &World::getThreadCount)
+		.add_property("profiler", make_function(static_cast<StepProfiler& (World::*)()>(&World::getProfiler), return_internal_reference<>()))
 		.def("run", run)
 		.def("runInViewer", runInViewer, runInViewer_overloads(args("self", "camPos", "camAltitude", "camYaw", "camPitch", "wallsHeight")))
 	;
@@ -0,0 +1,347 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include "../enki/Geometry.h"
+#include "../enki/PhysicalEngine.h"
+#include "../enki/interactions/IRSensor.h"
+#include "../enki/interactions/CircularCam.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <stdint.h>
+
+/*!	\file benchGeometry.cpp
+	\brief Microbenchmarks of the geometry and sensor kernels on seeded random inputs
+
+	Every case prints the time per call and a hash of all results, so that a rewritten kernel
+	can be shown to be faster and to return bit-identical results.
+*/
+
+using namespace Enki;
+using namespace std;
+
+// IR sensor exposing its ray-polygon kernel
+struct IRSensorKernel: IRSensor
+{
+	IRSensorKernel(Robot* owner): IRSensor(owner, Vector(0, 0), 2.5, 0, 12, 3731, 0.3, 0.7) {}
+	
+	double distance(const Point& pos, double rayAngle, const Polygon& p)
+	{
+		absPos = pos;
+		return distanceToPolygon(rayAngle, p);
+	}
+};
+
+// circular camera exposing its line drawing kernel, looking along the x axis from the origin
+struct CircularCamKernel: CircularCam
+{
+	CircularCamKernel(Robot* owner): CircularCam(owner, Vector(0, 0), 2.2, 0, M_PI / 6, 60)
+	{
+		absPos = Point(0, 0);
+		absOrientation = 0;
+		clear();
+	}
+	
+	void clear()
+	{
+		std::fill(&zbuffer[0], &zbuffer[0] + zbuffer.size(), std::numeric_limits<Scalar>::max());
+		std::fill(&image[0], &image[0] + image.size(), Color::gray);
+	}
+	
+	void draw(const Point& p0, const Point& p1, const Texture& texture)
+	{
+		drawTexturedLine(p0, p1, texture);
+	}
+	
+	// sum of the depth of the drawn pixels
+	double depthSum() const
+	{
+		double sum(0);
+		for (size_t i = 0; i < zbuffer.size(); ++i)
+			if (zbuffer[i] != std::numeric_limits<Scalar>::max())
+				sum += zbuffer[i];
+		return sum;
+	}
+};
+
+// results of a call to a kernel
+struct Output
+{
+	bool hit;
+	double values[4];
+};
+
+// a FNV-1a hash of the results of all calls to a kernel
+struct Hash
+{
+	uint64_t value;
+	
+	Hash(): value(14695981039346656037ULL) {}
+	
+	void add(const void* data, size_t size)
+	{
+		const unsigned char* bytes(reinterpret_cast<const unsigned char*>(data));
+		for (size_t i = 0; i < size; ++i)
+			value = (value ^ bytes[i]) * 1099511628211ULL;
+	}
+};
+
+// distributions of the distance between the two operands, relative to the sum of their radii
+struct Distribution
+{
+	const char* name;
+	double minDistance;
+	double maxDistance;
+};
+
+static const Distribution distributions[] = {
+	{ "hit", 0, 0.8 },
+	{ "mixed", 0, 2 },
+	{ "miss", 1.2, 2 }
+};
+
+static const unsigned vertexCounts[] = { 3, 4, 8, 16, 32 };
+
+// number of different inputs of every case
+static const size_t inputCount = 1024;
+// minimum duration of the measure of every case
+static double minDuration = 0.05;
+
+// a convex counter-clockwise polygon with vertexCount vertices and a bounding radius of about radius
+static Polygon randomPolygon(FastRandom& random, unsigned vertexCount, double radius)
+{
+	const double phase(random.getRange(2 * M_PI));
+	const double sx(0.5 + random.getRange(0.5));
+	const double sy(0.5 + random.getRange(0.5));
+	Polygon polygon;
+	for (unsigned i = 0; i < vertexCount; ++i)
+	{
+		const double a(2 * M_PI * i / vertexCount);
+		polygon << Point(radius * sx * cos(a), radius * sy * sin(a));
+	}
+	polygon.rotate(phase);
+	return polygon;
+}
+
+// a random offset whose norm is within the distribution, relative to radiusSum
+static Vector randomOffset(FastRandom& random, const Distribution& distribution, double radiusSum)
+{
+	const double distance(radiusSum * (distribution.minDistance + random.getRange(distribution.maxDistance - distribution.minDistance)));
+	const double angle(random.getRange(2 * M_PI));
+	return Vector(distance * cos(angle), distance * sin(angle));
+}
+
+// measure a kernel on all inputs, kernel(i, output, check) setting the results of input i, and details of the results only if check is true
+template<typename Kernel>
+static void measure(const string& kernelName, unsigned size, const Distribution& distribution, Kernel kernel, bool& first)
+{
+	// first pass: results
+	Hash hash;
+	size_t hits(0);
+	for (size_t i = 0; i < inputCount; ++i)
+	{
+		Output output;
+		memset(&output, 0, sizeof(output));
+		kernel(i, output, true);
+		hits += output.hit;
+		hash.add(&output.hit, sizeof(output.hit));
+		hash.add(output.values, sizeof(output.values));
+	}
+	
+	// then time repeated passes
+	typedef chrono::steady_clock Clock;
+	size_t calls(0);
+	size_t sink(0);
+	const Clock::time_point start(Clock::now());
+	double duration(0);
+	while (duration < minDuration)
+	{
+		for (size_t i = 0; i < inputCount; ++i)
+		{
+			Output output;
+			kernel(i, output, false);
+			sink += output.hit;
+		}
+		calls += inputCount;
+		duration = chrono::duration<double>(Clock::now() - start).count();
+	}
+	
+	char hashString[17];
+	snprintf(hashString, sizeof(hashString), "%016llx", (unsigned long long)hash.value);
+	cout << (first ? "\n" : ",\n");
+	first = false;
+	cout << "\t\t{ \"kernel\": \"" << kernelName << "\", \"size\": " << size << ", \"distribution\": \"" << distribution.name << "\"";
+	cout << ", \"nsPerCall\": " << duration * 1e9 / double(calls) << ", \"hitRatio\": " << double(hits) / double(inputCount);
+	cout << ", \"hash\": \"" << hashString << "\", \"sink\": " << sink % 2 << " }";
+	cout.flush();
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc > 1 && strcmp(argv[1], "--quick") == 0)
+		minDuration = 0.001;
+	
+	FastRandom random;
+	random.setSeed(1);
+	Robot owner;
+	IRSensorKernel irSensor(&owner);
+	CircularCamKernel camera(&owner);
+	bool first(true);
+	
+	cout << "{\n\t\"inputs\": " << inputCount << ",\n\t\"cases\": [";
+	for (size_t d = 0; d < sizeof(distributions) / sizeof(Distribution); ++d)
+	{
+		const Distribution& distribution(distributions[d]);
+		for (size_t v = 0; v < sizeof(vertexCounts) / sizeof(unsigned); ++v)
+		{
+			const unsigned vertexCount(vertexCounts[v]);
+			
+			// polygons against circles, polygons and points, with normals precomputed as the world does
+			vector<Polygon> polygons, others;
+			vector<SmallVector<Vector, 16> > polygonNormals(inputCount), otherNormals(inputCount);
+			vector<Point> centers;
+			vector<double> radii;
+			for (size_t i = 0; i < inputCount; ++i)
+			{
+				polygons.push_back(randomPolygon(random, vertexCount, 1 + random.getRange(4)));
+				radii.push_back(0.5 + random.getRange(4));
+				centers.push_back(randomOffset(random, distribution, polygons.back().getBoundingRadius() + radii.back()));
+				others.push_back(randomPolygon(random, vertexCount, radii.back()));
+				others.back().translate(centers.back());
+				polygons.back().getNormals(polygonNormals[i]);
+				others.back().getNormals(otherNormals[i]);
+			}
+			measure("Polygon::doesIntersect(circle)", vertexCount, distribution, [&](size_t i, Output& output, bool check) {
+				Vector mtv;
+				Point intersectionPoint;
+				output.hit = polygons[i].doesIntersect(centers[i], radii[i], polygonNormals[i].data(), mtv, intersectionPoint);
+				if (output.hit)
+				{
+					output.values[0] = mtv.x; output.values[1] = mtv.y;
+					output.values[2] = intersectionPoint.x; output.values[3] = intersectionPoint.y;
+				}
+			}, first);
+			measure("Polygon::doesIntersect(polygon)", vertexCount, distribution, [&](size_t i, Output& output, bool check) {
+				Vector mtv;
+				Point intersectionPoint;
+				output.hit = polygons[i].doesIntersect(others[i], polygonNormals[i].data(), otherNormals[i].data(), mtv, intersectionPoint);
+				if (output.hit)
+				{
+					output.values[0] = mtv.x; output.values[1] = mtv.y;
+					output.values[2] = intersectionPoint.x; output.values[3] = intersectionPoint.y;
+				}
+			}, first);
+			measure("Polygon::isPointInside", vertexCount, distribution, [&](size_t i, Output& output, bool check) {
+				// the point is within the circle around the center, scaled to the polygon
+				output.hit = polygons[i].isPointInside(centers[i] * (polygons[i].getBoundingRadius() / (polygons[i].getBoundingRadius() + radii[i])));
+			}, first);
+			
+			// rays of infrared sensors starting at the circle centers, pointing at the polygons more or less precisely
+			vector<double> rayAngles;
+			for (size_t i = 0; i < inputCount; ++i)
+				rayAngles.push_back((-centers[i]).angle() + random.getRange(1) - 0.5);
+			measure("IRSensor::distanceToPolygon", vertexCount, distribution, [&](size_t i, Output& output, bool check) {
+				const double dist(irSensor.distance(centers[i], rayAngles[i], polygons[i]));
+				output.hit = dist != HUGE_VAL;
+				output.values[0] = dist;
+			}, first);
+		}
+		
+		// segments against segments
+		vector<Segment> segments, otherSegments;
+		for (size_t i = 0; i < inputCount; ++i)
+		{
+			const Vector halfLength(Matrix22(random.getRange(2 * M_PI)) * Vector(0.5 + random.getRange(2), 0));
+			const Vector otherHalfLength(Matrix22(random.getRange(2 * M_PI)) * Vector(0.5 + random.getRange(2), 0));
+			const Point center(randomOffset(random, distribution, halfLength.norm() + otherHalfLength.norm()));
+			segments.push_back(Segment(-halfLength, halfLength));
+			otherSegments.push_back(Segment(center - otherHalfLength, center + otherHalfLength));
+		}
+		measure("Segment::doesIntersect", 2, distribution, [&](size_t i, Output& output, bool check) {
+			Point intersectionPoint;
+			output.hit = segments[i].doesIntersect(otherSegments[i], &intersectionPoint);
+			if (output.hit)
+			{
+				output.values[0] = intersectionPoint.x;
+				output.values[1] = intersectionPoint.y;
+			}
+		}, first);
+		
+		// textured lines seen by a camera, in front of it for hits and around it otherwise, drawn in frames of 16 lines
+		const unsigned textureSizes[] = { 1, 4, 16 };
+		for (size_t t = 0; t < sizeof(textureSizes) / sizeof(unsigned); ++t)
+		{
+			vector<Point> begins, ends;
+			vector<Texture> textures;
+			for (size_t i = 0; i < inputCount; ++i)
+			{
+				const bool hit(distribution.maxDistance < 1), miss(distribution.minDistance > 1);
+				const double sector(hit ? M_PI / 3 : (miss ? M_PI : 2 * M_PI));
+				const double angle((miss ? M_PI : 0) + random.getRange(sector) - sector / 2);
+				const Point center(Vector(cos(angle), sin(angle)) * (5 + random.getRange(20)));
+				const Vector halfLength(Matrix22(random.getRange(2 * M_PI)) * Vector(0.5 + random.getRange(3), 0));
+				begins.push_back(center - halfLength);
+				ends.push_back(center + halfLength);
+				textures.push_back(Texture());
+				for (unsigned j = 0; j < textureSizes[t]; ++j)
+					textures.back().push_back(Color(random.getRange(1), random.getRange(1), random.getRange(1)));
+			}
+			measure("CircularCam::drawTexturedLine", textureSizes[t], distribution, [&](size_t i, Output& output, bool check) {
+				// hidden lines take less time, so clear the camera as if it was seeing the lines of a few objects
+				if (i % 16 == 0)
+					camera.clear();
+				if (!check)
+				{
+					camera.draw(begins[i], ends[i], textures[i]);
+					output.hit = false;
+					return;
+				}
+				const double before(camera.depthSum());
+				camera.draw(begins[i], ends[i], textures[i]);
+				const double after(camera.depthSum());
+				output.hit = after != before;
+				output.values[0] = after;
+				output.values[1] = camera.image[i % 60].r();
+				output.values[2] = camera.image[i % 60].g();
+				output.values[3] = camera.image[i % 60].b();
+			}, first);
+		}
+	}
+	cout << "\n\t]\n}" << endl;
+	
+	return 0;
+}
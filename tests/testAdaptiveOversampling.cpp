@@ -0,0 +1,138 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include "../enki/PhysicalEngine.h"
+#include <iostream>
+#include <cstdlib>
+
+using namespace Enki;
+using namespace std;
+
+// a scene with a fast bullet shot at a thin wall, and slow objects far away
+static void populate(World& world)
+{
+	PhysicalObject* wall = new PhysicalObject;
+	wall->setRectangular(1, 40, 10, -1);
+	wall->pos = Point(50, 50);
+	world.addObject(wall);
+	
+	PhysicalObject* bullet = new PhysicalObject;
+	bullet->setCylindric(0.5, 1, 1);
+	bullet->pos = Point(20, 50);
+	bullet->speed = Vector(400, 0);
+	world.addObject(bullet);
+	
+	for (unsigned i = 0; i < 10; ++i)
+	{
+		PhysicalObject* o = new PhysicalObject;
+		o->setRectangular(2, 3, 1, 5);
+		o->pos = Point(120 + 10 * i, 150);
+		o->speed = Vector(2, double(i) - 5);
+		o->angSpeed = 0.1 * i;
+		world.addObject(o);
+	}
+}
+
+// a fast bullet shot at a thin wall of static geometry
+static bool checkStaticGeometry()
+{
+	World world(200, 200);
+	world.adaptiveOversampling = true;
+	world.staticGeometry.addSegment(Point(50, 20), Point(50, 80), 1, 10);
+	PhysicalObject* bullet = new PhysicalObject;
+	bullet->setCylindric(0.5, 1, 1);
+	bullet->pos = Point(20, 50);
+	bullet->speed = Vector(400, 0);
+	world.addObject(bullet);
+	for (unsigned step = 0; step < 5; ++step)
+		world.step(0.05, 20);
+	if (bullet->pos.x > 50)
+	{
+		cerr << "bullet went through the static wall" << endl;
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	World adaptive(200, 200);
+	adaptive.adaptiveOversampling = true;
+	populate(adaptive);
+	World multithreaded(200, 200);
+	multithreaded.adaptiveOversampling = true;
+	multithreaded.setThreadCount(3);
+	populate(multithreaded);
+	World once(200, 200);
+	populate(once);
+	
+	for (unsigned step = 0; step < 5; ++step)
+	{
+		adaptive.step(0.05, 20);
+		multithreaded.step(0.05, 20);
+		once.step(0.05, 1);
+	}
+	
+	// the bullet is subdivided enough not to go through the wall
+	if (adaptive.objects[1]->pos.x > 50)
+	{
+		cerr << "bullet went through the wall" << endl;
+		return 1;
+	}
+	
+	// isolated objects are integrated once per step, and results do not depend on threads
+	for (size_t i = 2; i < adaptive.objects.size(); ++i)
+	{
+		const PhysicalObject* o(adaptive.objects[i]);
+		if (!(o->pos == once.objects[i]->pos) || o->angle != once.objects[i]->angle)
+		{
+			cerr << "isolated object " << i << " was not integrated once per step" << endl;
+			return 1;
+		}
+	}
+	for (size_t i = 0; i < adaptive.objects.size(); ++i)
+	{
+		const PhysicalObject* o(adaptive.objects[i]);
+		if (!(o->pos == multithreaded.objects[i]->pos) || o->angle != multithreaded.objects[i]->angle)
+		{
+			cerr << "object " << i << " moved differently with several threads" << endl;
+			return 1;
+		}
+	}
+	
+	if (!checkStaticGeometry())
+		return 1;
+	
+	return 0;
+}
@@ -0,0 +1,207 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include "../enki/PhysicalEngine.h"
+#include <iostream>
+#include <cmath>
+
+using namespace Enki;
+using namespace std;
+
+// a ball bouncing in a corridor of boxes, which are either static or of infinite mass
+static World* createCorridor(bool staticBoxes)
+{
+	World* world(new World(200, 200));
+	for (unsigned i = 0; i < 20; ++i)
+	{
+		for (unsigned side = 0; side < 2; ++side)
+		{
+			PhysicalObject* box(new PhysicalObject);
+			box->pos = Point(10 + i * 9, side ? 120 : 80);
+			box->setRectangular(8, 8, 5, -1);
+			if (staticBoxes)
+				box->setStatic();
+			world->addObject(box);
+		}
+	}
+	PhysicalObject* ball(new PhysicalObject);
+	ball->pos = Point(20, 100);
+	ball->setCylindric(3, 2, 1);
+	ball->speed = Vector(30, 50);
+	ball->viscousFrictionCoefficient = 0;
+	ball->dryFrictionCoefficient = 0;
+	world->addObject(ball);
+	return world;
+}
+
+// static objects must collide like objects of infinite mass, without ever moving
+static bool checkStatic()
+{
+	World* objects(createCorridor(false));
+	World* statics(createCorridor(true));
+	PhysicalObject* box(statics->objects[0]);
+	box->speed = Vector(10, 0);
+	for (unsigned i = 0; i < 200; ++i)
+	{
+		objects->step(0.05, 5);
+		statics->step(0.05, 5);
+	}
+	const PhysicalObject* ball1(objects->objects[objects->objects.size() - 1]);
+	const PhysicalObject* ball2(statics->objects[statics->objects.size() - 1]);
+	const bool bounced(ball2->speed.y != 50);
+	const bool same(ball1->pos == ball2->pos && ball1->speed == ball2->speed);
+	const bool still(box->pos == Point(10, 80));
+	delete objects;
+	delete statics;
+	if (!bounced || !same || !still)
+	{
+		cerr << "static objects: ball bounced " << bounced << ", same as infinite mass " << same << ", static box still " << still << endl;
+		return false;
+	}
+	return true;
+}
+
+// a static object moved between steps must be found at its new place
+static bool checkMovedStatic()
+{
+	World world(200, 200);
+	PhysicalObject* wall(new PhysicalObject);
+	wall->setRectangular(4, 100, 5, -1);
+	wall->setStatic();
+	wall->pos = Point(150, 100);
+	world.addObject(wall);
+	PhysicalObject* ball(new PhysicalObject);
+	ball->setCylindric(2, 2, 1);
+	ball->pos = Point(50, 100);
+	world.addObject(ball);
+	world.step(0.1);
+	wall->pos = Point(60, 100);
+	world.step(0.1);
+	if (ball->pos.x > 56 + 1e-9)
+	{
+		cerr << "ball at " << ball->pos.x << " overlaps a moved static wall" << endl;
+		return false;
+	}
+	return true;
+}
+
+// a kinematic pusher following its trajectory, pushing a sleeping box along
+static bool checkKinematic(bool adaptive)
+{
+	World world(400, 400);
+	world.adaptiveOversampling = adaptive;
+	world.sleepSubsteps = 10;
+	PhysicalObject* pusher(new PhysicalObject);
+	pusher->setRectangular(4, 40, 5, 1);
+	pusher->setKinematic([](double time, Point& pos, double& angle) { pos = Point(50 + 20 * time, 200); angle = 0; });
+	world.addObject(pusher);
+	PhysicalObject* box(new PhysicalObject);
+	box->setRectangular(10, 10, 5, 1);
+	box->pos = Point(170, 200);
+	world.addObject(box);
+	for (unsigned i = 0; i < 20; ++i)
+		world.step(0.1, 10);
+	if (!box->isSleeping())
+	{
+		cerr << "box did not fall asleep before being pushed" << endl;
+		return false;
+	}
+	for (unsigned i = 0; i < 50; ++i)
+		world.step(0.1, 10);
+	
+	const double time(pusher->getKinematicTime());
+	const double gap(box->pos.x - 5 - pusher->pos.x - 2);
+	if (fabs(time - 7) > 1e-9 || fabs(pusher->pos.x - (50 + 20 * time)) > 1e-9 || pusher->getMass() >= 0)
+	{
+		cerr << "pusher at " << pusher->pos.x << " at time " << time << " with mass " << pusher->getMass() << endl;
+		return false;
+	}
+	if (box->pos.x < 195 || gap < -1e-6 || fabs(pusher->speed.x - 20) > 1e-9)
+	{
+		cerr << "box at " << box->pos.x << " with gap " << gap << " to pusher of speed " << pusher->speed.x << endl;
+		return false;
+	}
+	return true;
+}
+
+// the time along the trajectory is part of the state of kinematic objects
+static bool checkKinematicState()
+{
+	World world(400, 400);
+	PhysicalObject* door(new PhysicalObject);
+	door->setRectangular(40, 2, 5, 1);
+	door->setKinematic([](double time, Point& pos, double& angle) { pos = Point(200, 200); angle = time; });
+	world.addObject(door);
+	for (unsigned i = 0; i < 5; ++i)
+		world.step(0.1);
+	const World::Snapshot snapshot(world.snapshot());
+	World* fork(world.fork());
+	world.step(0.1);
+	const double angle(door->angle);
+	fork->step(0.1);
+	const double forkAngle(fork->objects[0]->angle);
+	delete fork;
+	world.restore(snapshot);
+	world.step(0.1);
+	if (angle != door->angle || angle != forkAngle || fabs(angle - 0.6) > 1e-9)
+	{
+		cerr << "door angle " << angle << ", after restore " << door->angle << ", in fork " << forkAngle << endl;
+		return false;
+	}
+	return true;
+}
+
+// an empty trajectory is rejected, so the world never calls it
+static bool checkEmptyTrajectory()
+{
+	World world(400, 400);
+	PhysicalObject* box(new PhysicalObject);
+	box->setRectangular(10, 10, 5, 1);
+	box->setKinematic(PhysicalObject::KinematicTrajectory());
+	world.addObject(box);
+	world.step(0.1);
+	if (box->getBodyType() != PhysicalObject::BODY_DYNAMIC || box->getMass() != 1)
+	{
+		cerr << "empty trajectory changed the body type" << endl;
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	if (!checkStatic() || !checkMovedStatic() || !checkKinematic(false) || !checkKinematic(true) || !checkKinematicState() || !checkEmptyTrajectory())
+		return 1;
+	return 0;
+}
@@ -33,6 +33,8 @@
 
 #include "../enki/Geometry.h"
 #include <iostream>
+#include <cstdlib>
+#include <limits>
 
 using namespace Enki;
 using namespace std;
@@ -190,10 +192,149 @@ void testSegmentSegmentIntersection()
 	CHECK_INTERSECT_SEGMENT_SEGMENT(null1.doesIntersect(null0, &intersectionPoint), false, Point(0,0));
 }
 
+// separating axes computed with a segment per side, as Polygon::doesIntersect did before it used precomputed normals
+bool referenceIntersection(const Polygon& p1, const Polygon& p2, Vector& mtv, Point& cp)
+{
+	double minMTVDist(std::numeric_limits<double>::max());
+	for (size_t k = 0; k < 2; ++k)
+	{
+		const Polygon& sides(k == 0 ? p1 : p2);
+		const Polygon& points(k == 0 ? p2 : p1);
+		for (size_t i = 0; i < sides.size(); ++i)
+		{
+			const Segment segment(sides.getSegment(i));
+			double maxDist(0);
+			size_t maxJ(0);
+			for (size_t j = 0; j < points.size(); ++j)
+			{
+				const double dist(segment.dist(points[j]));
+				if (dist > maxDist)
+				{
+					maxDist = dist;
+					maxJ = j;
+				}
+			}
+			if (maxDist == 0)
+				return false;
+			if (maxDist < minMTVDist)
+			{
+				minMTVDist = maxDist;
+				const Vector u(segment.getDirection().perp().unitary() * maxDist);
+				mtv = k == 0 ? u : -u;
+				cp = k == 0 ? points[maxJ] : points[maxJ] - u;
+			}
+		}
+	}
+	return true;
+}
+
+bool referenceIntersection(const Polygon& polygon, const Point& center, double r, Vector& mtv, Point& cp)
+{
+	double minMTVDist(std::numeric_limits<double>::max());
+	for (size_t i = 0; i < polygon.size(); ++i)
+	{
+		const Segment segment(polygon.getSegment(i));
+		const Vector u(segment.getDirection().perp().unitary());
+		const double dist((center - segment.a) * u + r);
+		if (dist <= 0)
+			return false;
+		const Point proj(center + u * (r - dist));
+		if ((proj - segment.a) * segment.getDirection() >= 0 && (proj - segment.b) * segment.getDirection() <= 0 && dist < minMTVDist)
+		{
+			minMTVDist = dist;
+			mtv = u * dist;
+			cp = proj + mtv;
+		}
+	}
+	if (minMTVDist != std::numeric_limits<double>::max())
+		return true;
+	double minPointCenterDist2(std::numeric_limits<double>::max());
+	for (size_t i = 0; i < polygon.size(); ++i)
+	{
+		const Vector centerToPoint(polygon[i] - center);
+		const double d2(centerToPoint.norm2());
+		if (d2 < minPointCenterDist2 && d2 <= r*r)
+		{
+			minPointCenterDist2 = d2;
+			mtv = centerToPoint.unitary() * (r - sqrt(d2));
+			cp = center + centerToPoint + mtv;
+		}
+	}
+	return minPointCenterDist2 != std::numeric_limits<double>::max();
+}
+
+double randomUnit()
+{
+	return double(rand()) / double(RAND_MAX);
+}
+
+// a random convex anti-clockwise polygon, with vertices on a circle
+Polygon randomPolygon()
+{
+	const Point center(randomUnit() * 20, randomUnit() * 20);
+	const double radius(1 + randomUnit() * 5);
+	const size_t count(3 + rand() % 10);
+	const double start(randomUnit() * 2 * M_PI);
+	Polygon polygon;
+	for (size_t i = 0; i < count; ++i)
+	{
+		const double angle(start + (i + 0.2 + 0.6 * randomUnit()) * 2 * M_PI / count);
+		polygon << center + Vector(cos(angle), sin(angle)) * radius;
+	}
+	return polygon;
+}
+
+#define CHECK_SAME_INTERSECTION(found, expected) \
+	if (found != expected || (found && ((mtv - referenceMtv).norm() > 1e-9 || (cp - referenceCp).norm() > 1e-9))) { \
+		cerr << "separating axes " << found << " with mtv " << mtv << " at " << cp << " instead of " << expected << " with mtv " << referenceMtv << " at " << referenceCp << endl; \
+		exit(3); \
+	}
+
+void testSeparatingAxes()
+{
+	srand(1);
+	unsigned hits(0);
+	for (unsigned i = 0; i < 10000; ++i)
+	{
+		const Polygon p1(randomPolygon());
+		const Polygon p2(randomPolygon());
+		Vector mtv, referenceMtv;
+		Point cp, referenceCp;
+		const bool found(p1.doesIntersect(p2, mtv, cp));
+		const bool expected(referenceIntersection(p1, p2, referenceMtv, referenceCp));
+		CHECK_SAME_INTERSECTION(found, expected);
+		hits += found;
+		
+		const Point center(randomUnit() * 20, randomUnit() * 20);
+		const double r(randomUnit() * 5);
+		const bool circleFound(p1.doesIntersect(center, r, mtv, cp));
+		const bool circleExpected(referenceIntersection(p1, center, r, referenceMtv, referenceCp));
+		CHECK_SAME_INTERSECTION(circleFound, circleExpected);
+		hits += circleFound;
+	}
+	
+	// clockwise polygons have outward normals as well
+	Polygon clockwise;
+	clockwise << Point(0, 0) << Point(0, 2) << Point(2, 2) << Point(2, 0);
+	SmallVector<Vector, 16> normals;
+	clockwise.getNormals(normals);
+	if (!(normals[0] == Vector(-1, 0)) || !(normals[1] == Vector(0, 1)))
+	{
+		cerr << "normals of a clockwise polygon are " << normals[0] << " and " << normals[1] << endl;
+		exit(4);
+	}
+	if (hits < 1000)
+	{
+		cerr << "only " << hits << " random intersections tested" << endl;
+		exit(5);
+	}
+}
+
 int main()
 {
 	testPolygonCircleIntersection();
 	testSegmentSegmentIntersection();
+	testSeparatingAxes();
 	
 	return 0;
 }
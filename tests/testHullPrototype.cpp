@@ -0,0 +1,107 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include "../enki/PhysicalEngine.h"
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+using namespace Enki;
+using namespace std;
+
+// build an off-center object, whose hull gets recentered
+static PhysicalObject* createObject(double offset)
+{
+	Polygon p;
+	p << Point(-3,-2) << Point(3,-2) << Point(4,1) << Point(0,3) << Point(-4,1);
+	for (size_t i = 0; i < p.size(); ++i)
+		p[i] += Vector(offset, 1);
+	PhysicalObject* o(new PhysicalObject);
+	o->setCustomHull(PhysicalObject::Hull(PhysicalObject::Part(p, 5)), 30);
+	return o;
+}
+
+int main(int argc, char* argv[])
+{
+	// identical objects share their prototype
+	PhysicalObject* o1(createObject(2));
+	PhysicalObject* o2(createObject(2));
+	PhysicalObject* o3(createObject(2.5));
+	const PhysicalObject::Part& part(o1->getHull()[0]);
+	if (part.getPrototype() != o2->getHull()[0].getPrototype())
+	{
+		cerr << "identical objects do not share their prototype" << endl;
+		return 1;
+	}
+	
+	// normals are outward unit vectors
+	const Polygon& shape(part.getShape());
+	const vector<Vector>& normals(part.getPrototype()->getNormals());
+	for (size_t i = 0; i < shape.size(); ++i)
+	{
+		const Vector side(shape[(i+1) % shape.size()] - shape[i]);
+		if (fabs(normals[i].norm() - 1) > 1e-12 || fabs(normals[i] * side) > 1e-12 || normals[i] * (shape[i] - part.getCentroid()) <= 0)
+		{
+			cerr << "normal " << i << " is not an outward unit vector" << endl;
+			return 1;
+		}
+	}
+	
+	// prototypes are released with the last part using them
+	weak_ptr<const PhysicalObject::HullPrototype> prototype(part.getPrototype());
+	delete o1;
+	delete o2;
+	delete o3;
+	if (!prototype.expired())
+	{
+		cerr << "prototype outlived the objects using it" << endl;
+		return 1;
+	}
+	
+	// textures are part of the identity of prototypes
+	Polygon square;
+	square << Point(-1,-1) << Point(1,-1) << Point(1,1) << Point(-1,1);
+	Textures textures(4, Texture(1, Color::red));
+	PhysicalObject::Part textured(square, 1, textures);
+	textures[2][0] = Color::blue;
+	PhysicalObject::Part otherTextured(square, 1, textures);
+	PhysicalObject::Part sameTextured(square, 1, textures);
+	if (textured.getPrototype() == otherTextured.getPrototype() || otherTextured.getPrototype() != sameTextured.getPrototype())
+	{
+		cerr << "textured parts are not shared according to their textures" << endl;
+		return 1;
+	}
+	
+	return 0;
+}
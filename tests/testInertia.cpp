@@ -0,0 +1,98 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include "../enki/PhysicalEngine.h"
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+using namespace Enki;
+using namespace std;
+
+// numerically integrate the second moment of a hull around the origin, per unit mass
+static double numericalSecondMoment(const PhysicalObject::Hull& hull, double r)
+{
+	double secondMoment = 0;
+	double area = 0;
+	const double dr = r / 1000.;
+	for (double ix = -r + dr / 2; ix < r; ix += dr)
+		for (double iy = -r + dr / 2; iy < r; iy += dr)
+			for (PhysicalObject::Hull::const_iterator it = hull.begin(); it != hull.end(); ++it)
+				if (it->getShape().isPointInside(Point(ix, iy)))
+				{
+					secondMoment += ix * ix + iy * iy;
+					area++;
+				}
+	return secondMoment / area;
+}
+
+static bool check(const char* name, double value, double expected, double tolerance)
+{
+	if (fabs(value - expected) > tolerance * fabs(expected))
+	{
+		cerr << name << ": moment of inertia " << value << " instead of " << expected << endl;
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	// rectangle, closed form
+	PhysicalObject rectangle;
+	rectangle.setRectangular(5, 3, 4, 20);
+	if (!check("rectangle", rectangle.getMomentOfInertia(), 20. * (25 + 9) / 12, 1e-12))
+		return 1;
+	
+	// same rectangle as a polygon, in clockwise order and off center
+	Polygon clockwise;
+	clockwise << Point(1, 1) << Point(1, 4) << Point(6, 4) << Point(6, 1);
+	PhysicalObject polygonal;
+	polygonal.setCustomHull(PhysicalObject::Hull(PhysicalObject::Part(clockwise, 4)), 20);
+	if (!check("clockwise rectangle", polygonal.getMomentOfInertia(), 20. * (25 + 9) / 12, 1e-12))
+		return 1;
+	
+	// two-part irregular hull, compared to numerical integration
+	Polygon p;
+	p << Point(-3,-2) << Point(3,-2) << Point(4,1) << Point(0,3) << Point(-4,1);
+	PhysicalObject::Hull hull(PhysicalObject::Part(p, 5));
+	hull += PhysicalObject::Part(2, 2, 3);
+	PhysicalObject irregular;
+	irregular.setCustomHull(hull, 30);
+	const double expected(30 * numericalSecondMoment(irregular.getHull(), irregular.getRadius()));
+	if (!check("irregular hull", irregular.getMomentOfInertia(), expected, 1e-3))
+		return 1;
+	
+	return 0;
+}
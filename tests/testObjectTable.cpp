@@ -0,0 +1,169 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+
+#include "../enki/PhysicalEngine.h"
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <set>
+
+using namespace Enki;
+using namespace std;
+
+// check that the content of the world and its lookup by uid match the reference set of objects
+void checkWorld(const World& world, const set<PhysicalObject*>& reference)
+{
+	if (world.objects.size() != reference.size())
+	{
+		cerr << "world has " << world.objects.size() << " objects instead of " << reference.size() << endl;
+		exit(1);
+	}
+	set<PhysicalObject*> content(world.objects.begin(), world.objects.end());
+	if (content != reference)
+	{
+		cerr << "world content differs from reference" << endl;
+		exit(1);
+	}
+	for (set<PhysicalObject*>::const_iterator it = reference.begin(); it != reference.end(); ++it)
+	{
+		if (world.getObjectByUid((*it)->uid) != *it)
+		{
+			cerr << "object of uid " << (*it)->uid << " not found" << endl;
+			exit(1);
+		}
+	}
+}
+
+// number of control steps of victims, which must stop once they are deleted
+static unsigned victimControlSteps = 0;
+
+// a robot counting its control steps
+struct Victim : public Robot
+{
+	virtual void controlStep(double dt) { ++victimControlSteps; Robot::controlStep(dt); }
+};
+
+// a robot whose controller removes and deletes another robot
+struct Killer : public Robot
+{
+	World* world;
+	Robot* victim;
+	Killer(World* world, Robot* victim) : world(world), victim(victim) {}
+	virtual void controlStep(double dt)
+	{
+		if (victim)
+		{
+			world->removeObject(victim);
+			delete victim;
+			victim = 0;
+		}
+		Robot::controlStep(dt);
+	}
+};
+
+// objects deleted by controllers during a step are not visited afterwards in that step
+void checkDeletionDuringStep()
+{
+	World world(100, 100);
+	Victim* victim(new Victim);
+	victim->pos = Point(80, 80);
+	Killer* killer(new Killer(&world, victim));
+	killer->pos = Point(20, 20);
+	world.addObject(killer);
+	world.addObject(victim);
+	world.step(0.1);
+	world.step(0.1);
+	if (victimControlSteps != 0 || world.objects.size() != 1)
+	{
+		cerr << "deleted robot did " << victimControlSteps << " control steps" << endl;
+		exit(1);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	World world;
+	world.takeObjectOwnership = false;
+	vector<PhysicalObject*> objects;
+	for (unsigned i = 0; i < 50; ++i)
+		objects.push_back(new PhysicalObject);
+	
+	// objects are iterated in the order they are added
+	set<PhysicalObject*> reference;
+	for (unsigned i = 0; i < objects.size(); ++i)
+	{
+		world.addObject(objects[i]);
+		world.addObject(objects[i]);
+		reference.insert(objects[i]);
+	}
+	checkWorld(world, reference);
+	for (unsigned i = 0; i < objects.size(); ++i)
+	{
+		if (world.objects[i] != objects[i])
+		{
+			cerr << "object " << i << " not in order of addition" << endl;
+			return 1;
+		}
+	}
+	
+	// remove and add objects back in a pseudo-random order
+	FastRandom random;
+	for (unsigned i = 0; i < 500; ++i)
+	{
+		PhysicalObject* o = objects[random.get() % objects.size()];
+		if (reference.count(o))
+		{
+			world.removeObject(o);
+			reference.erase(o);
+			if (world.objects.count(o) || world.getObjectByUid(o->uid))
+			{
+				cerr << "removed object still found" << endl;
+				return 1;
+			}
+		}
+		else
+		{
+			world.addObject(o);
+			reference.insert(o);
+		}
+		checkWorld(world, reference);
+	}
+	
+	for (unsigned i = 0; i < objects.size(); ++i)
+		delete objects[i];
+	
+	checkDeletionDuringStep();
+	return 0;
+}
@@ -0,0 +1,196 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include "../enki/PhysicalEngine.h"
+#include "../enki/robots/e-puck/EPuck.h"
+#include <iostream>
+#include <cmath>
+#include <set>
+
+using namespace Enki;
+using namespace std;
+
+// a ring of walls, as many parts of a single object or as one object per wall
+static void addRing(World& world, bool compound)
+{
+	const unsigned wallCount(24);
+	const double ringRadius(20);
+	PhysicalObject::Hull hull;
+	for (unsigned i = 0; i < wallCount; ++i)
+	{
+		const double angle(2 * M_PI * i / wallCount);
+		Polygon wall;
+		wall << Point(-1, -3) << Point(1, -3) << Point(1, 3) << Point(-1, 3);
+		wall.rotate(angle);
+		wall.translate(Vector(cos(angle), sin(angle)) * ringRadius);
+		if (compound)
+			hull.push_back(PhysicalObject::Part(wall, 5));
+		else
+		{
+			PhysicalObject* o(new PhysicalObject);
+			o->setCustomHull(PhysicalObject::Part(wall, 5), -1);
+			o->setColor(Color::blue);
+			world.addObject(o);
+		}
+	}
+	if (compound)
+	{
+		PhysicalObject* o(new PhysicalObject);
+		o->setCustomHull(hull, -1);
+		o->setColor(Color::blue);
+		world.addObject(o);
+	}
+}
+
+// the hierarchy of parts must return the same parts as a linear search, with boxes and circles bounding them
+static bool checkQueries()
+{
+	World world;
+	addRing(world, true);
+	PhysicalObject* ring(*world.objects.begin());
+	FastRandom random;
+	for (unsigned i = 0; i < 100; ++i)
+	{
+		ring->pos = Point(random.getRange(100), random.getRange(100));
+		ring->angle = random.getRange(2 * M_PI);
+		ring->updateTransformedShape();
+		for (PhysicalObject::Hull::const_iterator it = ring->getHull().begin(); it != ring->getHull().end(); ++it)
+		{
+			const Polygon& shape(it->getTransformedShape());
+			for (size_t j = 0; j < shape.size(); ++j)
+			{
+				const bool inBox(shape[j].x >= it->getTransformedBottomLeft().x && shape[j].x <= it->getTransformedTopRight().x && shape[j].y >= it->getTransformedBottomLeft().y && shape[j].y <= it->getTransformedTopRight().y);
+				const bool inCircle((shape[j] - it->getTransformedCentroid()).norm() <= it->getBoundingRadius() * (1 + 1e-12));
+				if (!inBox || !inCircle)
+				{
+					cerr << "vertex " << shape[j] << " out of the bounding box or circle of its part" << endl;
+					return false;
+				}
+			}
+		}
+		for (unsigned j = 0; j < 10; ++j)
+		{
+			const Point bottomLeft(random.getRange(140) - 20, random.getRange(140) - 20);
+			const Point topRight(bottomLeft + Vector(random.getRange(20), random.getRange(20)));
+			set<const PhysicalObject::Part*> found, expected;
+			ring->visitOverlappingParts(bottomLeft, topRight, [&found](const PhysicalObject::Part& part) { found.insert(&part); });
+			for (PhysicalObject::Hull::const_iterator it = ring->getHull().begin(); it != ring->getHull().end(); ++it)
+				if (it->getTransformedBottomLeft().x <= topRight.x && it->getTransformedTopRight().x >= bottomLeft.x && it->getTransformedBottomLeft().y <= topRight.y && it->getTransformedTopRight().y >= bottomLeft.y)
+					expected.insert(&*it);
+			if (found != expected)
+			{
+				cerr << "query " << i << " found " << found.size() << " parts instead of " << expected.size() << endl;
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// an e-puck must see the same walls whether they are parts of one object or separate objects
+static bool checkSensors()
+{
+	// the e-pucks are added first so that they get the same random streams
+	World compoundWorld, separateWorld;
+	EPuck* compoundEPuck(new EPuck(EPuck::CAPABILITY_BASIC_SENSORS | EPuck::CAPABILITY_CAMERA));
+	EPuck* separateEPuck(new EPuck(EPuck::CAPABILITY_BASIC_SENSORS | EPuck::CAPABILITY_CAMERA));
+	compoundWorld.addObject(compoundEPuck);
+	separateWorld.addObject(separateEPuck);
+	addRing(compoundWorld, true);
+	addRing(separateWorld, false);
+	FastRandom random;
+	for (unsigned i = 0; i < 200; ++i)
+	{
+		const double direction(random.getRange(2 * M_PI));
+		const Point pos(Vector(cos(direction), sin(direction)) * random.getRange(15));
+		const double angle(random.getRange(2 * M_PI));
+		compoundEPuck->pos = separateEPuck->pos = pos;
+		compoundEPuck->angle = separateEPuck->angle = angle;
+		compoundWorld.step(0.01, 1);
+		separateWorld.step(0.01, 1);
+		const IRSensor* compoundSensors[8] = { &compoundEPuck->infraredSensor0, &compoundEPuck->infraredSensor1, &compoundEPuck->infraredSensor2, &compoundEPuck->infraredSensor3, &compoundEPuck->infraredSensor4, &compoundEPuck->infraredSensor5, &compoundEPuck->infraredSensor6, &compoundEPuck->infraredSensor7 };
+		const IRSensor* separateSensors[8] = { &separateEPuck->infraredSensor0, &separateEPuck->infraredSensor1, &separateEPuck->infraredSensor2, &separateEPuck->infraredSensor3, &separateEPuck->infraredSensor4, &separateEPuck->infraredSensor5, &separateEPuck->infraredSensor6, &separateEPuck->infraredSensor7 };
+		for (size_t j = 0; j < 8; ++j)
+		{
+			if (compoundSensors[j]->getValue() != separateSensors[j]->getValue())
+			{
+				cerr << "pose " << i << ": infrared sensor " << j << " reads " << compoundSensors[j]->getValue() << " in compound ring and " << separateSensors[j]->getValue() << " in separate one" << endl;
+				return false;
+			}
+		}
+		if ((compoundEPuck->camera.zbuffer != separateEPuck->camera.zbuffer).max())
+		{
+			cerr << "pose " << i << ": camera sees differently the compound and separate rings" << endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+// an e-puck driving in a ring of parts must hit its walls and not go through them
+static bool checkContacts()
+{
+	World world;
+	EPuck* epuck(new EPuck);
+	world.addObject(epuck);
+	addRing(world, true);
+	epuck->pos = Point(3, 2);
+	epuck->leftSpeed = 10;
+	epuck->rightSpeed = 8;
+	bool touched(false);
+	for (unsigned i = 0; i < 300; ++i)
+	{
+		world.step(0.05, 3);
+		// the inner side of the walls is at least 19 from the center, minus the e-puck radius
+		if (epuck->pos.norm() > 16)
+		{
+			cerr << "step " << i << ": e-puck at " << epuck->pos << " went through the ring" << endl;
+			return false;
+		}
+		touched = touched || epuck->pos.norm() > 15;
+	}
+	if (!touched)
+	{
+		cerr << "e-puck never touched the ring" << endl;
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	if (!checkQueries() || !checkSensors() || !checkContacts())
+		return 1;
+	return 0;
+}
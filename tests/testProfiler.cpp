@@ -0,0 +1,169 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include "../enki/PhysicalEngine.h"
+#include "../enki/robots/e-puck/EPuck.h"
+#include <iostream>
+#include <cstdlib>
+
+using namespace Enki;
+using namespace std;
+
+// a cylinder stepping a world of its own on every collision, as a planner forking its world could
+struct NestingObject : public PhysicalObject
+{
+	World inner;
+	NestingObject() : inner(10, 10) {}
+	virtual void collisionEvent(PhysicalObject *o) { inner.step(0.1); }
+};
+
+// e-pucks on a circle driving into a pile of cylinders at its center, so that there are contacts,
+// and that the sensors of every e-puck have both objects in their range and neighbours out of it
+static void populate(World& world, bool nesting = false)
+{
+	for (unsigned i = 0; i < 16; ++i)
+	{
+		const double angle(2 * M_PI * i / 16);
+		EPuck* epuck = new EPuck(EPuck::CAPABILITY_BASIC_SENSORS | EPuck::CAPABILITY_CAMERA);
+		epuck->pos = Point(100 + 80 * cos(angle), 100 + 80 * sin(angle));
+		epuck->angle = angle + M_PI;
+		epuck->leftSpeed = 8 + 0.2 * i;
+		epuck->rightSpeed = 8;
+		world.addObject(epuck);
+	}
+	for (unsigned i = 0; i < 36; ++i)
+	{
+		PhysicalObject* o = nesting ? new NestingObject : new PhysicalObject;
+		o->setCylindric(2, 1, 5);
+		o->pos = Point(85 + 6 * (i % 6), 85 + 6 * (i / 6));
+		world.addObject(o);
+	}
+}
+
+// run a world and check its profiler, returning its number of contacts
+static bool check(unsigned threadCount, uint64_t& contacts)
+{
+	World world(200, 200);
+	world.setThreadCount(threadCount);
+	populate(world);
+	const StepProfiler& profiler(world.getProfiler());
+	for (unsigned step = 0; step < 100; ++step)
+		world.step(0.1, 3);
+	contacts = profiler.getContacts();
+	
+	if (!StepProfiler::isCompiledIn())
+	{
+		if (profiler.getStepCount() != 0 || profiler.getContacts() != 0 || profiler.getBroadPhasePairs() != 0 || !profiler.getObjectStepCalls().empty() || profiler.getStepLatencyPercentile(0.5) != 0)
+		{
+			cerr << "profiler is not empty while profiling is compiled out" << endl;
+			return false;
+		}
+		return true;
+	}
+	
+	if (profiler.getStepCount() != 100)
+	{
+		cerr << threadCount << " threads: " << profiler.getStepCount() << " steps profiled instead of 100" << endl;
+		return false;
+	}
+	for (unsigned i = 0; i < StepProfiler::PHASE_COUNT; ++i)
+	{
+		const StepProfiler::Phase phase = StepProfiler::Phase(i);
+		if (profiler.getPhaseTime(phase) <= 0 && phase != StepProfiler::PHASE_BLUETOOTH && phase != StepProfiler::PHASE_TRAJECTORY_RECORDING)
+		{
+			cerr << threadCount << " threads: no time spent in phase " << StepProfiler::getPhaseName(phase) << endl;
+			return false;
+		}
+	}
+	if (profiler.getContacts() == 0 || profiler.getBroadPhasePairs() < profiler.getContacts())
+	{
+		cerr << threadCount << " threads: " << profiler.getContacts() << " contacts out of " << profiler.getBroadPhasePairs() << " broadphase pairs" << endl;
+		return false;
+	}
+	if (profiler.getProcessedInteractionPairs() == 0 || profiler.getRejectedInteractionPairs() == 0)
+	{
+		cerr << threadCount << " threads: " << profiler.getProcessedInteractionPairs() << " processed and " << profiler.getRejectedInteractionPairs() << " rejected interaction pairs" << endl;
+		return false;
+	}
+	const map<string, uint64_t> calls(profiler.getObjectStepCalls());
+	uint64_t callCount(0);
+	for (map<string, uint64_t>::const_iterator it = calls.begin(); it != calls.end(); ++it)
+		callCount += it->second;
+	if (calls.find("Enki::IRSensor") == calls.end() || calls.find("Enki::CircularCam") == calls.end() || callCount != profiler.getProcessedInteractionPairs())
+	{
+		cerr << threadCount << " threads: calls to objectStep() do not match processed pairs" << endl;
+		return false;
+	}
+	const double p50(profiler.getStepLatencyPercentile(0.5));
+	const double p99(profiler.getStepLatencyPercentile(0.99));
+	if (p50 <= 0 || p99 < p50 || p99 > 1)
+	{
+		cerr << threadCount << " threads: wrong step latencies, p50 " << p50 << " p99 " << p99 << endl;
+		return false;
+	}
+	
+	world.getProfiler().reset();
+	if (profiler.getStepCount() != 0 || profiler.getContacts() != 0 || profiler.getPhaseTime(StepProfiler::PHASE_PHYSICS_INIT) != 0 || !profiler.getObjectStepCalls().empty())
+	{
+		cerr << threadCount << " threads: profiler not empty after reset" << endl;
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	uint64_t contacts, threadedContacts;
+	if (!check(1, contacts) || !check(2, threadedContacts))
+		return 1;
+	
+	// counters are summed over threads, so they do not depend on the number of threads
+	if (contacts != threadedContacts)
+	{
+		cerr << contacts << " contacts in a single thread but " << threadedContacts << " with 2 threads" << endl;
+		return 1;
+	}
+	
+	// worlds stepped during the step of another one do not stop the counting of the latter
+	World world(200, 200);
+	populate(world, true);
+	for (unsigned step = 0; step < 100; ++step)
+		world.step(0.1, 3);
+	if (world.getProfiler().getContacts() != contacts)
+	{
+		cerr << contacts << " contacts but " << world.getProfiler().getContacts() << " with nested steps" << endl;
+		return 1;
+	}
+	return 0;
+}
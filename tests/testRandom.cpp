@@ -0,0 +1,104 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+
+#include "../enki/Random.h"
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+using namespace Enki;
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+	// a stream only depends on its seed and index
+	CounterRandom a(7, 3), b(7, 3), c(7, 4), d(8, 3);
+	unsigned sameAsOtherStream = 0, sameAsOtherSeed = 0;
+	for (unsigned i = 0; i < 1000; ++i)
+	{
+		const uint64_t value = a.get();
+		if (value != b.get())
+		{
+			cerr << "streams with same seed and index differ at " << i << endl;
+			return 1;
+		}
+		sameAsOtherStream += (value == c.get());
+		sameAsOtherSeed += (value == d.get());
+	}
+	if (sameAsOtherStream > 0 || sameAsOtherSeed > 0)
+	{
+		cerr << "different streams are correlated" << endl;
+		return 1;
+	}
+	
+	// restarting a stream gives the same numbers
+	a.setSeed(7, 3);
+	b.setSeed(7, 3);
+	for (unsigned i = 0; i < 100; ++i)
+	{
+		if (a.getGaussian(0, 1) != b.getGaussian(0, 1))
+		{
+			cerr << "restarted streams differ" << endl;
+			return 1;
+		}
+	}
+	
+	// check moments of uniform and Gaussian distributions
+	const unsigned count = 200000;
+	double uniformSum = 0, gaussianSum = 0, gaussianSquareSum = 0;
+	for (unsigned i = 0; i < count; ++i)
+	{
+		const double u = a.getUniform();
+		if (u < 0 || u >= 1)
+		{
+			cerr << "uniform number " << u << " out of range" << endl;
+			return 1;
+		}
+		uniformSum += u;
+		const double g = a.getGaussian(2, 3);
+		gaussianSum += g;
+		gaussianSquareSum += (g - 2) * (g - 2);
+	}
+	const double uniformMean = uniformSum / count;
+	const double gaussianMean = gaussianSum / count;
+	const double gaussianSd = sqrt(gaussianSquareSum / count);
+	if (fabs(uniformMean - 0.5) > 0.01 || fabs(gaussianMean - 2) > 0.05 || fabs(gaussianSd - 3) > 0.05)
+	{
+		cerr << "bad moments: uniform mean " << uniformMean << ", Gaussian mean " << gaussianMean << " and sd " << gaussianSd << endl;
+		return 1;
+	}
+	
+	return 0;
+}
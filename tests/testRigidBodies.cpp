@@ -0,0 +1,102 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+
+#include "../enki/PhysicalEngine.h"
+#include <iostream>
+#include <cstdlib>
+
+using namespace Enki;
+using namespace std;
+
+// expose the scalar friction of PhysicalObject
+struct TestObject: public PhysicalObject
+{
+	void applyDefaultForces(double dt) { PhysicalObject::applyForces(dt); }
+};
+
+int main(int argc, char* argv[])
+{
+	// bodies with various speeds, including still and almost still ones
+	const size_t count = 1000;
+	const double dt = 0.03;
+	FastRandom random;
+	vector<TestObject> objects(count);
+	RigidBodies bodies;
+	bodies.resize(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		TestObject& o(objects[i]);
+		const double scale = (i % 4 == 0) ? 0 : ((i % 4 == 1) ? 1e-3 : 30);
+		o.speed = Vector(random.getRange(2 * scale) - scale, random.getRange(2 * scale) - scale);
+		o.angSpeed = random.getRange(2 * scale) - scale;
+		o.angle = random.getRange(40) - 20;
+		o.dryFrictionCoefficient = random.getRange(1);
+		o.viscousFrictionCoefficient = random.getRange(0.1);
+		o.viscousMomentFrictionCoefficient = random.getRange(0.1);
+		
+		bodies.x[i] = o.pos.x;
+		bodies.y[i] = o.pos.y;
+		bodies.angle[i] = o.angle;
+		bodies.speedX[i] = o.speed.x;
+		bodies.speedY[i] = o.speed.y;
+		bodies.angSpeed[i] = o.angSpeed;
+		bodies.dryFrictionCoefficient[i] = o.dryFrictionCoefficient;
+		bodies.viscousFrictionCoefficient[i] = o.viscousFrictionCoefficient;
+		bodies.viscousMomentFrictionCoefficient[i] = o.viscousMomentFrictionCoefficient;
+		bodies.defaultForces[i] = (i % 7 != 0);
+	}
+	
+	// the kernels must give exactly the same results as the scalar code
+	bodies.applyFriction(dt, PhysicalObject::g);
+	bodies.integrate(dt);
+	bodies.normalizeAngles();
+	for (size_t i = 0; i < count; ++i)
+	{
+		TestObject& o(objects[i]);
+		if (i % 7 != 0)
+			o.applyDefaultForces(dt);
+		o.pos += o.speed * dt;
+		o.angle = normalizeAngle(o.angle + o.angSpeed * dt);
+		
+		if (bodies.x[i] != o.pos.x || bodies.y[i] != o.pos.y || bodies.angle[i] != o.angle ||
+			bodies.speedX[i] != o.speed.x || bodies.speedY[i] != o.speed.y || bodies.angSpeed[i] != o.angSpeed)
+		{
+			cerr << "body " << i << " differs from scalar computation" << endl;
+			return 1;
+		}
+	}
+	
+	return 0;
+}
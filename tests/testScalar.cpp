@@ -0,0 +1,162 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include "../enki/PhysicalEngine.h"
+#include <iostream>
+#include <cmath>
+#include <type_traits>
+
+// this test is built both against enki and against enkiFloat, with tolerances following Scalar
+
+using namespace Enki;
+using namespace std;
+
+// geometric types and colors must be made of Scalar, which must follow ENKI_SINGLE_PRECISION
+static bool checkLayout()
+{
+	#ifdef ENKI_SINGLE_PRECISION
+	const bool single(true);
+	#else
+	const bool single(false);
+	#endif
+	if (is_same<Scalar, float>::value != single || is_same<Scalar, double>::value == single)
+	{
+		cerr << "Scalar does not follow ENKI_SINGLE_PRECISION" << endl;
+		return false;
+	}
+	if (sizeof(Vector) != 2 * sizeof(Scalar) || sizeof(Matrix22) != 4 * sizeof(Scalar) || sizeof(Color) != 4 * sizeof(Scalar))
+	{
+		cerr << "Vector, Matrix22 or Color is not made of Scalar" << endl;
+		return false;
+	}
+	return true;
+}
+
+// the separating axis test must find the exact penetration up to the precision of Scalar
+static bool checkPenetration()
+{
+	const Scalar epsilon(numeric_limits<Scalar>::epsilon());
+	FastRandom random;
+	for (unsigned i = 0; i < 1000; ++i)
+	{
+		// two unit squares far from the origin, overlapping along x by depth
+		const Point offset(random.getRange(1000), random.getRange(1000));
+		const Scalar depth(0.01 + random.getRange(0.5));
+		Polygon a, b;
+		a << Point(0, 0) << Point(1, 0) << Point(1, 1) << Point(0, 1);
+		b << Point(1 - depth, 0.25) << Point(2 - depth, 0.25) << Point(2 - depth, 1.25) << Point(1 - depth, 1.25);
+		a.translate(offset);
+		b.translate(offset);
+		Vector mtv;
+		Point cp;
+		if (!a.doesIntersect(b, mtv, cp))
+		{
+			cerr << "squares overlapping by " << depth << " do not intersect" << endl;
+			return false;
+		}
+		// the coordinates are up to about 1000, so they are rounded to 1000 epsilon
+		if (fabs(mtv.x + depth) > 4000 * epsilon || fabs(mtv.y) > 4000 * epsilon)
+		{
+			cerr << "squares overlapping by " << depth << " give mtv " << mtv << endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+// an object without friction must travel the distance given by its speed
+static bool checkIntegration()
+{
+	World world;
+	PhysicalObject* o(new PhysicalObject);
+	o->setCylindric(1, 1, 1);
+	o->dryFrictionCoefficient = 0;
+	o->viscousFrictionCoefficient = 0;
+	o->viscousMomentFrictionCoefficient = 0;
+	o->speed = Vector(10, 5);
+	o->angSpeed = 1;
+	world.addObject(o);
+	for (unsigned i = 0; i < 1000; ++i)
+		world.step(0.01);
+	// the error of the 1000 additions of rounded positions
+	const Scalar tolerance(1000 * 100 * numeric_limits<Scalar>::epsilon());
+	if (fabs(o->pos.x - 100) > tolerance || fabs(o->pos.y - 50) > tolerance || fabs(normalizeAngle(o->angle - 10)) > tolerance)
+	{
+		cerr << "object at " << o->pos << " with angle " << o->angle << " instead of (100, 50) and " << normalizeAngle(10) << endl;
+		return false;
+	}
+	return true;
+}
+
+// pushed cylinders must end up separated and within walls
+static bool checkContacts()
+{
+	World world(40, 40);
+	FastRandom random;
+	for (unsigned i = 0; i < 100; ++i)
+	{
+		PhysicalObject* o(new PhysicalObject);
+		o->setCylindric(1, 1, 1);
+		o->pos = Point(10 + random.getRange(20), 10 + random.getRange(20));
+		o->speed = Vector(random.getRange(20) - 10, random.getRange(20) - 10);
+		world.addObject(o);
+	}
+	for (unsigned i = 0; i < 1000; ++i)
+		world.step(0.03, 3);
+	for (World::ObjectsIterator it = world.objects.begin(); it != world.objects.end(); ++it)
+	{
+		const Point& p((*it)->pos);
+		if (p.x < 1 - 0.05 || p.y < 1 - 0.05 || p.x > 39 + 0.05 || p.y > 39 + 0.05)
+		{
+			cerr << "cylinder at " << p << " is out of the walls" << endl;
+			return false;
+		}
+		for (World::ObjectsIterator jt = world.objects.begin(); jt != it; ++jt)
+		{
+			if (((*jt)->pos - p).norm() < 2 - 0.05)
+			{
+				cerr << "cylinders at " << (*jt)->pos << " and " << p << " overlap" << endl;
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	if (!checkLayout() || !checkPenetration() || !checkIntegration() || !checkContacts())
+		return 1;
+	return 0;
+}
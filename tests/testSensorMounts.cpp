@@ -0,0 +1,124 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include "../enki/PhysicalEngine.h"
+#include "../enki/interactions/IRSensor.h"
+#include "../enki/interactions/GroundSensor.h"
+#include "../enki/interactions/CircularCam.h"
+#include <iostream>
+#include <cmath>
+
+using namespace Enki;
+using namespace std;
+
+// a robot with sensors at known poses, the poses of its sensors being computed as interactions did before mounts
+struct TestRobot: public Robot
+{
+	IRSensor irSensor;
+	GroundSensor groundSensor;
+	CircularCam camera;
+	
+	TestRobot():
+		irSensor(this, Vector(2, 1), 2, 0.5, 10, 3000, 0.3, 0.7),
+		groundSensor(this, Vector(1.5, -0.5), 0.44, 9, 1, 0),
+		camera(this, Vector(-1, 0.25), 2, -0.3, M_PI / 4, 30)
+	{
+		setCylindric(3, 3, 10);
+		addLocalInteraction(&irSensor);
+		addLocalInteraction(&groundSensor);
+		addLocalInteraction(&camera);
+	}
+};
+
+static bool equals(const Point& a, const Point& b)
+{
+	return a.x == b.x && a.y == b.y;
+}
+
+int main(int argc, char* argv[])
+{
+	World world(100, 100);
+	TestRobot* robot(new TestRobot);
+	world.addObject(robot);
+	FastRandom random;
+	for (unsigned i = 0; i < 100; ++i)
+	{
+		// move the robot directly, as external code does between steps
+		robot->pos = Point(10 + random.getRange(80), 10 + random.getRange(80));
+		robot->angle = random.getRange(2 * M_PI) - M_PI;
+		world.step(0.1);
+		
+		const Matrix22 rot(robot->angle);
+		const Matrix22& cachedRot(robot->getRotation());
+		if (cachedRot._11 != rot._11 || cachedRot._21 != rot._21 || cachedRot._12 != rot._12 || cachedRot._22 != rot._22)
+		{
+			cerr << "step " << i << ": rotation of the robot is not the one of its orientation" << endl;
+			return 1;
+		}
+		if (!equals(robot->irSensor.getAbsolutePosition(), robot->pos + rot * Vector(2, 1)) || robot->irSensor.getAbsoluteOrientation() != robot->angle + 0.5)
+		{
+			cerr << "step " << i << ": infrared sensor at " << robot->irSensor.getAbsolutePosition() << " with orientation " << robot->irSensor.getAbsoluteOrientation() << endl;
+			return 1;
+		}
+		if (!equals(robot->groundSensor.getAbsolutePosition(), robot->pos + rot * Vector(1.5, -0.5)))
+		{
+			cerr << "step " << i << ": ground sensor at " << robot->groundSensor.getAbsolutePosition() << endl;
+			return 1;
+		}
+		if (!equals(robot->camera.getAbsolutePosition(), robot->pos + rot * Vector(-1, 0.25)) || robot->camera.getAbsoluteOrientation() != robot->angle - 0.3)
+		{
+			cerr << "step " << i << ": camera at " << robot->camera.getAbsolutePosition() << " with orientation " << robot->camera.getAbsoluteOrientation() << endl;
+			return 1;
+		}
+	}
+	
+	// the camera follows changes of its angular offset, for instance to pan it
+	robot->camera.angleOffset = 0.7;
+	world.step(0.1);
+	if (!equals(robot->camera.getAbsolutePosition(), robot->pos + Matrix22(robot->angle) * Vector(-1, 0.25)) || robot->camera.getAbsoluteOrientation() != robot->angle + 0.7)
+	{
+		cerr << "panned camera at " << robot->camera.getAbsolutePosition() << " with orientation " << robot->camera.getAbsoluteOrientation() << endl;
+		return 1;
+	}
+	
+	// mounts added by the user follow the robot as well
+	const size_t mount(robot->addMount(Vector(0, 4), M_PI / 2));
+	world.step(0.1);
+	if (!equals(robot->getMountPos(mount), robot->pos + Matrix22(robot->angle) * Vector(0, 4)) || robot->getMountAngle(mount) != robot->angle + M_PI / 2)
+	{
+		cerr << "mount at " << robot->getMountPos(mount) << " with orientation " << robot->getMountAngle(mount) << endl;
+		return 1;
+	}
+	return 0;
+}
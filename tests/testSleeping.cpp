@@ -0,0 +1,149 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include "../enki/PhysicalEngine.h"
+#include "../enki/robots/DifferentialWheeled.h"
+#include "../enki/robots/e-puck/EPuck.h"
+#include <iostream>
+#include <cstdlib>
+
+using namespace Enki;
+using namespace std;
+
+// a robot with a controller, as user code and bindings subclass robots
+struct ControlledEPuck : public EPuck
+{
+	unsigned controlSteps;
+	ControlledEPuck() : controlSteps(0) {}
+	virtual void controlStep(double dt)
+	{
+		++controlSteps;
+		EPuck::controlStep(dt);
+	}
+};
+
+// fill a world with a robot and objects thrown at each other
+static void populate(World& world)
+{
+	DifferentialWheeled* robot = new DifferentialWheeled(5, 30, 0);
+	robot->pos = Point(10, 10);
+	world.addObject(robot);
+	FastRandom random;
+	for (unsigned i = 0; i < 100; ++i)
+	{
+		PhysicalObject* o = new PhysicalObject;
+		o->setCylindric(1 + random.getRange(2), 1, 1 + random.getRange(10));
+		o->pos = Point(20 + random.getRange(160), 20 + random.getRange(160));
+		o->speed = Vector(random.getRange(40) - 20, random.getRange(40) - 20);
+		o->angSpeed = random.getRange(4) - 2;
+		world.addObject(o);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	World world(200, 200);
+	World reference(200, 200);
+	world.sleepSubsteps = 10;
+	populate(world);
+	populate(reference);
+	
+	// with default thresholds, sleeping must not change results
+	for (unsigned step = 0; step < 400; ++step)
+	{
+		world.step(0.1, 2);
+		reference.step(0.1, 2);
+	}
+	World::ObjectsIterator it(reference.objects.begin());
+	unsigned sleepingCount(0);
+	for (World::ObjectsIterator jt = world.objects.begin(); jt != world.objects.end(); ++jt, ++it)
+	{
+		const PhysicalObject* o(*jt);
+		if (!(o->pos == (*it)->pos) || o->angle != (*it)->angle)
+		{
+			cerr << "object " << o->uid << " moved differently when sleeping is enabled" << endl;
+			return 1;
+		}
+		if ((*it)->isSleeping())
+		{
+			cerr << "object " << o->uid << " slept although sleeping is disabled" << endl;
+			return 1;
+		}
+		if (o->isSleeping())
+			++sleepingCount;
+	}
+	if (sleepingCount != world.objects.size())
+	{
+		cerr << "only " << sleepingCount << " objects out of " << world.objects.size() << " fell asleep" << endl;
+		return 1;
+	}
+	
+	// moving a sleeping object wakes it up
+	PhysicalObject* object(world.objects[1]);
+	object->speed = Vector(10, 0);
+	world.step(0.1, 2);
+	if (object->isSleeping())
+	{
+		cerr << "pushed object did not wake up" << endl;
+		return 1;
+	}
+	
+	// commanding wheels wakes a robot up
+	DifferentialWheeled* robot(dynamic_cast<DifferentialWheeled*>(world.objects[0]));
+	const Point robotPos(robot->pos);
+	robot->leftSpeed = robot->rightSpeed = 10;
+	world.step(0.1, 2);
+	world.step(0.1, 2);
+	if (robot->isSleeping() || robot->pos == robotPos)
+	{
+		cerr << "commanded robot did not wake up" << endl;
+		return 1;
+	}
+	
+	// subclasses of robots that only add a controller sleep as well
+	World robotWorld(200, 200);
+	robotWorld.sleepSubsteps = 10;
+	ControlledEPuck* controlled(new ControlledEPuck);
+	controlled->pos = Point(100, 100);
+	robotWorld.addObject(controlled);
+	for (unsigned i = 0; i < 10; ++i)
+		robotWorld.step(0.1, 2);
+	if (!controlled->isSleeping() || controlled->controlSteps == 0)
+	{
+		cerr << "still robot subclass did not fall asleep" << endl;
+		return 1;
+	}
+	
+	return 0;
+}
@@ -0,0 +1,144 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include "../enki/SmallVector.h"
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <string>
+
+using namespace Enki;
+using namespace std;
+
+// element counting its live instances, to check that none is leaked or destroyed twice
+struct Counted
+{
+	static int alive;
+	string value;
+	
+	Counted(const string& value = string()) : value(value) { ++alive; }
+	Counted(const Counted& that) : value(that.value) { ++alive; }
+	Counted(Counted&& that) : value(std::move(that.value)) { ++alive; }
+	~Counted() { --alive; }
+	Counted& operator=(const Counted& that) { value = that.value; return *this; }
+	Counted& operator=(Counted&& that) { value = std::move(that.value); return *this; }
+	bool operator==(const Counted& that) const { return value == that.value; }
+};
+
+int Counted::alive = 0;
+
+typedef SmallVector<Counted, 3> Small;
+
+// compare a small vector to the std::vector reference
+static bool isSame(const Small& small, const vector<Counted>& reference, const char* operation)
+{
+	bool same(small.size() == reference.size());
+	for (size_t i = 0; same && i < small.size(); ++i)
+		same = small[i] == reference[i];
+	if (!same)
+		cerr << "content differs from std::vector after " << operation << endl;
+	return same;
+}
+
+int main(int argc, char* argv[])
+{
+	{
+		Small small;
+		vector<Counted> reference;
+		
+		// grow inline, then to the heap
+		for (unsigned i = 0; i < 10; ++i)
+		{
+			small.push_back(Counted(to_string(i)));
+			reference.push_back(Counted(to_string(i)));
+			if (!isSame(small, reference, "push_back"))
+				return 1;
+			if (small.isInline() != (i < 3))
+			{
+				cerr << "storage is not inline exactly when elements fit" << endl;
+				return 1;
+			}
+		}
+		// pushing an element of itself while growing
+		small.push_back(small[0]);
+		reference.push_back(reference[0]);
+		
+		// insert and erase
+		small.insert(small.begin() + 2, Counted("a"));
+		reference.insert(reference.begin() + 2, Counted("a"));
+		const vector<Counted> slice(reference.begin() + 4, reference.begin() + 7);
+		small.insert(small.begin(), slice.begin(), slice.end());
+		reference.insert(reference.begin(), slice.begin(), slice.end());
+		if (!isSame(small, reference, "insert"))
+			return 1;
+		small.erase(small.begin() + 1, small.begin() + 5);
+		reference.erase(reference.begin() + 1, reference.begin() + 5);
+		small.erase(small.end() - 1);
+		reference.erase(reference.end() - 1);
+		if (!isSame(small, reference, "erase"))
+			return 1;
+		
+		// copy and move, from heap and from inline storage
+		Small copy(small);
+		Small moved(std::move(copy));
+		if (!isSame(moved, reference, "copy and move") || !copy.empty())
+			return 1;
+		Small inlineSmall(2, Counted("b"));
+		Small inlineMoved(std::move(inlineSmall));
+		if (!isSame(inlineMoved, vector<Counted>(2, Counted("b")), "inline move"))
+			return 1;
+		moved = inlineMoved;
+		if (!isSame(moved, vector<Counted>(2, Counted("b")), "assignment"))
+			return 1;
+		
+		// resize and shrink back inline
+		small.resize(2);
+		reference.resize(2);
+		small.shrink_to_fit();
+		if (!isSame(small, reference, "resize") || !small.isInline())
+			return 1;
+		small.resize(5, Counted("c"));
+		reference.resize(5, Counted("c"));
+		if (!isSame(small, reference, "resize with value"))
+			return 1;
+	}
+	
+	if (Counted::alive != 0)
+	{
+		cerr << Counted::alive << " elements leaked or destroyed twice" << endl;
+		return 1;
+	}
+	
+	return 0;
+}
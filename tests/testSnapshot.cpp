@@ -0,0 +1,283 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include "../enki/PhysicalEngine.h"
+#include "../enki/robots/e-puck/EPuck.h"
+#include "../enki/robots/thymio2/Thymio2.h"
+#include "../enki/robots/marxbot/Marxbot.h"
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+using namespace Enki;
+using namespace std;
+
+// robots with noisy sensors and Bluetooth, thrown among objects
+static void populate(World& world)
+{
+	world.setRandomSeed(7);
+	for (unsigned i = 0; i < 2; ++i)
+	{
+		EPuck* epuck = new EPuck(EPuck::CAPABILITY_BASIC_SENSORS | EPuck::CAPABILITY_CAMERA | EPuck::CAPABILITY_BLUETOOTH);
+		epuck->pos = Point(40 + 10 * i, 40);
+		world.addObject(epuck);
+	}
+	Thymio2* thymio = new Thymio2;
+	thymio->pos = Point(100, 60);
+	world.addObject(thymio);
+	Marxbot* marxbot = new Marxbot;
+	marxbot->pos = Point(140, 140);
+	world.addObject(marxbot);
+	// boxes and cylinders of different masses, thrown at the robots and at each other so that contacts start early
+	for (unsigned i = 0; i < 40; ++i)
+	{
+		PhysicalObject* o = new PhysicalObject;
+		if (i % 2)
+			o->setCylindric(1 + 0.1 * i, 1, 1 + i % 7);
+		else
+			o->setRectangular(2 + 0.05 * i, 1.5, 3, 1 + i % 5);
+		o->pos = Point(25 + 18 * (i % 8), 90 + 18 * (i / 8));
+		o->speed = Vector(15 - 4.0 * (i % 8), double(i % 3) * 10 - 20);
+		o->angSpeed = 0.5 * (i % 4) - 1;
+		world.addObject(o);
+	}
+}
+
+// drive the robots from their sensors, and send data over Bluetooth
+static void control(World& world, unsigned step)
+{
+	EPuck* sender(dynamic_cast<EPuck*>(world.objects[0]));
+	EPuck* receiver(dynamic_cast<EPuck*>(world.objects[1]));
+	if (step == 1)
+		sender->bluetooth->connectTo(receiver->bluetooth->getAddress());
+	char data[4];
+	memcpy(data, &step, sizeof(data));
+	sender->bluetooth->sendDataTo(receiver->bluetooth->getAddress(), data, sizeof(data));
+	
+	for (World::ObjectsIterator it = world.objects.begin(); it != world.objects.end(); ++it)
+	{
+		if (EPuck* epuck = dynamic_cast<EPuck*>(*it))
+		{
+			epuck->leftSpeed = 10 - epuck->infraredSensor0.getValue() * 0.01;
+			epuck->rightSpeed = 10 - epuck->infraredSensor7.getValue() * 0.01 + epuck->camera.image[30].r();
+		}
+		else if (Thymio2* thymio = dynamic_cast<Thymio2*>(*it))
+		{
+			thymio->leftSpeed = 10 - thymio->infraredSensor2.getValue() * 0.01 + thymio->groundSensor0.getValue() * 0.001;
+			thymio->rightSpeed = 8;
+		}
+		else if (Marxbot* marxbot = dynamic_cast<Marxbot*>(*it))
+		{
+			marxbot->leftSpeed = 20 - marxbot->getVirtualBumper(0) * 0.001;
+			marxbot->rightSpeed = 15;
+		}
+	}
+}
+
+// hash the state of the world that its users can see
+static uint64_t fingerprint(const World& world)
+{
+	uint64_t hash(14695981039346656037ULL);
+	const auto mix = [&hash](const void* data, size_t size)
+	{
+		for (size_t i = 0; i < size; ++i)
+			hash = (hash ^ static_cast<const unsigned char*>(data)[i]) * 1099511628211ULL;
+	};
+	for (World::ObjectsIterator it = world.objects.begin(); it != world.objects.end(); ++it)
+	{
+		const PhysicalObject* o(*it);
+		mix(&o->uid, sizeof(o->uid));
+		mix(&o->pos, sizeof(o->pos));
+		mix(&o->angle, sizeof(o->angle));
+		mix(&o->speed, sizeof(o->speed));
+		mix(&o->angSpeed, sizeof(o->angSpeed));
+		if (const EPuck* epuck = dynamic_cast<const EPuck*>(o))
+		{
+			const double value(epuck->infraredSensor0.getValue());
+			mix(&value, sizeof(value));
+			mix(&epuck->leftEncoder, sizeof(epuck->leftEncoder));
+			mix(&epuck->camera.zbuffer[0], epuck->camera.zbuffer.size() * sizeof(double));
+			Bluetooth* bluetooth(epuck->bluetooth);
+			const unsigned received(bluetooth->getSizeReceived(dynamic_cast<const EPuck*>(world.objects[0])->bluetooth->getAddress()));
+			mix(&received, sizeof(received));
+		}
+	}
+	return hash;
+}
+
+// run steps, returning the fingerprint after each of them
+static vector<uint64_t> run(World& world, unsigned firstStep, unsigned stepCount)
+{
+	vector<uint64_t> fingerprints;
+	for (unsigned step = firstStep; step < firstStep + stepCount; ++step)
+	{
+		control(world, step);
+		world.step(0.1, 3);
+		fingerprints.push_back(fingerprint(world));
+	}
+	return fingerprints;
+}
+
+// a snapshot whose data lacks its last bytes
+struct TruncatedSnapshot : public World::Snapshot
+{
+	TruncatedSnapshot(const World::Snapshot& snapshot) : World::Snapshot(snapshot) { data.pop_back(); }
+};
+
+// a robot subclassed to add a controller, which clone() does not support
+struct ControlledEPuck : public EPuck
+{
+	ControlledEPuck() : EPuck(EPuck::CAPABILITY_BASIC_SENSORS | EPuck::CAPABILITY_CAMERA | EPuck::CAPABILITY_BLUETOOTH) {}
+	virtual void controlStep(double dt)
+	{
+		leftSpeed = 5;
+		rightSpeed = 4;
+		EPuck::controlStep(dt);
+	}
+};
+
+int main(int argc, char* argv[])
+{
+	World world(200, 200);
+	populate(world);
+	run(world, 0, 30);
+	
+	// after restoring, the same steps give the same results
+	const World::Snapshot snapshot(world.snapshot());
+	const vector<uint64_t> reference(run(world, 30, 50));
+	PhysicalObject* added(new PhysicalObject);
+	world.addObject(added);
+	// restore() deletes the added object, as the world owns it
+	const unsigned addedUid(added->uid);
+	if (!world.restore(snapshot))
+	{
+		cerr << "restore failed" << endl;
+		return 1;
+	}
+	if (world.objects.size() != snapshot.getObjectCount() || world.getObjectByUid(addedUid))
+	{
+		cerr << "object added after the snapshot was not removed" << endl;
+		return 1;
+	}
+	if (run(world, 30, 50) != reference)
+	{
+		cerr << "restored world stepped differently" << endl;
+		return 1;
+	}
+	
+	// a fork steps like its original, independently of it
+	world.restore(snapshot);
+	World* fork(world.fork());
+	if (!fork)
+	{
+		cerr << "fork failed" << endl;
+		return 1;
+	}
+	if (fingerprint(*fork) != fingerprint(world))
+	{
+		cerr << "fork differs from its original" << endl;
+		return 1;
+	}
+	const vector<uint64_t> forkFingerprints(run(*fork, 30, 50));
+	delete fork;
+	if (forkFingerprints != reference || run(world, 30, 50) != reference)
+	{
+		cerr << "fork stepped differently than its original" << endl;
+		return 1;
+	}
+	
+	// a copy keeps the uid of its original, so it cannot be added to the same world
+	PhysicalObject* copy(world.objects[world.objects.size() - 1]->clone());
+	if (!copy || world.addObject(copy) || world.objects.size() != snapshot.getObjectCount())
+	{
+		cerr << "copy of an object was added to the world of its original" << endl;
+		return 1;
+	}
+	delete copy;
+	
+	// objects that clone() does not support are copied through the factory given to fork()
+	World controlledWorld(100, 100);
+	ControlledEPuck* controlled(new ControlledEPuck);
+	controlled->pos = Point(50, 50);
+	controlledWorld.addObject(controlled);
+	controlledWorld.step(0.1);
+	World* unsupportedFork(controlledWorld.fork());
+	if (unsupportedFork)
+	{
+		cerr << "fork without a factory copied a robot subclass" << endl;
+		delete unsupportedFork;
+		return 1;
+	}
+	World* controlledFork(controlledWorld.fork([](const PhysicalObject& original) { return new ControlledEPuck; }));
+	if (!controlledFork || !dynamic_cast<ControlledEPuck*>(controlledFork->objects[0]) || fingerprint(*controlledFork) != fingerprint(controlledWorld))
+	{
+		cerr << "fork with a factory did not copy a robot subclass" << endl;
+		return 1;
+	}
+	controlledFork->step(0.1);
+	controlledWorld.step(0.1);
+	if (fingerprint(*controlledFork) != fingerprint(controlledWorld))
+	{
+		cerr << "fork of a robot subclass stepped differently than its original" << endl;
+		return 1;
+	}
+	delete controlledFork;
+	
+	// restoring fails with truncated data, leaving the world unchanged
+	world.restore(snapshot);
+	const uint64_t beforeTruncated(fingerprint(world));
+	if (world.restore(TruncatedSnapshot(snapshot)) || fingerprint(world) != beforeTruncated)
+	{
+		cerr << "restore did not fail cleanly with truncated data" << endl;
+		return 1;
+	}
+	if (run(world, 30, 50) != reference)
+	{
+		cerr << "world stepped differently after a failed restore" << endl;
+		return 1;
+	}
+	
+	// restoring fails if an object of the snapshot is gone
+	PhysicalObject* removed(world.objects[5]);
+	world.removeObject(removed);
+	delete removed;
+	const size_t objectCount(world.objects.size());
+	if (world.restore(snapshot) || world.objects.size() != objectCount)
+	{
+		cerr << "restore did not fail with a missing object" << endl;
+		return 1;
+	}
+	
+	return 0;
+}
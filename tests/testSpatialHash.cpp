@@ -0,0 +1,172 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include "../enki/SpatialHash.h"
+#include "../enki/PhysicalEngine.h"
+#include "../enki/Random.h"
+#include <iostream>
+#include <cstdlib>
+#include <limits>
+
+using namespace Enki;
+using namespace std;
+
+// compare the pairs and queries of the spatial hash with a brute-force search
+void testOverlappingPairs(double cellSize, double spread, double minRadius, double maxRadius)
+{
+	const unsigned count = 300;
+	vector<Point> centers(count);
+	vector<double> radii(count);
+	FastRandom random;
+	random.setSeed(count);
+	
+	SpatialHash hash;
+	hash.clear(cellSize);
+	for (unsigned i = 0; i < count; ++i)
+	{
+		centers[i] = Point(random.getRange(2 * spread) - spread, random.getRange(2 * spread) - spread);
+		radii[i] = minRadius + random.getRange(maxRadius - minRadius);
+		hash.insert(i, centers[i], radii[i]);
+	}
+	hash.build();
+	
+	SpatialHash::IndexPairs pairs;
+	hash.getOverlappingPairs(pairs);
+	
+	// every pair must be unique and sorted
+	for (size_t i = 1; i < pairs.size(); ++i)
+	{
+		if (!(pairs[i-1] < pairs[i]))
+		{
+			cerr << "pairs not sorted or duplicated at " << i << endl;
+			exit(1);
+		}
+	}
+	
+	// every pair of overlapping circles must be found
+	size_t found = 0;
+	for (unsigned i = 0; i < count; ++i)
+	{
+		for (unsigned j = i + 1; j < count; ++j)
+		{
+			const double radiusSum(radii[i] + radii[j]);
+			if ((centers[i] - centers[j]).norm2() > radiusSum * radiusSum)
+				continue;
+			if (!binary_search(pairs.begin(), pairs.end(), SpatialHash::IndexPair(i, j)))
+			{
+				cerr << "missing pair " << i << " " << j << " with cell size " << cellSize << endl;
+				exit(2);
+			}
+			++found;
+		}
+	}
+	if (found > pairs.size())
+	{
+		cerr << "found " << pairs.size() << " pairs instead of at least " << found << endl;
+		exit(3);
+	}
+	
+	// every circle overlapping a query circle must be found
+	for (unsigned i = 0; i < count; i += 7)
+	{
+		const double queryRadius(radii[i] * 3);
+		vector<unsigned> indices;
+		hash.getOverlappingElements(centers[i], queryRadius, indices);
+		for (size_t j = 1; j < indices.size(); ++j)
+		{
+			if (indices[j-1] >= indices[j])
+			{
+				cerr << "elements not sorted or duplicated at " << j << endl;
+				exit(4);
+			}
+		}
+		for (unsigned j = 0; j < count; ++j)
+		{
+			const double radiusSum(queryRadius + radii[j]);
+			if ((centers[i] - centers[j]).norm2() > radiusSum * radiusSum)
+				continue;
+			if (!binary_search(indices.begin(), indices.end(), j))
+			{
+				cerr << "missing element " << j << " around " << i << " with cell size " << cellSize << endl;
+				exit(5);
+			}
+		}
+	}
+}
+
+// an object that does its own local interactions with an infinite range
+struct InteractingObject : public PhysicalObject
+{
+	unsigned seen;
+	InteractingObject() : seen(0) {}
+	virtual double getLocalInteractionsRange() const { return std::numeric_limits<double>::infinity(); }
+	virtual void doLocalInteractions(double dt, World *w, PhysicalObject *o) { ++seen; }
+};
+
+// the neighbours given by the world to such an object must include far objects
+void testUnboundedRange()
+{
+	World world(1000, 1000);
+	InteractingObject* interacting(new InteractingObject);
+	interacting->pos = Point(10, 10);
+	world.addObject(interacting);
+	for (unsigned i = 0; i < 10; ++i)
+	{
+		PhysicalObject* o(new PhysicalObject);
+		o->pos = Point(100 + 80 * i, 900);
+		world.addObject(o);
+	}
+	world.step(0.1);
+	if (interacting->seen != 10)
+	{
+		cerr << "object with infinite range saw " << interacting->seen << " objects instead of 10" << endl;
+		exit(6);
+	}
+}
+
+int main()
+{
+	// typical cells, larger and smaller than objects
+	testOverlappingPairs(10, 100, 1, 5);
+	testOverlappingPairs(2, 100, 1, 5);
+	testOverlappingPairs(50, 100, 1, 5);
+	// objects spanning many cells, handled as large ones
+	testOverlappingPairs(1, 100, 1, 30);
+	// negative and far coordinates, as in worlds without walls
+	testOverlappingPairs(5, 1e6, 1, 1e5);
+	
+	testUnboundedRange();
+	
+	return 0;
+}
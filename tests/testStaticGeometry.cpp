@@ -0,0 +1,229 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include "../enki/PhysicalEngine.h"
+#include "../enki/robots/e-puck/EPuck.h"
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <set>
+
+using namespace Enki;
+using namespace std;
+
+// the hierarchy must return the same elements as a linear search
+static bool checkQueries()
+{
+	StaticGeometry geometry;
+	FastRandom random;
+	for (unsigned i = 0; i < 500; ++i)
+	{
+		const Point a(random.getRange(1000), random.getRange(1000));
+		const Point b(a + Vector(random.getRange(40) - 20, random.getRange(40) - 20));
+		if (!(a == b))
+			geometry.addSegment(a, b, 1, 10);
+	}
+	geometry.build();
+	for (unsigned i = 0; i < 1000; ++i)
+	{
+		const Point bottomLeft(random.getRange(1000), random.getRange(1000));
+		const Point topRight(bottomLeft + Vector(random.getRange(100), random.getRange(100)));
+		set<const StaticGeometry::Element*> found, expected;
+		geometry.visitOverlapping(bottomLeft, topRight, [&found](const StaticGeometry::Element& element) { found.insert(&element); });
+		for (size_t j = 0; j < geometry.size(); ++j)
+		{
+			const StaticGeometry::Element& element(geometry[j]);
+			if (element.bottomLeft.x <= topRight.x && element.topRight.x >= bottomLeft.x && element.bottomLeft.y <= topRight.y && element.topRight.y >= bottomLeft.y)
+				expected.insert(&element);
+		}
+		if (found != expected || geometry.overlaps(bottomLeft, topRight) != !expected.empty())
+		{
+			cerr << "query " << i << " found " << found.size() << " elements instead of " << expected.size() << endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+// polygons must be convex, and are made counter-clockwise
+static bool checkPolygons()
+{
+	StaticGeometry geometry;
+	Polygon concave;
+	concave << Point(0, 0) << Point(10, 0) << Point(5, 2) << Point(10, 10) << Point(0, 10);
+	Polygon clockwise;
+	clockwise << Point(0, 0) << Point(0, 10) << Point(10, 10) << Point(10, 0);
+	cerr << "expected error: ";
+	if (geometry.addPolygon(concave, 10) || !geometry.addPolygon(clockwise, 10) || geometry.size() != 1)
+	{
+		cerr << "concave polygon accepted or convex one refused" << endl;
+		return false;
+	}
+	const Polygon& shape(geometry[0].shape);
+	if ((shape[1] - shape[0]).cross(shape[2] - shape[1]) <= 0)
+	{
+		cerr << "clockwise polygon was not reversed" << endl;
+		return false;
+	}
+	return true;
+}
+
+// walls in front, beside and behind an e-puck at the origin, as static geometry or as infinite-mass objects
+static void addWalls(World& world, bool asObjects)
+{
+	Polygon front, side, back;
+	front << Point(8, -15) << Point(10, -15) << Point(10, 15) << Point(8, 15);
+	side << Point(-2, 6) << Point(4, 6) << Point(4, 9) << Point(-2, 9);
+	back << Point(-30, -20) << Point(-28, -20) << Point(-28, 20) << Point(-30, 20);
+	const Polygon* polygons[3] = { &front, &side, &back };
+	for (size_t i = 0; i < 3; ++i)
+	{
+		if (asObjects)
+		{
+			PhysicalObject* o(new PhysicalObject);
+			PhysicalObject::Hull hull;
+			hull.push_back(PhysicalObject::Part(*polygons[i], 10));
+			o->setCustomHull(hull, -1);
+			o->setColor(Color::red);
+			world.addObject(o);
+		}
+		else
+			world.staticGeometry.addPolygon(*polygons[i], 10, Color::red);
+	}
+}
+
+// sensors must see static geometry as they see the same obstacles as objects
+static bool checkSensors()
+{
+	World staticWorld, objectWorld;
+	EPuck* staticEPuck(new EPuck(EPuck::CAPABILITY_BASIC_SENSORS | EPuck::CAPABILITY_CAMERA));
+	EPuck* objectEPuck(new EPuck(EPuck::CAPABILITY_BASIC_SENSORS | EPuck::CAPABILITY_CAMERA));
+	staticWorld.addObject(staticEPuck);
+	objectWorld.addObject(objectEPuck);
+	addWalls(staticWorld, false);
+	addWalls(objectWorld, true);
+	staticWorld.step(0.1);
+	objectWorld.step(0.1);
+	
+	IRSensor* staticSensors[] = { &staticEPuck->infraredSensor0, &staticEPuck->infraredSensor5, &staticEPuck->infraredSensor6, &staticEPuck->infraredSensor7 };
+	IRSensor* objectSensors[] = { &objectEPuck->infraredSensor0, &objectEPuck->infraredSensor5, &objectEPuck->infraredSensor6, &objectEPuck->infraredSensor7 };
+	for (size_t i = 0; i < 4; ++i)
+	{
+		for (unsigned j = 0; j < staticSensors[i]->getRayCount(); ++j)
+		{
+			if (fabs(staticSensors[i]->getRayDist(j) - objectSensors[i]->getRayDist(j)) > 1e-9)
+			{
+				cerr << "infrared sensor " << i << " ray " << j << " sees " << staticSensors[i]->getRayDist(j) << " instead of " << objectSensors[i]->getRayDist(j) << endl;
+				return false;
+			}
+		}
+	}
+	if (staticEPuck->infraredSensor0.getRayDist(1) > 12)
+	{
+		cerr << "front infrared sensor does not see the wall" << endl;
+		return false;
+	}
+	
+	const CircularCam& staticCamera(staticEPuck->camera);
+	const CircularCam& objectCamera(objectEPuck->camera);
+	for (size_t i = 0; i < staticCamera.zbuffer.size(); ++i)
+	{
+		if (fabs(staticCamera.zbuffer[i] - objectCamera.zbuffer[i]) > 1e-6 * objectCamera.zbuffer[i] || staticCamera.image[i] != objectCamera.image[i])
+		{
+			cerr << "camera pixel " << i << " is at " << staticCamera.zbuffer[i] << " instead of " << objectCamera.zbuffer[i] << endl;
+			return false;
+		}
+	}
+	if (staticCamera.image[30] != Color::red)
+	{
+		cerr << "camera does not see the wall" << endl;
+		return false;
+	}
+	return true;
+}
+
+// robots and objects must not go through static walls
+static bool checkCollisions()
+{
+	World world(100, 100);
+	world.staticGeometry.addSegment(Point(50, 10), Point(50, 90), 1, 10);
+	EPuck* epuck(new EPuck);
+	epuck->pos = Point(30, 50);
+	epuck->leftSpeed = epuck->rightSpeed = 10;
+	world.addObject(epuck);
+	PhysicalObject* box(new PhysicalObject);
+	box->setRectangular(4, 4, 2, 1);
+	box->pos = Point(30, 30);
+	box->angle = 0.3;
+	box->speed = Vector(40, 0);
+	world.addObject(box);
+	PhysicalObject* cylinder(new PhysicalObject);
+	cylinder->setCylindric(2, 2, 1);
+	cylinder->pos = Point(70, 70);
+	cylinder->speed = Vector(-40, 5);
+	world.addObject(cylinder);
+	
+	for (unsigned step = 0; step < 100; ++step)
+	{
+		world.step(0.1, 3);
+		if (epuck->pos.x + epuck->getRadius() > 49.5 + 0.1 || box->pos.x + box->getRadius() * 0.5 > 49.5 || cylinder->pos.x - cylinder->getRadius() < 50.5 - 0.1)
+		{
+			cerr << "object went through the wall at step " << step << ": e-puck at " << epuck->pos << ", box at " << box->pos << ", cylinder at " << cylinder->pos << endl;
+			return false;
+		}
+	}
+	if (epuck->pos.x < 40)
+	{
+		cerr << "e-puck did not reach the wall, at " << epuck->pos << endl;
+		return false;
+	}
+	
+	// forked worlds keep the static geometry
+	World* forked(world.fork());
+	const bool ok(forked && forked->staticGeometry.size() == 1);
+	delete forked;
+	if (!ok)
+	{
+		cerr << "forked world lost its static geometry" << endl;
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	if (!checkQueries() || !checkPolygons() || !checkSensors() || !checkCollisions())
+		return 1;
+	return 0;
+}
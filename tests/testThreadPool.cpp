@@ -0,0 +1,175 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+
+#include "../enki/ThreadPool.h"
+#include "../enki/PhysicalEngine.h"
+#include "../enki/robots/e-puck/EPuck.h"
+#include <iostream>
+#include <cstdlib>
+#include <atomic>
+
+using namespace Enki;
+using namespace std;
+
+// every index must be processed exactly once, whatever the number of threads
+void testParallelFor(unsigned threadCount, size_t count)
+{
+	ThreadPool pool(threadCount);
+	vector<atomic<unsigned> > visits(count);
+	for (size_t i = 0; i < count; ++i)
+		visits[i] = 0;
+	
+	for (unsigned run = 0; run < 3; ++run)
+	{
+		pool.parallelFor(count, [&](size_t index, unsigned thread) {
+			if (thread >= pool.getThreadCount())
+			{
+				cerr << "invalid thread index " << thread << endl;
+				exit(1);
+			}
+			// make iterations unbalanced to exercise stealing
+			if (index % 7 == 0)
+				this_thread::yield();
+			++visits[index];
+		});
+	}
+	
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (visits[i] != 3)
+		{
+			cerr << "index " << i << " visited " << visits[i] << " times instead of 3 with " << threadCount << " threads" << endl;
+			exit(1);
+		}
+	}
+}
+
+// run a world of still e-pucks, so that the result does not depend on noise, and return their sensor values
+vector<double> runWorld(unsigned threadCount)
+{
+	World world(120, 120);
+	world.setThreadCount(threadCount);
+	vector<EPuck*> epucks;
+	for (unsigned i = 0; i < 36; ++i)
+	{
+		EPuck* epuck = new EPuck(EPuck::CAPABILITY_BASIC_SENSORS | EPuck::CAPABILITY_CAMERA);
+		epuck->pos = Point(10 + (i % 6) * 9 + (i / 6) * 3, 10 + (i / 6) * 9);
+		epuck->angle = i;
+		world.addObject(epuck);
+		epucks.push_back(epuck);
+	}
+	
+	for (unsigned step = 0; step < 10; ++step)
+		world.step(0.1, 3);
+	
+	vector<double> result;
+	for (size_t i = 0; i < epucks.size(); ++i)
+	{
+		for (size_t j = 0; j < epucks[i]->camera.zbuffer.size(); ++j)
+			result.push_back(epucks[i]->camera.zbuffer[j]);
+		for (unsigned j = 0; j < 3; ++j)
+		{
+			result.push_back(epucks[i]->infraredSensor0.getRayDist(j));
+			result.push_back(epucks[i]->infraredSensor3.getRayDist(j));
+		}
+	}
+	return result;
+}
+
+// run a world crowded with colliding objects and return their final poses
+vector<double> runCrowdedWorld(unsigned threadCount)
+{
+	World world(60, 60);
+	world.setThreadCount(threadCount);
+	vector<PhysicalObject*> objects;
+	for (unsigned i = 0; i < 200; ++i)
+	{
+		PhysicalObject* object = new PhysicalObject;
+		if (i % 3 == 0)
+			object->setRectangular(3, 2, 2, 1 + i % 4);
+		else
+			object->setCylindric(1 + (i % 5) * 0.2, 2, i % 17 == 0 ? -1 : 1 + i % 3);
+		object->pos = Point(3 + (i % 15) * 3.8, 3 + (i / 15) * 4);
+		object->angle = i * 0.7;
+		object->speed = Vector(int(i % 7) * 4 - 12, int(i % 5) * 5 - 10);
+		object->angSpeed = int(i % 3) - 1;
+		world.addObject(object);
+		objects.push_back(object);
+	}
+	
+	for (unsigned step = 0; step < 50; ++step)
+		world.step(0.1, 5);
+	
+	vector<double> result;
+	for (size_t i = 0; i < objects.size(); ++i)
+	{
+		result.push_back(objects[i]->pos.x);
+		result.push_back(objects[i]->pos.y);
+		result.push_back(objects[i]->angle);
+	}
+	return result;
+}
+
+int main(int argc, char* argv[])
+{
+	testParallelFor(1, 100);
+	testParallelFor(2, 1);
+	testParallelFor(3, 1000);
+	testParallelFor(8, 57);
+	
+	// multithreaded local interactions must give the same results as single-threaded ones
+	const vector<double> reference(runWorld(1));
+	for (unsigned threadCount = 2; threadCount <= 4; ++threadCount)
+	{
+		if (runWorld(threadCount) != reference)
+		{
+			cerr << "world with " << threadCount << " threads differs from single-threaded one" << endl;
+			return 1;
+		}
+	}
+	
+	// so must multithreaded physics
+	const vector<double> crowdedReference(runCrowdedWorld(1));
+	for (unsigned threadCount = 2; threadCount <= 4; ++threadCount)
+	{
+		if (runCrowdedWorld(threadCount) != crowdedReference)
+		{
+			cerr << "crowded world with " << threadCount << " threads differs from single-threaded one" << endl;
+			return 1;
+		}
+	}
+	
+	return 0;
+}
@@ -0,0 +1,187 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include "../enki/PhysicalEngine.h"
+#include "../enki/TrajectoryRecorder.h"
+#include <iostream>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+
+using namespace Enki;
+using namespace std;
+
+// a row of spinning boxes sliding at different speeds into a row of cylinders at rest,
+// so that every column changes: angles wrap around pi and colliding objects interlace
+static void populate(World& world)
+{
+	for (unsigned i = 0; i < 25; ++i)
+	{
+		PhysicalObject* o = new PhysicalObject;
+		o->setRectangular(4, 2, 1, 1);
+		o->pos = Point(20 + 6.5 * i, 40);
+		o->speed = Vector(0, 20 + 2 * i);
+		o->angSpeed = 2 + 0.2 * i;
+		world.addObject(o);
+	}
+	for (unsigned i = 0; i < 25; ++i)
+	{
+		PhysicalObject* o = new PhysicalObject;
+		o->setCylindric(2, 1, 2);
+		o->pos = Point(20 + 6.5 * i, 100);
+		world.addObject(o);
+	}
+}
+
+// the values of a column for all objects of a world
+static vector<double> getColumn(const World& world, size_t column)
+{
+	vector<double> values;
+	for (World::ObjectsIterator it = world.objects.begin(); it != world.objects.end(); ++it)
+	{
+		const PhysicalObject* o(*it);
+		const double columnValues[] = { o->pos.x, o->pos.y, o->angle, o->speed.x, o->speed.y, o->angSpeed, o->getInterlacedDistance() };
+		values.push_back(columnValues[column]);
+	}
+	return values;
+}
+
+// record a world, removing an object in the middle, then check the file against the expected values up to tolerance
+static bool check(const char* fileName, TrajectoryRecorder& recorder, double tolerance, size_t& fileSize)
+{
+	World world(200, 200);
+	populate(world);
+	recorder.addChannel("interlacedDistance", [](const PhysicalObject* o) { return o->getInterlacedDistance(); }, tolerance);
+	world.trajectoryRecorder = &recorder;
+	vector<vector<vector<double> > > expected;
+	vector<size_t> objectCounts;
+	for (unsigned step = 0; step < 60; ++step)
+	{
+		if (step == 30)
+		{
+			PhysicalObject* o(world.objects[10]);
+			world.removeObject(o);
+			delete o;
+		}
+		world.step(0.1, 2);
+		expected.push_back(vector<vector<double> >());
+		for (size_t column = 0; column < 7; ++column)
+			expected.back().push_back(getColumn(world, column));
+		objectCounts.push_back(world.objects.size());
+	}
+	recorder.close();
+	
+	TrajectoryReader reader(fileName);
+	if (!reader.isOpen() || reader.getFrameCount() != expected.size() || reader.getColumnCount() != 7)
+	{
+		cerr << fileName << ": expected " << expected.size() << " frames of 7 columns, got " << reader.getFrameCount() << " frames of " << reader.getColumnCount() << " columns" << endl;
+		return false;
+	}
+	if (reader.findColumn("angle") != 2 || reader.findColumn("interlacedDistance") != 6)
+	{
+		cerr << fileName << ": wrong column names" << endl;
+		return false;
+	}
+	vector<double> values;
+	for (size_t frame = 0; frame < reader.getFrameCount(); ++frame)
+	{
+		const TrajectoryFormat::FrameHeader& header(reader.getFrameHeader(frame));
+		if (header.step != frame + 1 || header.objectCount != objectCounts[frame] || fabs(header.time - 0.1 * (frame + 1)) > 1e-9)
+		{
+			cerr << fileName << ": wrong header for frame " << frame << endl;
+			return false;
+		}
+		for (size_t column = 0; column < 7; ++column)
+		{
+			reader.readColumn(frame, column, values);
+			for (size_t i = 0; i < values.size(); ++i)
+			{
+				if (fabs(values[i] - expected[frame][column][i]) > tolerance / 2)
+				{
+					cerr << fileName << ": frame " << frame << " column " << column << " object " << i << " is " << values[i] << " instead of " << expected[frame][column][i] << endl;
+					return false;
+				}
+			}
+		}
+	}
+	FILE* file(fopen(fileName, "rb"));
+	fseek(file, 0, SEEK_END);
+	fileSize = ftell(file);
+	fclose(file);
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	// raw values, through a ring buffer smaller than a frame
+	size_t rawSize;
+	{
+		TrajectoryRecorder recorder("testTrajectoryRaw.trj", 256);
+		if (!check("testTrajectoryRaw.trj", recorder, 0, rawSize))
+			return 1;
+	}
+	TrajectoryReader rawReader("testTrajectoryRaw.trj");
+	if (!rawReader.getRawColumn(0, 0))
+	{
+		cerr << "raw column is not accessible in place" << endl;
+		return 1;
+	}
+	
+	// quantized and delta encoded values
+	size_t deltaSize;
+	{
+		TrajectoryRecorder recorder("testTrajectoryDelta.trj");
+		recorder.positionQuantum = 0.001;
+		recorder.angleQuantum = 0.001;
+		recorder.deltaEncoding = true;
+		recorder.keyframeInterval = 20;
+		if (!check("testTrajectoryDelta.trj", recorder, 0.001, deltaSize))
+			return 1;
+	}
+	TrajectoryReader deltaReader("testTrajectoryDelta.trj");
+	if (!deltaReader.getFrameHeader(0).keyframe || deltaReader.getFrameHeader(1).keyframe || !deltaReader.getFrameHeader(20).keyframe || !deltaReader.getFrameHeader(30).keyframe)
+	{
+		cerr << "keyframes are not at the expected frames" << endl;
+		return 1;
+	}
+	if (deltaSize * 3 > rawSize)
+	{
+		cerr << "delta encoded file is " << deltaSize << " bytes, not much smaller than the " << rawSize << " bytes of the raw one" << endl;
+		return 1;
+	}
+	
+	remove("testTrajectoryRaw.trj");
+	remove("testTrajectoryDelta.trj");
+	return 0;
+}
@@ -0,0 +1,98 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include "../enki/PhysicalEngine.h"
+#include <iostream>
+#include <cstdlib>
+
+using namespace Enki;
+using namespace std;
+
+// check that the world-space hull of o matches its pose
+static bool isUpToDate(const PhysicalObject* o)
+{
+	const Matrix22 rot(o->angle);
+	for (PhysicalObject::Hull::const_iterator it = o->getHull().begin(); it != o->getHull().end(); ++it)
+	{
+		const Polygon& shape(it->getShape());
+		const Polygon& transformedShape(it->getTransformedShape());
+		for (size_t i = 0; i < shape.size(); ++i)
+			if (!(transformedShape[i] == rot * shape[i] + o->pos))
+				return false;
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	// objects bumping into each other and into walls
+	World world(100, 100);
+	for (unsigned i = 0; i < 20; ++i)
+	{
+		PhysicalObject* o = new PhysicalObject;
+		if (i % 2)
+			o->setRectangular(4, 2, 1, 10);
+		else
+			o->setCustomHull(PhysicalObject::Hull(PhysicalObject::Part(4, 4, 1)) + PhysicalObject::Hull(PhysicalObject::Part(8, 1, 1)), 10);
+		o->pos = Point(10 + (i % 5) * 20, 10 + (i / 5) * 20);
+		o->speed = Vector(30 - double(i % 7) * 10, 20 - double(i % 3) * 20);
+		o->angSpeed = double(i % 4) - 2;
+		world.addObject(o);
+	}
+	
+	// world-space hulls are valid after every step, whatever the oversampling
+	for (unsigned step = 0; step < 100; ++step)
+	{
+		world.step(0.1, 1 + step % 4);
+		for (World::ObjectsIterator it = world.objects.begin(); it != world.objects.end(); ++it)
+			if (!isUpToDate(*it))
+			{
+				cerr << "hull of object " << (*it)->uid << " outdated after step " << step << endl;
+				return 1;
+			}
+	}
+	
+	// and can be brought up to date after moving an object by hand
+	PhysicalObject* o(world.objects[0]);
+	o->pos += Vector(1, 2);
+	o->angle += 0.5;
+	o->updateTransformedShape();
+	if (!isUpToDate(o))
+	{
+		cerr << "hull outdated after moving object by hand" << endl;
+		return 1;
+	}
+	
+	return 0;
+}
@@ -0,0 +1,168 @@
+/*
+    Enki - a fast 2D robot simulator
+    Copyright (C) 1999-2016 Stephane Magnenat <stephane at magnenat dot net>
+    Copyright (C) 2004-2005 Markus Waibel <markus dot waibel at epfl dot ch>
+    Copyright (c) 2004-2005 Antoine Beyeler <abeyeler at ab-ware dot com>
+    Copyright (C) 2005-2006 Laboratory of Intelligent Systems, EPFL, Lausanne
+    Copyright (C) 2006-2008 Laboratory of Robotics Systems, EPFL, Lausanne
+    See AUTHORS for details
+
+    This program is free software; the authors of any publication 
+    arising from research using this software are asked to add the 
+    following reference:
+    Enki - a fast 2D robot simulator
+    http://home.gna.org/enki
+    Stephane Magnenat <stephane at magnenat dot net>,
+    Markus Waibel <markus dot waibel at epfl dot ch>
+    Laboratory of Intelligent Systems, EPFL, Lausanne.
+
+    You can redistribute this program and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+
+#include "../enki/WorldBatch.h"
+#include "../enki/robots/e-puck/EPuck.h"
+#include "../enki/robots/s-bot/Sbot.h"
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <set>
+#include <thread>
+
+using namespace Enki;
+using namespace std;
+
+// create a world with a single noisy e-puck, whose trajectory only depends on the random generator of the world
+World* createWorld(unsigned seed)
+{
+	World* world = new World(200, 200);
+	world->setRandomSeed(seed);
+	EPuck* epuck = new EPuck;
+	epuck->pos = Point(100, 100);
+	epuck->leftSpeed = 5 + seed % 4;
+	epuck->rightSpeed = 6;
+	world->addObject(epuck);
+	return world;
+}
+
+// return the pose of the e-puck of world
+vector<double> getPose(const World* world)
+{
+	const PhysicalObject* epuck = *world->objects.begin();
+	vector<double> pose;
+	pose.push_back(epuck->pos.x);
+	pose.push_back(epuck->pos.y);
+	pose.push_back(epuck->angle);
+	return pose;
+}
+
+// the sound frequencies of s-bots are gathered per world, so that concurrent worlds do not hear each other
+bool checkSbotSound()
+{
+	World first(200, 200), second(200, 200);
+	for (unsigned i = 0; i < 2; ++i)
+	{
+		Sbot* sbot = new Sbot;
+		sbot->pos = Point(50 + 100 * i, 100);
+		sbot->globalSound.frequenciesState = 1 << i;
+		first.addObject(sbot);
+	}
+	Sbot* sbot = new Sbot;
+	sbot->pos = Point(100, 100);
+	sbot->globalSound.frequenciesState = 4;
+	second.addObject(sbot);
+	first.step(0.1);
+	second.step(0.1);
+	if (SbotGlobalSound::getWorldFrequenciesState(&first) != 3 || SbotGlobalSound::getWorldFrequenciesState(&second) != 4)
+	{
+		cerr << "s-bot frequencies " << SbotGlobalSound::getWorldFrequenciesState(&first) << " and " << SbotGlobalSound::getWorldFrequenciesState(&second) << " instead of 3 and 4" << endl;
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	if (!checkSbotSound())
+		return 1;
+	
+	const unsigned worldCount = 40;
+	const unsigned stepCount = 100;
+	
+	// reference poses, worlds stepped one after the other
+	vector<vector<double> > references;
+	for (unsigned i = 0; i < worldCount; ++i)
+	{
+		World* world = createWorld(i);
+		for (unsigned j = 0; j < stepCount; ++j)
+			world->step(0.1);
+		references.push_back(getPose(world));
+		delete world;
+	}
+	
+	for (unsigned threadCount = 1; threadCount <= 4; ++threadCount)
+	{
+		// half the worlds are added from the completion callback, as in a steady-state algorithm
+		WorldBatch batch(threadCount);
+		vector<unsigned> seeds;
+		for (unsigned i = 0; i < worldCount / 2; ++i)
+		{
+			batch.addWorld(createWorld(i), stepCount);
+			seeds.push_back(i);
+		}
+		
+		unsigned completedCount = 0;
+		batch.run(0.1, 1, [&](size_t id, World* world) {
+			if (id >= seeds.size() || getPose(world) != references[seeds[id]])
+			{
+				cerr << "world " << id << " differs from reference with " << threadCount << " threads" << endl;
+				exit(1);
+			}
+			++completedCount;
+			if (seeds.size() < worldCount)
+			{
+				const unsigned seed = unsigned(seeds.size());
+				seeds.push_back(seed);
+				batch.addWorld(createWorld(seed), stepCount);
+			}
+		});
+		
+		if (completedCount != worldCount || batch.getPendingWorldCount() != 0)
+		{
+			cerr << "only " << completedCount << " worlds completed with " << threadCount << " threads" << endl;
+			return 1;
+		}
+	}
+	
+	// worlds added by the callback of the last running world are still shared by all threads, which wait for them
+	WorldBatch batch(2);
+	batch.addWorld(createWorld(0), stepCount * 10);
+	set<thread::id> threads;
+	batch.run(0.1, 1, [&](size_t id, World* world) {
+		if (id == 0)
+			for (unsigned i = 0; i < 8; ++i)
+				batch.addWorld(createWorld(i), stepCount * 10);
+		else
+			threads.insert(this_thread::get_id());
+	});
+	if (threads.size() != 2)
+	{
+		cerr << "worlds added from the callback ran on " << threads.size() << " threads instead of 2" << endl;
+		return 1;
+	}
+	
+	return 0;
+}
@@ -719,6 +719,13 @@ namespace Enki
 			break;
 		}
 		
+		// static obstacles and maze walls, which do not move so they are part of the world list
+		for (size_t i = 0; i < world->staticGeometry.size(); ++i)
+		{
+			const StaticGeometry::Element& element(world->staticGeometry[i]);
+			renderShape(element.shape, element.height, element.color);
+		}
+		
 		glEnable(GL_LIGHTING);
 		
 		glEndList();